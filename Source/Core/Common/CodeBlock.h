@@ -72,5 +72,8 @@ public:
 	{
 		return region_size - (T::GetCodePtr() - region);
 	}
+
+	u8* GetRegion() const { return region; }
+	size_t GetRegionSize() const { return region_size; }
 };
 
@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include "Common/Common.h"
 #include "Common/CommonFuncs.h"
 #include "Common/Hash.h"
 #if _M_SSE >= 0x402
@@ -10,7 +11,7 @@
 #include <nmmintrin.h>
 #endif
 
-static u64 (*ptrHashFunction)(const u8 *src, int len, u32 samples) = &GetMurmurHash3;
+static u64 (*ptrHashFunction)(const u8 *src, int len, u32 samples) = &GetXXHash64;
 
 // uint32_t
 // WARNING - may read one more byte!
@@ -230,7 +231,7 @@ u64 GetMurmurHash3(const u8 *src, int len, u32 samples)
 u64 GetCRC32(const u8 *src, int len, u32 samples)
 {
 #if _M_SSE >= 0x402
-	u64 h[4] = { len, 0, 0, 0 };
+	u64 h[4] = { (u64)len, 0, 0, 0 };
 	u32 Step = (len / 8);
 	const u64 *data = (const u64 *)src;
 	const u64 *end = data + Step;
@@ -252,9 +253,18 @@ u64 GetCRC32(const u8 *src, int len, u32 samples)
 	if (data < end - Step * 2)
 		h[2] = _mm_crc32_u64(h[2], data[Step * 2]);
 
+	// The bytes after the last whole word only get hashed when hashing everything.
 	const u8 *data2 = (const u8*)end;
+	if (Step == 1)
+	{
+		for (int i = 0; i < (len & 7); i++)
+			h[0] = _mm_crc32_u8((u32)h[0], data2[i]);
+	}
+	else
+	{
+		h[0] = _mm_crc32_u64(h[0], u64(data2[0]));
+	}
 	// FIXME: is there a better way to combine these partial hashes?
-	h[0] = _mm_crc32_u64(h[0], u64(data2[0]));
 	return h[0] + (h[1] << 10) + (h[2] << 21) + (h[3] << 32);
 #else
 	return 0;
@@ -504,6 +514,99 @@ u64 GetHashHiresTexture(const u8 *src, int len, u32 samples)
 }
 #endif
 
+// xxHash64 (https://github.com/Cyan4973/xxHash), seed 0. Four independent 64-bit lanes
+// consume 32 bytes per round, so unlike the hashes above, consecutive rounds don't wait for
+// each other's multiplies. With samples != 0, only every Step-th 32-byte stripe is hashed.
+static const u64 XXH_PRIME64_1 = 0x9E3779B185EBCA87ULL;
+static const u64 XXH_PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+static const u64 XXH_PRIME64_3 = 0x165667B19E3779F9ULL;
+static const u64 XXH_PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+static const u64 XXH_PRIME64_5 = 0x27D4EB2F165667C5ULL;
+
+static inline u64 xxh64_round(u64 acc, u64 input)
+{
+	acc += input * XXH_PRIME64_2;
+	acc = _rotl64(acc, 31);
+	return acc * XXH_PRIME64_1;
+}
+
+static inline u64 xxh64_merge_round(u64 acc, u64 val)
+{
+	acc ^= xxh64_round(0, val);
+	return acc * XXH_PRIME64_1 + XXH_PRIME64_4;
+}
+
+u64 GetXXHash64(const u8 *src, int len, u32 samples)
+{
+	const u8 *p = src;
+	const u8 *end = src + len;
+	u64 h;
+
+	if (len >= 32)
+	{
+		u32 Step = (len / 32);
+		const u8 *limit = src + Step * 32;
+		if (samples == 0) samples = std::max(Step, 1u);
+		Step = Step / samples;
+		if (Step < 1) Step = 1;
+
+		u64 v1 = XXH_PRIME64_1 + XXH_PRIME64_2;
+		u64 v2 = XXH_PRIME64_2;
+		u64 v3 = 0;
+		u64 v4 = 0 - XXH_PRIME64_1;
+
+		while (p < limit)
+		{
+			const u64 *data = (const u64 *)p;
+			v1 = xxh64_round(v1, data[0]);
+			v2 = xxh64_round(v2, data[1]);
+			v3 = xxh64_round(v3, data[2]);
+			v4 = xxh64_round(v4, data[3]);
+			p += Step * 32;
+		}
+		p = limit;
+
+		h = _rotl64(v1, 1) + _rotl64(v2, 7) + _rotl64(v3, 12) + _rotl64(v4, 18);
+		h = xxh64_merge_round(h, v1);
+		h = xxh64_merge_round(h, v2);
+		h = xxh64_merge_round(h, v3);
+		h = xxh64_merge_round(h, v4);
+	}
+	else
+	{
+		h = XXH_PRIME64_5;
+	}
+
+	h += (u64)len;
+
+	while (p + 8 <= end)
+	{
+		h ^= xxh64_round(0, *(const u64 *)p);
+		h = _rotl64(h, 27) * XXH_PRIME64_1 + XXH_PRIME64_4;
+		p += 8;
+	}
+	if (p + 4 <= end)
+	{
+		h ^= (u64)(*(const u32 *)p) * XXH_PRIME64_1;
+		h = _rotl64(h, 23) * XXH_PRIME64_2 + XXH_PRIME64_3;
+		p += 4;
+	}
+	while (p < end)
+	{
+		h ^= (*p) * XXH_PRIME64_5;
+		h = _rotl64(h, 11) * XXH_PRIME64_1;
+		p++;
+	}
+
+	h ^= h >> 33;
+	h *= XXH_PRIME64_2;
+	h ^= h >> 29;
+	h *= XXH_PRIME64_3;
+	h ^= h >> 32;
+
+	return h;
+}
+
 u64 GetHash64(const u8 *src, int len, u32 samples)
 {
 	return ptrHashFunction(src, len, samples);
@@ -524,7 +627,7 @@ void SetHash64Function(bool useHiresTextures)
 #endif
 	else
 	{
-		ptrHashFunction = &GetMurmurHash3;
+		ptrHashFunction = &GetXXHash64;
 	}
 }
 
@@ -0,0 +1,255 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <cinttypes>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Common/JitRegister.h"
+#include "Common/StringUtil.h"
+#include "Common/Logging/Log.h"
+
+#if defined(__linux__)
+#include <elf.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+namespace JitRegister
+{
+
+#if defined(__linux__)
+
+// Record layouts from tools/perf/Documentation/jitdump-specification.txt
+enum
+{
+	JITDUMP_MAGIC = 0x4A695444,
+	JITDUMP_VERSION = 1,
+	JIT_CODE_LOAD = 0,
+	JIT_CODE_DEBUG_INFO = 2,
+};
+
+struct JitDumpHeader
+{
+	u32 magic;
+	u32 version;
+	u32 total_size;
+	u32 elf_mach;
+	u32 pad1;
+	u32 pid;
+	u64 timestamp;
+	u64 flags;
+};
+
+struct JitDumpRecordHeader
+{
+	u32 id;
+	u32 total_size;
+	u64 timestamp;
+};
+
+struct JitDumpCodeLoad
+{
+	JitDumpRecordHeader header;
+	u32 pid;
+	u32 tid;
+	u64 vma;
+	u64 code_addr;
+	u64 code_size;
+	u64 code_index;
+	// followed by the null terminated name and the code bytes
+};
+
+struct JitDumpDebugInfo
+{
+	JitDumpRecordHeader header;
+	u64 code_addr;
+	u64 nr_entry;
+	// followed by nr_entry JitDumpDebugEntry, each with a null terminated file name
+};
+
+struct JitDumpDebugEntry
+{
+	u64 addr;
+	s32 lineno;
+	s32 discrim;
+};
+
+static File::IOFile s_perf_map_file;
+static File::IOFile s_jitdump_file;
+static void* s_jitdump_marker = nullptr;
+static size_t s_jitdump_marker_size;
+static u64 s_code_index;
+
+// Has to match the clock perf samples with (perf record -k mono).
+static u64 GetTimestamp()
+{
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (u64)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static u32 GetElfMachine()
+{
+#if defined(_M_X86_64)
+	return EM_X86_64;
+#elif defined(_M_ARM_64)
+	return EM_AARCH64;
+#elif defined(_M_ARM_32)
+	return EM_ARM;
+#else
+	return EM_NONE;
+#endif
+}
+
+static void OpenJitDump()
+{
+	std::string filename = StringFromFormat("/tmp/jit-%d.dump", getpid());
+	if (!s_jitdump_file.Open(filename, "w+b"))
+	{
+		ERROR_LOG(COMMON, "Could not open %s", filename.c_str());
+		return;
+	}
+
+	// perf inject only looks at dumps whose file was mapped executable by the process.
+	s_jitdump_marker_size = sysconf(_SC_PAGESIZE);
+	s_jitdump_marker = mmap(nullptr, s_jitdump_marker_size, PROT_READ | PROT_EXEC, MAP_PRIVATE,
+	                        fileno(s_jitdump_file.GetHandle()), 0);
+	if (s_jitdump_marker == MAP_FAILED)
+	{
+		ERROR_LOG(COMMON, "Could not map %s, perf inject will ignore it", filename.c_str());
+		s_jitdump_marker = nullptr;
+	}
+
+	JitDumpHeader header = {};
+	header.magic = JITDUMP_MAGIC;
+	header.version = JITDUMP_VERSION;
+	header.total_size = sizeof(header);
+	header.elf_mach = GetElfMachine();
+	header.pid = getpid();
+	header.timestamp = GetTimestamp();
+	s_jitdump_file.WriteArray(&header, 1);
+}
+
+void Init()
+{
+	std::string filename = StringFromFormat("/tmp/perf-%d.map", getpid());
+	if (!s_perf_map_file.Open(filename, "w"))
+		ERROR_LOG(COMMON, "Could not open %s", filename.c_str());
+
+	OpenJitDump();
+	s_code_index = 0;
+}
+
+void Shutdown()
+{
+	if (s_jitdump_marker)
+	{
+		munmap(s_jitdump_marker, s_jitdump_marker_size);
+		s_jitdump_marker = nullptr;
+	}
+	s_jitdump_file.Close();
+	s_perf_map_file.Close();
+}
+
+bool IsEnabled()
+{
+	return s_perf_map_file.IsOpen() || s_jitdump_file.IsOpen();
+}
+
+static void WriteDebugInfo(const void* base_address, const std::vector<GuestLine>& lines, u64 timestamp)
+{
+	// The guest address goes in the file name, since line numbers are signed 32 bit.
+	std::vector<std::string> names;
+	names.reserve(lines.size());
+	u32 total_size = sizeof(JitDumpDebugInfo);
+	for (const GuestLine& line : lines)
+	{
+		names.push_back(StringFromFormat("%08x", line.guest_address));
+		total_size += sizeof(JitDumpDebugEntry) + (u32)names.back().size() + 1;
+	}
+
+	JitDumpDebugInfo info;
+	info.header.id = JIT_CODE_DEBUG_INFO;
+	info.header.total_size = total_size;
+	info.header.timestamp = timestamp;
+	info.code_addr = (u64)base_address;
+	info.nr_entry = lines.size();
+	s_jitdump_file.WriteArray(&info, 1);
+
+	for (size_t i = 0; i < lines.size(); i++)
+	{
+		JitDumpDebugEntry entry;
+		entry.addr = (u64)lines[i].host_address;
+		entry.lineno = 1;
+		entry.discrim = 0;
+		s_jitdump_file.WriteArray(&entry, 1);
+		s_jitdump_file.WriteArray(names[i].c_str(), names[i].size() + 1);
+	}
+}
+
+void Register(const void* base_address, u32 code_size, const std::string& symbol_name,
+              const std::vector<GuestLine>& lines)
+{
+	if (!code_size)
+		return;
+
+	if (s_perf_map_file.IsOpen())
+	{
+		std::string entry = StringFromFormat("%" PRIx64 " %x %s\n", (u64)base_address, code_size, symbol_name.c_str());
+		s_perf_map_file.WriteBytes(entry.data(), entry.size());
+	}
+
+	if (s_jitdump_file.IsOpen())
+	{
+		u64 timestamp = GetTimestamp();
+
+		// Debug info has to come before the code it describes.
+		if (!lines.empty())
+			WriteDebugInfo(base_address, lines, timestamp);
+
+		JitDumpCodeLoad record;
+		record.header.id = JIT_CODE_LOAD;
+		record.header.total_size = sizeof(record) + (u32)symbol_name.size() + 1 + code_size;
+		record.header.timestamp = timestamp;
+		record.pid = getpid();
+		record.tid = (u32)syscall(SYS_gettid);
+		record.vma = (u64)base_address;
+		record.code_addr = (u64)base_address;
+		record.code_size = code_size;
+		record.code_index = s_code_index++;
+		s_jitdump_file.WriteArray(&record, 1);
+		s_jitdump_file.WriteArray(symbol_name.c_str(), symbol_name.size() + 1);
+		s_jitdump_file.WriteBytes(base_address, code_size);
+	}
+}
+
+#else
+
+void Init()
+{
+}
+
+void Shutdown()
+{
+}
+
+bool IsEnabled()
+{
+	return false;
+}
+
+void Register(const void* base_address, u32 code_size, const std::string& symbol_name,
+              const std::vector<GuestLine>& lines)
+{
+}
+
+#endif
+
+}
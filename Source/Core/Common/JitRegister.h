@@ -0,0 +1,32 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+
+// Tells external profilers about generated code. On Linux this writes
+// /tmp/perf-<pid>.map, which `perf report` picks up by itself, and
+// /tmp/jit-<pid>.dump, which `perf record -k mono` + `perf inject --jit`
+// turn into symbols with the code bytes and guest addresses attached.
+namespace JitRegister
+{
+
+struct GuestLine
+{
+	const void* host_address; // first host byte generated for the guest instruction
+	u32 guest_address;
+};
+
+void Init();
+void Shutdown();
+bool IsEnabled();
+
+void Register(const void* base_address, u32 code_size, const std::string& symbol_name,
+              const std::vector<GuestLine>& lines = std::vector<GuestLine>());
+
+}
@@ -0,0 +1,83 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+// a lock-free thread-safe,
+// multiple writer, single reader queue
+
+#include <atomic>
+#include <utility>
+
+namespace Common
+{
+
+// Push links the new element in with a single atomic exchange, so writers never block
+// each other or the reader. A push that is halfway done when the reader looks is simply
+// picked up by the next Pop.
+template <typename T>
+class MPSCQueue
+{
+public:
+	MPSCQueue() : m_write_ptr(new ElementPtr())
+	{
+		m_read_ptr = m_write_ptr.load();
+	}
+
+	~MPSCQueue()
+	{
+		Clear();
+		delete m_read_ptr;
+	}
+
+	bool Empty() const
+	{
+		return !m_read_ptr->next.load(std::memory_order_acquire);
+	}
+
+	template <typename Arg>
+	void Push(Arg&& t)
+	{
+		ElementPtr* new_ptr = new ElementPtr();
+		new_ptr->current = std::forward<Arg>(t);
+
+		ElementPtr* prev = m_write_ptr.exchange(new_ptr, std::memory_order_acq_rel);
+		prev->next.store(new_ptr, std::memory_order_release);
+	}
+
+	// only from the reader thread
+	bool Pop(T& t)
+	{
+		ElementPtr* next = m_read_ptr->next.load(std::memory_order_acquire);
+		if (!next)
+			return false;
+
+		t = std::move(next->current);
+		delete m_read_ptr;
+		m_read_ptr = next;
+		return true;
+	}
+
+	// only from the reader thread
+	void Clear()
+	{
+		T t;
+		while (Pop(t)) {}
+	}
+
+private:
+	// The element at m_read_ptr has already been popped; the queue holds the ones after it.
+	struct ElementPtr
+	{
+		ElementPtr() : next(nullptr) {}
+
+		T current;
+		std::atomic<ElementPtr*> next;
+	};
+
+	std::atomic<ElementPtr*> m_write_ptr;
+	ElementPtr* m_read_ptr;
+};
+
+}
@@ -117,6 +117,32 @@ void *MemArena::CreateView(s64 offset, size_t size, void *base)
 }
 
 
+void *MemArena::CreatePageView(s64 offset, size_t size, void *base, bool writable)
+{
+#ifdef _WIN32
+	return nullptr;
+#else
+	// No MAP_FIXED: base is only a hint, so we can't clobber a mapping that someone else put
+	// into a hole of the fastmem arena.
+	void *retval = mmap(
+		base, size,
+		writable ? (PROT_READ | PROT_WRITE) : PROT_READ,
+		MAP_SHARED,
+		fd, offset);
+
+	if (retval == MAP_FAILED)
+		return nullptr;
+
+	if (retval != base)
+	{
+		munmap(retval, size);
+		return nullptr;
+	}
+	return retval;
+#endif
+}
+
+
 void MemArena::ReleaseView(void* view, size_t size)
 {
 #ifdef _WIN32
@@ -126,6 +152,48 @@ void MemArena::ReleaseView(void* view, size_t size)
 #endif
 }
 
+u8* MemArena::CreateMirroredView(s64 offset, size_t size)
+{
+	// Reserve enough address space for both views, then map over it. On
+	// Windows the reservation has to be released first, so another thread may
+	// steal the range in between; just try again in that case.
+	for (int attempt = 0; attempt < 16; attempt++)
+	{
+#ifdef _WIN32
+		u8* base = (u8*)VirtualAlloc(nullptr, size * 2, MEM_RESERVE, PAGE_NOACCESS);
+		if (!base)
+			break;
+		VirtualFree(base, 0, MEM_RELEASE);
+#else
+		void* reserved = mmap(nullptr, size * 2, PROT_NONE, MAP_ANON | MAP_PRIVATE, -1, 0);
+		if (reserved == MAP_FAILED)
+			break;
+		u8* base = static_cast<u8*>(reserved);
+#endif
+
+		void* first = CreateView(offset, size, base);
+		void* second = first ? CreateView(offset, size, base + size) : nullptr;
+		if (first == base && second == base + size)
+			return base;
+
+		if (first)
+			ReleaseView(first, size);
+		if (second)
+			ReleaseView(second, size);
+#ifndef _WIN32
+		munmap(base, size * 2);
+#endif
+	}
+
+	NOTICE_LOG(MEMMAP, "Failed to create mirrored view of size 0x%lx", (unsigned long)size);
+	return nullptr;
+}
+
+void MemArena::ReleaseMirroredView(u8* view, size_t size)
+{
+	ReleaseView(view, size);
+	ReleaseView(view + size, size);
+}
 
 u8* MemArena::Find4GBBase()
 {
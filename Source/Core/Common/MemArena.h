@@ -24,6 +24,17 @@ public:
 	void *CreateView(s64 offset, size_t size, void *base = nullptr);
 	void ReleaseView(void *view, size_t size);
 
+	// Maps a view at exactly base, but only if nothing else is mapped there yet; returns
+	// nullptr otherwise. Unlike CreateView, this works for single host pages, so it isn't
+	// available on Windows, where views have to be aligned to 64 KB.
+	void *CreatePageView(s64 offset, size_t size, void *base, bool writable);
+
+	// Maps [offset, offset + size) twice, back to back, so that accesses running
+	// off the end of the first view continue seamlessly at the start of the
+	// segment. Useful for ring buffers whose readers need contiguous data.
+	u8 *CreateMirroredView(s64 offset, size_t size);
+	void ReleaseMirroredView(u8 *view, size_t size);
+
 	// This only finds 1 GB in 32-bit
 	static u8 *Find4GBBase();
 private:
@@ -92,7 +92,7 @@ bool CBoot::EmulatedBS2_GC()
 		INFO_LOG(BOOT, "GC BS2: Not running apploader!");
 		return false;
 	}
-	VolumeHandler::ReadToPtr(Memory::GetPointer(0x81200000), iAppLoaderOffset + 0x20, iAppLoaderSize);
+	VolumeHandler::ReadToEmu(0x81200000, iAppLoaderOffset + 0x20, iAppLoaderSize);
 
 	// Setup pointers like real BS2 does
 	if (SConfig::GetInstance().m_LocalCoreStartupParameter.bNTSC)
@@ -319,7 +319,7 @@ bool CBoot::EmulatedBS2_Wii()
 	// values as the game boots. This location keep the 4 byte ID for as long
 	// as the game is running. The 6 byte ID at 0x00 is overwritten sometime
 	// after this check during booting.
-	VolumeHandler::ReadToPtr(Memory::GetPointer(0x3180), 0, 4);
+	VolumeHandler::ReadToEmu(0x3180, 0, 4);
 
 	// Execute the apploader
 	bool apploaderRan = false;
@@ -359,7 +359,7 @@ bool CBoot::EmulatedBS2_Wii()
 			ERROR_LOG(BOOT, "Invalid apploader. Probably your image is corrupted.");
 			return false;
 		}
-		VolumeHandler::ReadToPtr(Memory::GetPointer(0x81200000), iAppLoaderOffset + 0x20, iAppLoaderSize);
+		VolumeHandler::ReadToEmu(0x81200000, iAppLoaderOffset + 0x20, iAppLoaderSize);
 
 		//call iAppLoaderEntry
 		DEBUG_LOG(BOOT, "Call iAppLoaderEntry");
@@ -137,6 +137,7 @@ static const struct
 	{ "UndoSaveState",        true, 351 /* WXK_F12 */,   4 /* wxMOD_SHIFT */,   0 },
 	{ "SaveStateFile",        true, 0,                   0 /* wxMOD_NONE */,    0 },
 	{ "LoadStateFile",        true, 0,                   0 /* wxMOD_NONE */,    0 },
+	{ "Rewind",               true, 0,                   0 /* wxMOD_NONE */,    0 },
 };
 
 static const struct
@@ -426,6 +427,10 @@ void SConfig::SaveCoreSettings(IniFile& ini)
 	core->Set("FrameSkip", m_FrameSkip);
 	core->Set("GFXBackend", m_LocalCoreStartupParameter.m_strVideoBackend);
 	core->Set("GPUDeterminismMode", m_LocalCoreStartupParameter.m_strGPUDeterminismMode);
+	core->Set("Rewind", m_LocalCoreStartupParameter.bRewind);
+	core->Set("RewindInterval", m_LocalCoreStartupParameter.iRewindInterval);
+	core->Set("RewindBufferSize", m_LocalCoreStartupParameter.iRewindBufferSize);
+	core->Set("RewindBudget", m_LocalCoreStartupParameter.iRewindBudget);
 }
 
 void SConfig::SaveMovieSettings(IniFile& ini)
@@ -691,6 +696,9 @@ void SConfig::LoadCoreSettings(IniFile& ini)
 	core->Get("BBA_MAC",           &m_bba_mac);
 	core->Get("TimeProfiling",     &m_LocalCoreStartupParameter.bJITILTimeProfiling, false);
 	core->Get("OutputIR",          &m_LocalCoreStartupParameter.bJITILOutputIR,      false);
+	core->Get("PerfMap",           &m_LocalCoreStartupParameter.bJITPerfMap,         false);
+	core->Get("JITWarmStart",      &m_LocalCoreStartupParameter.bJITWarmStart,       false);
+	core->Get("JITTierThreshold",  &m_LocalCoreStartupParameter.iJITTierThreshold,   0);
 	for (int i = 0; i < MAX_SI_CHANNELS; ++i)
 	{
 		core->Get(StringFromFormat("SIDevice%i", i), (u32*)&m_SIDevice[i], (i == 0) ? SIDEVICE_GC_CONTROLLER : SIDEVICE_NONE);
@@ -705,12 +713,17 @@ void SConfig::LoadCoreSettings(IniFile& ini)
 	core->Get("BBDumpPort",                &m_LocalCoreStartupParameter.iBBDumpPort,       -1);
 	core->Get("VBeam",                     &m_LocalCoreStartupParameter.bVBeamSpeedHack,   false);
 	core->Get("SyncGPU",                   &m_LocalCoreStartupParameter.bSyncGPU,          false);
+	core->Get("BatchFifo",                 &m_LocalCoreStartupParameter.bBatchFifo,        false);
 	core->Get("FastDiscSpeed",             &m_LocalCoreStartupParameter.bFastDiscSpeed,    false);
 	core->Get("DCBZ",                      &m_LocalCoreStartupParameter.bDCBZOFF,          false);
 	core->Get("FrameLimit",                &m_Framelimit,                                  1); // auto frame limit by default
 	core->Get("FrameSkip",                 &m_FrameSkip,                                   0);
 	core->Get("GFXBackend",                &m_LocalCoreStartupParameter.m_strVideoBackend, "");
 	core->Get("GPUDeterminismMode",        &m_LocalCoreStartupParameter.m_strGPUDeterminismMode, "auto");
+	core->Get("Rewind",                    &m_LocalCoreStartupParameter.bRewind,           false);
+	core->Get("RewindInterval",            &m_LocalCoreStartupParameter.iRewindInterval,   10);
+	core->Get("RewindBufferSize",          &m_LocalCoreStartupParameter.iRewindBufferSize, 256);
+	core->Get("RewindBudget",              &m_LocalCoreStartupParameter.iRewindBudget,     1000);
 }
 
 void SConfig::LoadMovieSettings(IniFile& ini)
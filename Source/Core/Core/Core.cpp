@@ -282,7 +282,10 @@ static void CpuThread()
 	}
 
 	if (_CoreParameter.bFastmem)
+	{
 		EMM::InstallExceptionHandler(); // Let's run under memory watch
+		Memory::EnableWriteWatch();
+	}
 
 	if (!s_state_filename.empty())
 		State::LoadAs(s_state_filename);
@@ -310,6 +313,7 @@ static void CpuThread()
 	if (!_CoreParameter.bCPUThread)
 		g_video_backend->Video_Cleanup();
 
+	Memory::DisableWriteWatch();
 	EMM::UninstallExceptionHandler();
 
 	return;
@@ -484,6 +488,7 @@ void EmuThread()
 	PowerPC::SetMode(PowerPC::MODE_INTERPRETER);
 
 	CBoot::BootUp();
+	JitInterface::StartWarmStart();
 
 	// Setup our core, but can't use dynarec if we are compare server
 	if (core_parameter.iCPUCore != SCoreStartupParameter::CORE_INTERPRETER
@@ -743,6 +748,8 @@ void VideoThrottle()
 	}
 
 	s_drawn_video++;
+
+	State::RewindFrameUpdate();
 }
 
 // Executed from GPU thread
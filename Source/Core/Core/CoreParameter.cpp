@@ -32,6 +32,7 @@ SCoreStartupParameter::SCoreStartupParameter()
   bJITPairedOff(false), bJITSystemRegistersOff(false),
   bJITBranchOff(false),
   bJITILTimeProfiling(false), bJITILOutputIR(false),
+  bJITPerfMap(false), bJITWarmStart(false), iJITTierThreshold(0),
   bFPRF(false),
   bCPUThread(true), bDSPThread(false), bDSPHLE(true),
   bSkipIdle(true), bNTSC(false), bForceNTSCJ(false),
@@ -41,7 +42,8 @@ SCoreStartupParameter::SCoreStartupParameter()
   bRunCompareServer(false), bRunCompareClient(false),
   bBAT(false), bMMU(false), bDCBZOFF(false),
   iBBDumpPort(0), bVBeamSpeedHack(false),
-  bSyncGPU(false), bFastDiscSpeed(false),
+  bSyncGPU(false), bBatchFifo(false), bFastDiscSpeed(false),
+  bRewind(false), iRewindInterval(10), iRewindBufferSize(256), iRewindBudget(1000),
   SelectedLanguage(0), bWii(false),
   bConfirmStop(false), bHideCursor(false),
   bAutoHideCursor(false), bUsePanicHandlers(true), bOnScreenDisplayMessages(true),
@@ -81,7 +83,12 @@ void SCoreStartupParameter::LoadDefaults()
 	iBBDumpPort = -1;
 	bVBeamSpeedHack = false;
 	bSyncGPU = false;
+	bBatchFifo = false;
 	bFastDiscSpeed = false;
+	bRewind = false;
+	iRewindInterval = 10;
+	iRewindBufferSize = 256;
+	iRewindBudget = 1000;
 	bMergeBlocks = false;
 	bEnableMemcardSaving = true;
 	SelectedLanguage = 0;
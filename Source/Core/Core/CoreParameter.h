@@ -112,6 +112,7 @@ enum Hotkey
 	HK_UNDO_SAVE_STATE,
 	HK_SAVE_STATE_FILE,
 	HK_LOAD_STATE_FILE,
+	HK_REWIND,
 
 	NUM_HOTKEYS,
 };
@@ -198,6 +199,10 @@ struct SCoreStartupParameter
 	bool bJITBranchOff;
 	bool bJITILTimeProfiling;
 	bool bJITILOutputIR;
+	bool bJITPerfMap;
+	bool bJITWarmStart;
+	// How many times Jit64 interprets a block before compiling it; 0 compiles right away.
+	int iJITTierThreshold;
 
 	bool bFastmem;
 	bool bFPRF;
@@ -225,8 +230,14 @@ struct SCoreStartupParameter
 	int iBBDumpPort;
 	bool bVBeamSpeedHack;
 	bool bSyncGPU;
+	bool bBatchFifo;
 	bool bFastDiscSpeed;
 
+	bool bRewind;
+	int iRewindInterval; // in frames
+	int iRewindBufferSize; // in MB
+	int iRewindBudget; // CPU thread time per snapshot, in microseconds
+
 	int SelectedLanguage;
 
 	bool bWii;
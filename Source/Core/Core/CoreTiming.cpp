@@ -2,12 +2,15 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <cinttypes>
+#include <functional>
 #include <string>
+#include <tuple>
 #include <vector>
 
 #include "Common/ChunkFile.h"
-#include "Common/FifoQueue.h"
+#include "Common/MPSCQueue.h"
 #include "Common/StringUtil.h"
 #include "Common/Thread.h"
 
@@ -26,26 +29,32 @@ struct EventType
 {
 	TimedCallback callback;
 	std::string name;
+	// how many events of this type are in event_queue
+	u32 num_scheduled;
 };
 
 static std::vector<EventType> event_types;
 
-struct BaseEvent
+struct Event
 {
 	s64 time;
+	u64 fifo_order;
 	u64 userdata;
 	int type;
 };
 
-typedef LinkedListItem<BaseEvent> Event;
+// Sort by time, unless the times are the same, in which case sort by the order added to the queue
+static bool operator>(const Event& left, const Event& right)
+{
+	return std::tie(left.time, left.fifo_order) > std::tie(right.time, right.fifo_order);
+}
 
 // STATE_TO_SAVE
-static Event *first;
-static std::mutex tsWriteLock;
-static Common::FifoQueue<BaseEvent, false> tsQueue;
-
-// event pools
-static Event *eventPool = nullptr;
+// The queue is a min-heap using std::make_heap/push_heap/pop_heap with std::greater,
+// so the next event to fire is always event_queue.front().
+static std::vector<Event> event_queue;
+static u64 event_fifo_id;
+static Common::MPSCQueue<Event> tsQueue;
 
 int slicelength;
 static int maxSliceLength = MAX_SLICE_LENGTH;
@@ -63,20 +72,21 @@ static int ev_lost;
 
 static void (*advanceCallback)(int cyclesExecuted) = nullptr;
 
-static Event* GetNewEvent()
+static void PushEvent(const Event& ev)
 {
-	if (!eventPool)
-		return new Event;
-
-	Event* ev = eventPool;
-	eventPool = ev->next;
-	return ev;
+	event_queue.push_back(ev);
+	event_queue.back().fifo_order = event_fifo_id++;
+	std::push_heap(event_queue.begin(), event_queue.end(), std::greater<Event>());
+	event_types[ev.type].num_scheduled++;
 }
 
-static void FreeEvent(Event* ev)
+static Event PopFirstEvent()
 {
-	ev->next = eventPool;
-	eventPool = ev;
+	std::pop_heap(event_queue.begin(), event_queue.end(), std::greater<Event>());
+	Event ev = event_queue.back();
+	event_queue.pop_back();
+	event_types[ev.type].num_scheduled--;
+	return ev;
 }
 
 static void EmptyTimedCallback(u64 userdata, int cyclesLate) {}
@@ -86,6 +96,7 @@ int RegisterEvent(const std::string& name, TimedCallback callback)
 	EventType type;
 	type.name = name;
 	type.callback = callback;
+	type.num_scheduled = 0;
 
 	// check for existing type with same name.
 	// we want event type names to remain unique so that we can use them for serialization.
@@ -107,7 +118,7 @@ int RegisterEvent(const std::string& name, TimedCallback callback)
 
 void UnregisterAllEvents()
 {
-	if (first)
+	if (!event_queue.empty())
 		PanicAlertT("Cannot unregister events with events pending");
 	event_types.clear();
 }
@@ -124,20 +135,12 @@ void Init()
 
 void Shutdown()
 {
-	std::lock_guard<std::mutex> lk(tsWriteLock);
 	MoveEvents();
 	ClearPendingEvents();
 	UnregisterAllEvents();
-
-	while (eventPool)
-	{
-		Event *ev = eventPool;
-		eventPool = ev->next;
-		delete ev;
-	}
 }
 
-static void EventDoState(PointerWrap &p, BaseEvent* ev)
+static void EventDoState(PointerWrap &p, Event* ev)
 {
 	p.Do(ev->time);
 
@@ -173,7 +176,6 @@ static void EventDoState(PointerWrap &p, BaseEvent* ev)
 
 void DoState(PointerWrap &p)
 {
-	std::lock_guard<std::mutex> lk(tsWriteLock);
 	p.Do(slicelength);
 	p.Do(globalTimer);
 	p.Do(idledCycles);
@@ -185,7 +187,36 @@ void DoState(PointerWrap &p)
 
 	MoveEvents();
 
-	p.DoLinkedList<BaseEvent, GetNewEvent, FreeEvent, EventDoState>(first);
+	// The events are stored in the order they fire, in the same format PointerWrap's
+	// DoLinkedList used for the old linked list queue, so older states still load.
+	if (p.GetMode() == PointerWrap::MODE_READ)
+	{
+		ClearPendingEvents();
+		while (true)
+		{
+			u8 shouldExist = 0;
+			p.Do(shouldExist);
+			if (shouldExist != 1 || p.GetMode() != PointerWrap::MODE_READ)
+				break;
+
+			Event ev;
+			EventDoState(p, &ev);
+			PushEvent(ev);
+		}
+	}
+	else
+	{
+		std::vector<Event> events(event_queue);
+		std::sort(events.begin(), events.end(), std::greater<Event>());
+		for (auto it = events.rbegin(); it != events.rend(); ++it)
+		{
+			u8 shouldExist = 1;
+			p.Do(shouldExist);
+			EventDoState(p, &*it);
+		}
+		u8 shouldExist = 0;
+		p.Do(shouldExist);
+	}
 	p.DoMarker("CoreTimingEvents");
 }
 
@@ -203,7 +234,6 @@ u64 GetIdleTicks()
 // schedule things to be executed on the main thread.
 void ScheduleEvent_Threadsafe(int cyclesIntoFuture, int event_type, u64 userdata)
 {
-	std::lock_guard<std::mutex> lk(tsWriteLock);
 	Event ne;
 	ne.time = globalTimer + cyclesIntoFuture;
 	ne.type = event_type;
@@ -227,30 +257,9 @@ void ScheduleEvent_Threadsafe_Immediate(int event_type, u64 userdata)
 
 void ClearPendingEvents()
 {
-	while (first)
-	{
-		Event *e = first->next;
-		FreeEvent(first);
-		first = e;
-	}
-}
-
-static void AddEventToQueue(Event* ne)
-{
-	Event* prev = nullptr;
-	Event** pNext = &first;
-	for (;;)
-	{
-		Event*& next = *pNext;
-		if (!next || ne->time < next->time)
-		{
-			ne->next = next;
-			next = ne;
-			break;
-		}
-		prev = next;
-		pNext = &prev->next;
-	}
+	event_queue.clear();
+	for (EventType& event_type : event_types)
+		event_type.num_scheduled = 0;
 }
 
 // This must be run ONLY from within the CPU thread
@@ -258,11 +267,11 @@ static void AddEventToQueue(Event* ne)
 // than Advance
 void ScheduleEvent(int cyclesIntoFuture, int event_type, u64 userdata)
 {
-	Event *ne = GetNewEvent();
-	ne->userdata = userdata;
-	ne->type = event_type;
-	ne->time = globalTimer + cyclesIntoFuture;
-	AddEventToQueue(ne);
+	Event ne;
+	ne.userdata = userdata;
+	ne.type = event_type;
+	ne.time = globalTimer + cyclesIntoFuture;
+	PushEvent(ne);
 }
 
 void RegisterAdvanceCallback(void (*callback)(int cyclesExecuted))
@@ -272,56 +281,21 @@ void RegisterAdvanceCallback(void (*callback)(int cyclesExecuted))
 
 bool IsScheduled(int event_type)
 {
-	if (!first)
-		return false;
-	Event *e = first;
-	while (e)
-	{
-		if (e->type == event_type)
-			return true;
-		e = e->next;
-	}
-	return false;
+	return event_types[event_type].num_scheduled != 0;
 }
 
 void RemoveEvent(int event_type)
 {
-	if (!first)
+	// Most types are never pending when they get removed, so only touch the heap when
+	// this one is. Rebuilding it is a single linear pass over a few dozen events.
+	if (!event_types[event_type].num_scheduled)
 		return;
 
-	while (first)
-	{
-		if (first->type == event_type)
-		{
-			Event *next = first->next;
-			FreeEvent(first);
-			first = next;
-		}
-		else
-		{
-			break;
-		}
-	}
-
-	if (!first)
-		return;
-
-	Event *prev = first;
-	Event *ptr = prev->next;
-	while (ptr)
-	{
-		if (ptr->type == event_type)
-		{
-			prev->next = ptr->next;
-			FreeEvent(ptr);
-			ptr = prev->next;
-		}
-		else
-		{
-			prev = ptr;
-			ptr = ptr->next;
-		}
-	}
+	auto end = std::remove_if(event_queue.begin(), event_queue.end(),
+		[event_type](const Event& ev) { return ev.type == event_type; });
+	event_queue.erase(end, event_queue.end());
+	std::make_heap(event_queue.begin(), event_queue.end(), std::greater<Event>());
+	event_types[event_type].num_scheduled = 0;
 }
 
 void RemoveAllEvents(int event_type)
@@ -355,36 +329,18 @@ void ProcessFifoWaitEvents()
 {
 	MoveEvents();
 
-	if (!first)
-		return;
-
-	while (first)
+	while (!event_queue.empty() && event_queue.front().time <= globalTimer)
 	{
-		if (first->time <= globalTimer)
-		{
-			Event* evt = first;
-			first = first->next;
-			event_types[evt->type].callback(evt->userdata, (int)(globalTimer - evt->time));
-			FreeEvent(evt);
-		}
-		else
-		{
-			break;
-		}
+		Event evt = PopFirstEvent();
+		event_types[evt.type].callback(evt.userdata, (int)(globalTimer - evt.time));
 	}
 }
 
 void MoveEvents()
 {
-	BaseEvent sevt;
-	while (tsQueue.Pop(sevt))
-	{
-		Event *evt = GetNewEvent();
-		evt->time = sevt.time;
-		evt->userdata = sevt.userdata;
-		evt->type = sevt.type;
-		AddEventToQueue(evt);
-	}
+	Event evt;
+	while (tsQueue.Pop(evt))
+		PushEvent(evt);
 }
 
 void Advance()
@@ -395,31 +351,22 @@ void Advance()
 	globalTimer += cyclesExecuted;
 	PowerPC::ppcState.downcount = slicelength;
 
-	while (first)
+	while (!event_queue.empty() && event_queue.front().time <= globalTimer)
 	{
-		if (first->time <= globalTimer)
-		{
-			//LOG(POWERPC, "[Scheduler] %s     (%lld, %lld) ",
-			//             event_types[first->type].name ? event_types[first->type].name : "?", (u64)globalTimer, (u64)first->time);
-			Event* evt = first;
-			first = first->next;
-			event_types[evt->type].callback(evt->userdata, (int)(globalTimer - evt->time));
-			FreeEvent(evt);
-		}
-		else
-		{
-			break;
-		}
+		//LOG(POWERPC, "[Scheduler] %s     (%lld, %lld) ",
+		//             event_types[event_queue.front().type].name.c_str(), (u64)globalTimer, (u64)event_queue.front().time);
+		Event evt = PopFirstEvent();
+		event_types[evt.type].callback(evt.userdata, (int)(globalTimer - evt.time));
 	}
 
-	if (!first)
+	if (event_queue.empty())
 	{
 		WARN_LOG(POWERPC, "WARNING - no events in queue. Setting downcount to 10000");
 		PowerPC::ppcState.downcount += 10000;
 	}
 	else
 	{
-		slicelength = (int)(first->time - globalTimer);
+		slicelength = (int)(event_queue.front().time - globalTimer);
 		if (slicelength > maxSliceLength)
 			slicelength = maxSliceLength;
 		PowerPC::ppcState.downcount = slicelength;
@@ -431,12 +378,10 @@ void Advance()
 
 void LogPendingEvents()
 {
-	Event *ptr = first;
-	while (ptr)
-	{
-		INFO_LOG(POWERPC, "PENDING: Now: %" PRId64 " Pending: %" PRId64 " Type: %d", globalTimer, ptr->time, ptr->type);
-		ptr = ptr->next;
-	}
+	std::vector<Event> events(event_queue);
+	std::sort(events.begin(), events.end(), std::greater<Event>());
+	for (auto it = events.rbegin(); it != events.rend(); ++it)
+		INFO_LOG(POWERPC, "PENDING: Now: %" PRId64 " Pending: %" PRId64 " Type: %d", globalTimer, it->time, it->type);
 }
 
 void Idle()
@@ -460,19 +405,20 @@ void Idle()
 
 std::string GetScheduledEventsSummary()
 {
-	Event *ptr = first;
+	std::vector<Event> events(event_queue);
+	std::sort(events.begin(), events.end(), std::greater<Event>());
+
 	std::string text = "Scheduled events\n";
 	text.reserve(1000);
-	while (ptr)
+	for (auto it = events.rbegin(); it != events.rend(); ++it)
 	{
-		unsigned int t = ptr->type;
+		unsigned int t = it->type;
 		if (t >= event_types.size())
 			PanicAlertT("Invalid event type %i", t);
 
-		const std::string& name = event_types[ptr->type].name;
+		const std::string& name = event_types[it->type].name;
 
-		text += StringFromFormat("%s : %" PRIi64 " %016" PRIx64 "\n", name.c_str(), ptr->time, ptr->userdata);
-		ptr = ptr->next;
+		text += StringFromFormat("%s : %" PRIi64 " %016" PRIx64 "\n", name.c_str(), it->time, it->userdata);
 	}
 	return text;
 }
@@ -487,7 +487,7 @@ void ClearCoverInterrupt()
 
 bool DVDRead(u32 _iDVDOffset, u32 _iRamAddress, u32 _iLength)
 {
-	return VolumeHandler::ReadToPtr(Memory::GetPointer(_iRamAddress), _iDVDOffset, _iLength);
+	return VolumeHandler::ReadToEmu(_iRamAddress, _iDVDOffset, _iLength);
 }
 
 void RegisterMMIO(MMIO::Mapping* mmio, u32 base)
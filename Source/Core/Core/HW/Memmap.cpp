@@ -8,6 +8,11 @@
 // However, if a JITed instruction (for example lwz) wants to access a bad memory area that call
 // may be redirected here (for example to Read_U32()).
 
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
 #include "Common/ChunkFile.h"
 #include "Common/CommonTypes.h"
 #include "Common/MemArena.h"
@@ -116,6 +121,437 @@ static MemoryView views[] =
 };
 static const int num_views = sizeof(views) / sizeof(MemoryView);
 
+#define HW_PAGE_SIZE 4096
+static_assert(HW_PAGE_SIZE == WATCH_PAGE_SIZE, "write watching works on hardware pages");
+
+// Translated pages currently mapped into the arena at base + their effective address, and
+// whether they're writable.
+static std::unordered_map<u32, bool> s_translated_pages;
+
+// Addresses that ReadFromHardware/WriteToHardware access without translating them.
+static bool IsUntranslatedAddress(u32 address)
+{
+	switch (address >> 28)
+	{
+	case 0x0: case 0x8: case 0xC:
+		return true;
+	case 0x1: case 0x9: case 0xD:
+		return m_pEXRAM != nullptr;
+	case 0x4: case 0x7:
+		return bFakeVMEM;
+	case 0xE:
+		return address < 0xE0000000 + L1_CACHE_SIZE;
+	default:
+		return false;
+	}
+}
+
+bool MapTranslatedPage(u32 _Address, bool write)
+{
+#if _ARCH_64
+	if (!bMMU || !base || IsUntranslatedAddress(_Address))
+		return false;
+
+	u32 page = _Address & ~(HW_PAGE_SIZE - 1);
+	auto it = s_translated_pages.find(page);
+	if (it != s_translated_pages.end() && (it->second || !write))
+		return false;
+
+	// Translating sets the PTE's R and C bits, as the access itself would have. A write
+	// references the page too, so both are set before the page becomes writable.
+	if (!TranslateAddress(_Address, FLAG_READ) || (write && !TranslateAddress(_Address, FLAG_WRITE)))
+		return false;
+	// Only pages in RAM make it into the translation cache.
+	u32 paddr = GetTranslationCache(write ? FLAG_WRITE : FLAG_READ)[_Address / HW_PAGE_SIZE];
+	if (!paddr)
+		return false;
+
+	s64 offset = -1;
+	for (const MemoryView& view : views)
+	{
+		bool physical = view.out_ptr == &m_pRAM || view.out_ptr == &m_pEXRAM;
+		if (physical && view.mapped_ptr && paddr - view.virtual_address < view.size)
+			offset = view.shm_position + (paddr - view.virtual_address);
+	}
+	if (offset < 0)
+		return false;
+
+	if (it != s_translated_pages.end())
+	{
+		g_arena.ReleaseView(base + page, HW_PAGE_SIZE);
+		s_translated_pages.erase(it);
+	}
+	if (!g_arena.CreatePageView(offset, HW_PAGE_SIZE, base + page, write))
+		return false;
+
+	s_translated_pages[page] = write;
+	return true;
+#else
+	return false;
+#endif
+}
+
+void UnmapTranslatedPage(u32 _Address)
+{
+	auto it = s_translated_pages.find(_Address & ~(HW_PAGE_SIZE - 1));
+	if (it == s_translated_pages.end())
+		return;
+
+	g_arena.ReleaseView(base + it->first, HW_PAGE_SIZE);
+	s_translated_pages.erase(it);
+}
+
+void UnmapTranslatedPages()
+{
+	for (const auto& page : s_translated_pages)
+		g_arena.ReleaseView(base + page.first, HW_PAGE_SIZE);
+	s_translated_pages.clear();
+}
+
+// Write watching, see WatchRange.
+static std::mutex s_write_watch_lock;
+static bool s_write_watch_enabled = false;
+static u64 s_write_generation = 0;
+
+// Pages are numbered through MEM1, the fake VMEM and EXRAM in that order, whether or not the
+// latter two are mapped.
+enum
+{
+	FAKEVMEM_FIRST_PAGE = RAM_SIZE / HW_PAGE_SIZE,
+	EXRAM_FIRST_PAGE = FAKEVMEM_FIRST_PAGE + FAKEVMEM_SIZE / HW_PAGE_SIZE,
+	NUM_WATCH_PAGES = EXRAM_FIRST_PAGE + EXRAM_SIZE / HW_PAGE_SIZE,
+};
+
+// One entry per page: the generation of its last recorded write, and whether it's currently
+// write protected.
+static std::vector<u64> s_page_write_generation;
+static std::vector<bool> s_page_watched;
+
+// The copy-on-write snapshot, see SnapshotWrittenPages: per page, where its contents still have
+// to be copied to, and the pages the snapshot has.
+static std::vector<u8*> s_page_snapshot;
+static std::vector<u32> s_snapshot_pages;
+
+// Set while saving or loading an incremental state, see BeginDeltaState.
+static bool s_delta_state = false;
+static u64 s_delta_generation = 0;
+static std::vector<u32> s_delta_pages;
+
+static bool GetWatchPage(u32 address, u32* page)
+{
+	switch (address >> 28)
+	{
+	case 0x0: case 0x8: case 0xC:
+		if ((address & 0x0FFFFFFF) >= RAM_SIZE)
+			return false;
+		*page = (address & RAM_MASK) / HW_PAGE_SIZE;
+		return true;
+	case 0x7:
+		if (!m_pFakeVMEM || (address & 0x0FFFFFFF) < 0x10000000 - FAKEVMEM_SIZE)
+			return false;
+		*page = FAKEVMEM_FIRST_PAGE + (address & FAKEVMEM_MASK) / HW_PAGE_SIZE;
+		return true;
+	case 0x1: case 0x9: case 0xD:
+		if (!m_pEXRAM || (address & 0x0FFFFFFF) >= EXRAM_SIZE)
+			return false;
+		*page = EXRAM_FIRST_PAGE + (address & EXRAM_MASK) / HW_PAGE_SIZE;
+		return true;
+	default:
+		return false;
+	}
+}
+
+// The memory behind a page, or nullptr if its region isn't mapped.
+static u8* GetPagePointer(u32 page)
+{
+	if (page < FAKEVMEM_FIRST_PAGE)
+		return m_pRAM ? m_pRAM + page * HW_PAGE_SIZE : nullptr;
+	if (page < EXRAM_FIRST_PAGE)
+		return m_pFakeVMEM ? m_pFakeVMEM + (page - FAKEVMEM_FIRST_PAGE) * HW_PAGE_SIZE : nullptr;
+	if (page < NUM_WATCH_PAGES)
+		return m_pEXRAM ? m_pEXRAM + (page - EXRAM_FIRST_PAGE) * HW_PAGE_SIZE : nullptr;
+	return nullptr;
+}
+
+// Changes the protection of a page in every view that maps it, mirrors included.
+static void SetPageWritable(u32 page, bool writable)
+{
+	u8** physical;
+	u32 offset;
+	if (page < FAKEVMEM_FIRST_PAGE)
+	{
+		physical = &m_pRAM;
+		offset = page * HW_PAGE_SIZE;
+	}
+	else if (page < EXRAM_FIRST_PAGE)
+	{
+		physical = &m_pFakeVMEM;
+		offset = (page - FAKEVMEM_FIRST_PAGE) * HW_PAGE_SIZE;
+	}
+	else
+	{
+		physical = &m_pEXRAM;
+		offset = (page - EXRAM_FIRST_PAGE) * HW_PAGE_SIZE;
+	}
+
+	u32 shm_position = 0;
+	for (const MemoryView& view : views)
+	{
+		if (view.out_ptr == physical)
+			shm_position = view.shm_position + offset;
+	}
+
+	for (const MemoryView& view : views)
+	{
+		if (!view.mapped_ptr || shm_position - view.shm_position >= view.size)
+			continue;
+
+		u8* ptr = (u8*)view.mapped_ptr + (shm_position - view.shm_position);
+		if (writable)
+			UnWriteProtectMemory(ptr, HW_PAGE_SIZE);
+		else
+			WriteProtectMemory(ptr, HW_PAGE_SIZE);
+	}
+}
+
+// Call with s_write_watch_lock held.
+static void CopySnapshotPage(u32 page)
+{
+	if (s_page_snapshot[page])
+	{
+		memcpy(s_page_snapshot[page], GetPagePointer(page), HW_PAGE_SIZE);
+		s_page_snapshot[page] = nullptr;
+	}
+}
+
+// Call with s_write_watch_lock held.
+static void CopySnapshotPages()
+{
+	for (u32 page : s_snapshot_pages)
+		CopySnapshotPage(page);
+	s_snapshot_pages.clear();
+}
+
+// Records a write to a watched page and makes it writable again, once a snapshot that still
+// needs its contents has them. Call with s_write_watch_lock held.
+static void MarkPageWritten(u32 page, u64 generation)
+{
+	CopySnapshotPage(page);
+	SetPageWritable(page, true);
+	s_page_watched[page] = false;
+	s_page_write_generation[page] = generation;
+}
+
+void EnableWriteWatch()
+{
+#if _ARCH_64 && !defined(__APPLE__)
+	// Mach exception ports only catch the CPU thread's faults, and with the MMU on the
+	// arena is busy with translated pages.
+	if (bMMU)
+		return;
+
+	std::lock_guard<std::mutex> lk(s_write_watch_lock);
+	// Anything watched before this went unseen while disabled, so the generation keeps counting
+	// and every page starts out as just written.
+	s_page_write_generation.assign(NUM_WATCH_PAGES, ++s_write_generation);
+	s_page_watched.assign(NUM_WATCH_PAGES, false);
+	s_page_snapshot.assign(NUM_WATCH_PAGES, nullptr);
+	s_write_watch_enabled = true;
+#endif
+}
+
+void DisableWriteWatch()
+{
+	std::lock_guard<std::mutex> lk(s_write_watch_lock);
+	if (!s_write_watch_enabled)
+		return;
+
+	CopySnapshotPages();
+	for (u32 page = 0; page < s_page_watched.size(); page++)
+	{
+		if (s_page_watched[page])
+			SetPageWritable(page, true);
+	}
+	s_page_write_generation.clear();
+	s_page_watched.clear();
+	s_page_snapshot.clear();
+	s_write_watch_enabled = false;
+}
+
+bool WatchRange(u32 _Address, u32 _iLength, u64* generation)
+{
+	u32 first, last;
+	if (!_iLength || !GetWatchPage(_Address, &first) || !GetWatchPage(_Address + _iLength - 1, &last) || last < first)
+		return false;
+
+	std::lock_guard<std::mutex> lk(s_write_watch_lock);
+	if (!s_write_watch_enabled)
+		return false;
+
+	for (u32 page = first; page <= last; page++)
+	{
+		if (!s_page_watched[page])
+		{
+			SetPageWritable(page, false);
+			s_page_watched[page] = true;
+		}
+	}
+	*generation = s_write_generation;
+	return true;
+}
+
+bool WasWrittenSince(u32 _Address, u32 _iLength, u64 generation)
+{
+	u32 first, last;
+	if (!_iLength || !GetWatchPage(_Address, &first) || !GetWatchPage(_Address + _iLength - 1, &last) || last < first)
+		return true;
+
+	std::lock_guard<std::mutex> lk(s_write_watch_lock);
+	if (!s_write_watch_enabled)
+		return true;
+
+	for (u32 page = first; page <= last; page++)
+	{
+		if (s_page_write_generation[page] > generation)
+			return true;
+	}
+	return false;
+}
+
+// Call with s_write_watch_lock held.
+static u64 WatchAllPagesLocked()
+{
+	if (s_write_watch_enabled)
+	{
+		for (u32 page = 0; page < NUM_WATCH_PAGES; page++)
+		{
+			if (!s_page_watched[page] && GetPagePointer(page))
+			{
+				SetPageWritable(page, false);
+				s_page_watched[page] = true;
+			}
+		}
+	}
+	return ++s_write_generation;
+}
+
+// Call with s_write_watch_lock held.
+static void GetWrittenPagesLocked(u64 generation, std::vector<u32>* pages)
+{
+	pages->clear();
+	for (u32 page = 0; page < NUM_WATCH_PAGES; page++)
+	{
+		if (GetPagePointer(page) && (!s_write_watch_enabled || s_page_write_generation[page] > generation))
+			pages->push_back(page);
+	}
+}
+
+u64 WatchAllPages()
+{
+	std::lock_guard<std::mutex> lk(s_write_watch_lock);
+	return WatchAllPagesLocked();
+}
+
+void GetWrittenPages(u64 generation, std::vector<u32>* pages)
+{
+	std::lock_guard<std::mutex> lk(s_write_watch_lock);
+	GetWrittenPagesLocked(generation, pages);
+}
+
+u64 SnapshotWrittenPages(u64 generation, std::vector<u32>* pages, std::unique_ptr<u8[]>* data)
+{
+	std::lock_guard<std::mutex> lk(s_write_watch_lock);
+
+	// Only one snapshot at a time.
+	CopySnapshotPages();
+
+	GetWrittenPagesLocked(generation, pages);
+	data->reset(new u8[pages->size() * HW_PAGE_SIZE]);
+	for (size_t i = 0; i < pages->size(); i++)
+	{
+		u8* dest = data->get() + i * HW_PAGE_SIZE;
+		if (s_write_watch_enabled)
+			s_page_snapshot[(*pages)[i]] = dest;
+		else
+			memcpy(dest, GetPagePointer((*pages)[i]), HW_PAGE_SIZE);
+	}
+	if (s_write_watch_enabled)
+		s_snapshot_pages = *pages;
+
+	return WatchAllPagesLocked();
+}
+
+void FinishSnapshot()
+{
+	// Page by page, so that the CPU doesn't wait on all of it when it writes to one.
+	for (size_t i = 0; ; i++)
+	{
+		std::lock_guard<std::mutex> lk(s_write_watch_lock);
+		if (i >= s_snapshot_pages.size())
+		{
+			s_snapshot_pages.clear();
+			return;
+		}
+		CopySnapshotPage(s_snapshot_pages[i]);
+	}
+}
+
+bool HandleWriteWatchFault(uintptr_t access_address)
+{
+	if (!base || access_address < (uintptr_t)base || access_address - (uintptr_t)base >= 0x100000000ULL)
+		return false;
+
+	u32 page;
+	if (!GetWatchPage((u32)(access_address - (uintptr_t)base), &page))
+		return false;
+
+	std::lock_guard<std::mutex> lk(s_write_watch_lock);
+	if (!s_write_watch_enabled || !s_page_watched[page])
+		return false;
+
+	MarkPageWritten(page, ++s_write_generation);
+	return true;
+}
+
+// Unlike the CPU's stores, a system call writing to a watched page fails instead of faulting,
+// so host writes record the write and unprotect the pages up front.
+static void PrepareHostWritePages(u32 first, u32 last)
+{
+	std::lock_guard<std::mutex> lk(s_write_watch_lock);
+	if (!s_write_watch_enabled)
+		return;
+
+	++s_write_generation;
+	for (u32 page = first; page <= last && page < NUM_WATCH_PAGES; page++)
+	{
+		if (s_page_watched[page])
+			MarkPageWritten(page, s_write_generation);
+	}
+}
+
+static void PrepareHostWrite(u32 _Address, size_t _iLength)
+{
+	u32 first, last;
+	if (!_iLength || !GetWatchPage(_Address, &first) || !GetWatchPage(_Address + u32(_iLength) - 1, &last) || last < first)
+		return;
+
+	PrepareHostWritePages(first, last);
+}
+
+void CopyPagesToEmu(u32 first_page, const u8* data, u32 num_pages)
+{
+	if (!num_pages)
+		return;
+
+	PrepareHostWritePages(first_page, first_page + num_pages - 1);
+	for (u32 i = 0; i < num_pages; i++)
+	{
+		u8* ptr = GetPagePointer(first_page + i);
+		if (ptr)
+			memcpy(ptr, data + i * HW_PAGE_SIZE, HW_PAGE_SIZE);
+	}
+}
+
 void Init()
 {
 	bool wii = SConfig::GetInstance().m_LocalCoreStartupParameter.bWii;
@@ -142,8 +578,63 @@ void Init()
 	m_IsInitialized = true;
 }
 
+void BeginDeltaState(u64 generation)
+{
+	s_delta_state = true;
+	s_delta_generation = generation;
+}
+
+void EndDeltaState()
+{
+	s_delta_state = false;
+	s_delta_pages.clear();
+}
+
+// The pages written after s_delta_generation, each as its page number and contents.
+static void DoDeltaState(PointerWrap &p)
+{
+	// Both passes of a save have to agree on the pages, and the video backend may still write
+	// back to RAM before this, so the list is made while measuring.
+	if (p.GetMode() == PointerWrap::MODE_MEASURE)
+	{
+		if (s_delta_generation == DELTA_WITHOUT_PAGES)
+			s_delta_pages.clear();
+		else
+			GetWrittenPages(s_delta_generation, &s_delta_pages);
+	}
+	p.Do(s_delta_pages);
+
+	for (u32 page : s_delta_pages)
+	{
+		u8* ptr = GetPagePointer(page);
+		if (!ptr)
+		{
+			// A page of a region this game doesn't have, so the state is from something else.
+			p.SetMode(PointerWrap::MODE_MEASURE);
+			return;
+		}
+
+		if (p.GetMode() == PointerWrap::MODE_READ)
+			PrepareHostWritePages(page, page);
+		p.DoArray(ptr, HW_PAGE_SIZE);
+	}
+	p.DoArray(m_pL1Cache, L1_CACHE_SIZE);
+	p.DoMarker("Memory pages");
+}
+
 void DoState(PointerWrap &p)
 {
+	if (s_delta_state)
+	{
+		DoDeltaState(p);
+		if (p.GetMode() == PointerWrap::MODE_READ)
+			ClearTranslationCache();
+		return;
+	}
+
+	if (p.GetMode() == PointerWrap::MODE_READ)
+		PrepareHostWritePages(0, NUM_WATCH_PAGES - 1);
+
 	bool wii = SConfig::GetInstance().m_LocalCoreStartupParameter.bWii;
 	p.DoArray(m_pRAM, RAM_SIZE);
 	p.DoArray(m_pL1Cache, L1_CACHE_SIZE);
@@ -154,11 +645,15 @@ void DoState(PointerWrap &p)
 	if (wii)
 		p.DoArray(m_pEXRAM, EXRAM_SIZE);
 	p.DoMarker("Memory EXRAM");
+
+	if (p.GetMode() == PointerWrap::MODE_READ)
+		ClearTranslationCache();
 }
 
 void Shutdown()
 {
 	m_IsInitialized = false;
+	ClearTranslationCache();
 	u32 flags = 0;
 	if (SConfig::GetInstance().m_LocalCoreStartupParameter.bWii) flags |= MV_WII_ONLY;
 	if (bFakeVMEM) flags |= MV_FAKE_VMEM;
@@ -177,6 +672,7 @@ void Clear()
 		memset(m_pL1Cache, 0, L1_CACHE_SIZE);
 	if (SConfig::GetInstance().m_LocalCoreStartupParameter.bWii && m_pEXRAM)
 		memset(m_pEXRAM, 0, EXRAM_SIZE);
+	ClearTranslationCache();
 }
 
 bool AreMemoryBreakpointsActivated()
@@ -218,6 +714,7 @@ void CopyToEmu(u32 address, const void* data, size_t size)
 		PanicAlert("Invalid range in CopyToEmu. %lx bytes to 0x%08x", (unsigned long)size, address);
 		return;
 	}
+	PrepareHostWrite(address, size);
 	memcpy(GetPointer(address), data, size);
 }
 
@@ -4,7 +4,9 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "Common/CommonFuncs.h"
 #include "Common/CommonTypes.h"
@@ -52,6 +54,8 @@ enum
 	IO_SIZE       = 0x00010000,
 	EXRAM_SIZE    = 0x04000000,
 	EXRAM_MASK    = EXRAM_SIZE - 1,
+	// The granularity of write watching and incremental states.
+	WATCH_PAGE_SIZE = 0x00001000,
 
 	ADDR_MASK_HW_ACCESS = 0x0c000000,
 	ADDR_MASK_MEM1      = 0x20000000,
@@ -137,6 +141,60 @@ enum XCheckTLBFlag
 };
 u32 TranslateAddress(u32 _Address, XCheckTLBFlag _Flag);
 void InvalidateTLBEntry(u32 _Address);
+// Forgets all cached translations. Needed whenever SDR1, a segment register or a BAT changes.
+void ClearTranslationCache();
+// The translation cache has one entry per 4 KiB effective page: the physical address of the
+// page, which is also its offset in the fastmem arena, or 0 if the page isn't cached.
+// Reads and writes have separate caches. The JIT probes them inline.
+const u32* GetTranslationCache(XCheckTLBFlag _Flag);
+// With the MMU on, the JIT's fastmem accesses fault on every translated address. This maps
+// the page into the fastmem arena if it's backed by RAM, read-only until it's been written
+// to, and returns false if the access has to go through the slow path instead.
+bool MapTranslatedPage(u32 _Address, bool write);
+// Mapped pages go away along with their translation cache entries.
+void UnmapTranslatedPage(u32 _Address);
+void UnmapTranslatedPages();
+
+// Write watching lets the texture cache find out whether a range of RAM changed without
+// hashing it. Watched pages are mapped read-only in every view of the arena; the first write
+// to one faults, is recorded, and makes the page writable again. Needs fastmem's fault handler
+// to catch writes from every thread, so it's only enabled while the CPU thread runs with it.
+// System calls don't fault, they fail, so host code must never have the OS write into
+// GetPointer() directly; read into a buffer and CopyToEmu it instead.
+void EnableWriteWatch();
+void DisableWriteWatch();
+// Starts watching the pages of a range of physical memory. Returns false if write watching
+// isn't available, otherwise the generation to pass to WasWrittenSince later.
+bool WatchRange(u32 _Address, u32 _iLength, u64* generation);
+// Whether any page of the range was written to after WatchRange returned the generation.
+bool WasWrittenSince(u32 _Address, u32 _iLength, u64 generation);
+// Called from the fault handler; returns true if the fault was a write to a watched page.
+bool HandleWriteWatchFault(uintptr_t access_address);
+
+// Incremental save states. WatchAllPages write protects every page of MEM1, the fake VMEM and
+// EXRAM and returns a new generation; GetWrittenPages lists the page numbers written to after
+// one. Without write watching every page counts as written.
+u64 WatchAllPages();
+void GetWrittenPages(u64 generation, std::vector<u32>* pages);
+// Between these, DoState saves only the pages written after the generation, as page-indexed
+// records, and loading such a state only replaces those pages. The rest of memory is expected
+// to hold the full state the generation was taken with. Saves have to measure first.
+// DELTA_WITHOUT_PAGES leaves memory out of the state, apart from the L1 cache.
+const u64 DELTA_WITHOUT_PAGES = ~0ULL;
+void BeginDeltaState(u64 generation);
+void EndDeltaState();
+
+// A copy-on-write snapshot of the pages written after a generation, for rewind. The pages are
+// listed and copied to data, WATCH_PAGE_SIZE bytes each, either just before they're written
+// to or by FinishSnapshot, so taking one only costs the page protection. Returns the
+// generation to take the next one against. Without write watching the pages are copied right
+// away. Only one snapshot is kept going at a time.
+u64 SnapshotWrittenPages(u64 generation, std::vector<u32>* pages, std::unique_ptr<u8[]>* data);
+// Copies what's left of the snapshot; meant for a thread other than the CPU thread.
+void FinishSnapshot();
+// Copies whole pages, numbered as for GetWrittenPages, back into memory.
+void CopyPagesToEmu(u32 first_page, const u8* data, u32 num_pages);
+
 extern u32 pagetable_base;
 extern u32 pagetable_hashmask;
 }
@@ -15,6 +15,8 @@
 // Official Git repository and contact information can be found at
 // http://code.google.com/p/dolphin-emu/
 
+#include <vector>
+
 #include "Common/Atomic.h"
 #include "Common/CommonTypes.h"
 
@@ -680,6 +682,8 @@ static void GenerateISIException(u32 _EffectiveAddress)
 
 void SDRUpdated()
 {
+	ClearTranslationCache();
+
 	u32 htabmask = SDR1_HTABMASK(PowerPC::ppcState.spr[SPR_SDR]);
 	u32 x = 1;
 	u32 xx = 0;
@@ -774,8 +778,75 @@ static void UpdateTLBEntry(const XCheckTLBFlag _Flag, UPTE2 PTE2, const u32 vpa)
 	}
 }
 
+// Fast path in front of the TLB: a direct-mapped table with an entry for every effective page.
+// Entries are only filled by FLAG_READ and FLAG_WRITE translations, which have already set the
+// PTE's R or C bit, so a page that has only been read still takes the slow path on its first
+// write. Only pages backed by RAM are cached, so the JIT can access them through the fastmem
+// arena without any further checks. Like the TLB, this ignores MSR[PR] when BATs are enabled;
+// games never leave supervisor mode.
+#define TRANSLATION_CACHE_PAGES (1 << (32 - HW_PAGE_INDEX_SHIFT))
+
+static u32 translation_cache[2][TRANSLATION_CACHE_PAGES];
+// Filled entries, so clearing the cache doesn't have to touch all 8MB of it.
+static std::vector<u32> translation_cache_used[2];
+
+static inline u32* GetTranslationCacheEntry(const XCheckTLBFlag _Flag, const u32 _Address)
+{
+	return &translation_cache[_Flag == FLAG_WRITE][_Address >> HW_PAGE_INDEX_SHIFT];
+}
+
+static void UpdateTranslationCache(const XCheckTLBFlag _Flag, const u32 _Address, const u32 paddr)
+{
+	if (_Flag != FLAG_READ && _Flag != FLAG_WRITE)
+		return;
+
+	u32 page = paddr & ~(HW_PAGE_SIZE - 1);
+	bool in_ram = page != 0 && page < RAM_SIZE;
+	bool in_exram = m_pEXRAM && page >= 0x10000000 && page < 0x10000000 + EXRAM_SIZE;
+	if (!in_ram && !in_exram)
+		return;
+
+	// tlbie leaves its pages in the list, so it can grow past the number of pages.
+	std::vector<u32>& used = translation_cache_used[_Flag == FLAG_WRITE];
+	if (used.size() >= TRANSLATION_CACHE_PAGES)
+		ClearTranslationCache();
+
+	u32* entry = GetTranslationCacheEntry(_Flag, _Address);
+	if (!*entry)
+		used.push_back(_Address >> HW_PAGE_INDEX_SHIFT);
+	*entry = page;
+}
+
+void ClearTranslationCache()
+{
+	UnmapTranslatedPages();
+
+	for (int i = 0; i < 2; i++)
+	{
+		if (translation_cache_used[i].size() > TRANSLATION_CACHE_PAGES / 16)
+		{
+			memset(translation_cache[i], 0, sizeof(translation_cache[i]));
+		}
+		else
+		{
+			for (u32 page : translation_cache_used[i])
+				translation_cache[i][page] = 0;
+		}
+		translation_cache_used[i].clear();
+	}
+}
+
+const u32* GetTranslationCache(XCheckTLBFlag _Flag)
+{
+	return translation_cache[_Flag == FLAG_WRITE];
+}
+
 void InvalidateTLBEntry(u32 vpa)
 {
+	translation_cache[0][vpa >> HW_PAGE_INDEX_SHIFT] = 0;
+	translation_cache[1][vpa >> HW_PAGE_INDEX_SHIFT] = 0;
+	UnmapTranslatedPage(vpa);
+
 	tlb_entry *tlbe = tlb[0][(vpa>>HW_PAGE_INDEX_SHIFT)&HW_PAGE_INDEX_MASK];
 	if (tlbe[0].tag == (vpa & ~0xfff))
 	{
@@ -950,14 +1021,24 @@ u32 TranslateAddress(const u32 _Address, const XCheckTLBFlag _Flag)
 	// Check MSR[DR] bit before translating data addresses
 	//if (((_Flag == FLAG_READ) || (_Flag == FLAG_WRITE)) && !(MSR & (1 << (31 - 27)))) return _Address;
 
+	if (_Flag != FLAG_OPCODE)
+	{
+		// Lookups without side effects can use whatever the reads have cached.
+		u32 page = *GetTranslationCacheEntry(_Flag == FLAG_NO_EXCEPTION ? FLAG_READ : _Flag, _Address);
+		if (page)
+			return page | (_Address & (HW_PAGE_SIZE - 1));
+	}
+
 	// Technically we should do this, but almost no games, even heavy MMU ones, use any custom BATs whatsoever,
 	// so only do it where it's really needed.
+	u32 tlb_addr = 0;
 	if (SConfig::GetInstance().m_LocalCoreStartupParameter.bBAT)
-	{
-		u32 tlb_addr = TranslateBlockAddress(_Address, _Flag);
-		if (tlb_addr)
-			return tlb_addr;
-	}
-	return TranslatePageAddress(_Address, _Flag);
+		tlb_addr = TranslateBlockAddress(_Address, _Flag);
+	if (!tlb_addr)
+		tlb_addr = TranslatePageAddress(_Address, _Flag);
+
+	if (tlb_addr)
+		UpdateTranslationCache(_Flag, _Address, tlb_addr);
+	return tlb_addr;
 }
 } // namespace
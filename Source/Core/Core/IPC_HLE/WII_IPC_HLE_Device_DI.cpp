@@ -179,7 +179,7 @@ u32 CWII_IPC_HLE_Device_di::ExecuteCommand(u32 _BufferIn, u32 _BufferInSize, u32
 
 	case DVDLowReadDiskID:
 		{
-			VolumeHandler::RAWReadToPtr(Memory::GetPointer(_BufferOut), 0, _BufferOutSize);
+			VolumeHandler::RAWReadToEmu(_BufferOut, 0, _BufferOutSize);
 
 			INFO_LOG(WII_IPC_DVD, "DVDLowReadDiskID %s",
 				ArrayToString(Memory::GetPointer(_BufferOut), _BufferOutSize, _BufferOutSize).c_str());
@@ -219,7 +219,7 @@ u32 CWII_IPC_HLE_Device_di::ExecuteCommand(u32 _BufferIn, u32 _BufferInSize, u32
 				Size = _BufferOutSize;
 			}
 
-			if (!VolumeHandler::ReadToPtr(Memory::GetPointer(_BufferOut), DVDAddress, Size))
+			if (!VolumeHandler::ReadToEmu(_BufferOut, DVDAddress, Size))
 			{
 				PanicAlertT("DVDLowRead - Fatal Error: failed to read from volume");
 			}
@@ -312,7 +312,7 @@ u32 CWII_IPC_HLE_Device_di::ExecuteCommand(u32 _BufferIn, u32 _BufferInSize, u32
 				PanicAlertT("Detected attempt to read more data from the DVD than fit inside the out buffer. Clamp.");
 				Size = _BufferOutSize;
 			}
-			if (!VolumeHandler::RAWReadToPtr(Memory::GetPointer(_BufferOut), DVDAddress, Size))
+			if (!VolumeHandler::RAWReadToEmu(_BufferOut, DVDAddress, Size))
 			{
 				PanicAlertT("DVDLowUnencryptedRead - Fatal Error: failed to read from volume");
 			}
@@ -36,6 +36,7 @@
 // need to include this before polarssl/aes.h,
 // otherwise we may not get __STDC_FORMAT_MACROS
 #include <cinttypes>
+#include <vector>
 
 #include <polarssl/aes.h>
 
@@ -419,10 +420,12 @@ bool CWII_IPC_HLE_Device_es::IOCtlV(u32 _CommandAddress)
 							ERROR_LOG(WII_IPC_ES, "ES: couldn't seek!");
 						}
 						WARN_LOG(WII_IPC_ES, "2 %p", pFile->GetHandle());
-						if (!pFile->ReadBytes(pDest, Size))
+						std::vector<u8> buffer(Size);
+						if (!pFile->ReadBytes(buffer.data(), Size))
 						{
 							ERROR_LOG(WII_IPC_ES, "ES: short read; returning uninitialized data!");
 						}
+						Memory::CopyToEmu(Addr, buffer.data(), Size);
 					}
 					rContent.m_Position += Size;
 				} else {
@@ -57,6 +57,12 @@ void CWII_IPC_HLE_Device_hid::handleUsbUpdates(struct libusb_transfer *transfer)
 	if (transfer->status == LIBUSB_TRANSFER_COMPLETED)
 	{
 		ret = transfer->length;
+
+		if (transfer->type == LIBUSB_TRANSFER_TYPE_INTERRUPT && (transfer->endpoint & LIBUSB_ENDPOINT_IN))
+		{
+			u32 data = Memory::Read_U32(Memory::Read_U32(replyAddress + 0x10) + 0x1C);
+			Memory::CopyToEmu(data, transfer->buffer, transfer->actual_length);
+		}
 	}
 
 	// The original hardware overwrites the command type with the async reply type.
@@ -226,9 +232,15 @@ bool CWII_IPC_HLE_Device_hid::IOCtl(u32 _CommandAddress)
 			break;
 		}
 
+		// libusb's thread fills IN transfers, so they go through a buffer that the callback
+		// copies to emulated memory, see Memory::CopyToEmu.
 		struct libusb_transfer *transfer = libusb_alloc_transfer(0);
-		transfer->flags |= LIBUSB_TRANSFER_FREE_TRANSFER;
-		libusb_fill_interrupt_transfer(transfer, dev_handle, endpoint, Memory::GetPointer(data), length,
+		transfer->flags |= LIBUSB_TRANSFER_FREE_BUFFER | LIBUSB_TRANSFER_FREE_TRANSFER;
+
+		u8 * buffer = (u8*)malloc(length);
+		if (!(endpoint & LIBUSB_ENDPOINT_IN))
+			Memory::CopyFromEmu(buffer, data, length);
+		libusb_fill_interrupt_transfer(transfer, dev_handle, endpoint, buffer, length,
 									   handleUsbUpdates, (void*)(size_t)_CommandAddress, 0);
 		libusb_submit_transfer(transfer);
 
@@ -2,6 +2,8 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <vector>
+
 #include "Common/CommonTypes.h"
 #include "Common/SDCardUtil.h"
 
@@ -399,8 +401,10 @@ u32 CWII_IPC_HLE_Device_sdio_slot0::ExecuteCommand(u32 _BufferIn, u32 _BufferInS
 				ERROR_LOG(WII_IPC_SD, "Seek failed WTF");
 
 
-			if (m_Card.ReadBytes(Memory::GetPointer(req.addr), size))
+			std::vector<u8> buffer(size);
+			if (m_Card.ReadBytes(buffer.data(), size))
 			{
+				Memory::CopyToEmu(req.addr, buffer.data(), size);
 				DEBUG_LOG(WII_IPC_SD, "Outbuffer size %i got %i", _rwBufferSize, size);
 			}
 			else
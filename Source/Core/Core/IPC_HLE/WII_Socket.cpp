@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <vector>
 
 #include "Core/Core.h"
 #include "Core/IPC_HLE/WII_IPC_HLE.h"
@@ -459,8 +460,8 @@ void WiiSocket::Update(bool read, bool write, bool except)
 				case IOCTLV_SO_RECVFROM:
 				{
 					u32 flags = Memory::Read_U32(BufferIn + 0x04);
-					// Not a string, windows requires a char* for recvfrom
-					char* data = (char*)Memory::GetPointer(BufferOut);
+					// Received into a buffer and then copied, see Memory::CopyToEmu
+					std::vector<char> data(BufferOutSize);
 					int data_len = BufferOutSize;
 
 					sockaddr_in local_name;
@@ -487,16 +488,18 @@ void WiiSocket::Update(bool read, bool write, bool except)
 					}
 #endif
 					socklen_t addrlen = sizeof(sockaddr_in);
-					int ret = recvfrom(fd, data, data_len, flags,
+					int ret = recvfrom(fd, data.data(), data_len, flags,
 									BufferOutSize2 ? (struct sockaddr*) &local_name : nullptr,
 									BufferOutSize2 ? &addrlen : nullptr);
+					if (ret > 0)
+						Memory::CopyToEmu(BufferOut, data.data(), ret);
 					ReturnValue = WiiSockMan::GetNetErrorCode(ret, BufferOutSize2 ? "SO_RECVFROM" : "SO_RECV", true);
 
 					INFO_LOG(WII_IPC_NET, "%s(%d, %p) Socket: %08X, Flags: %08X, "
 					"BufferIn: (%08x, %i), BufferIn2: (%08x, %i), "
 					"BufferOut: (%08x, %i), BufferOut2: (%08x, %i)",
 					BufferOutSize2 ? "IOCTLV_SO_RECVFROM " : "IOCTLV_SO_RECV ",
-					ReturnValue, data, fd, flags,
+					ReturnValue, Memory::GetPointer(BufferOut), fd, flags,
 					BufferIn, BufferInSize, BufferIn2, BufferInSize2,
 					BufferOut, BufferOutSize, BufferOut2, BufferOutSize2);
 
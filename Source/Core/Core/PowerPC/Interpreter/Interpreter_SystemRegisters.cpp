@@ -175,6 +175,7 @@ static void SetSR(int index, u32 value)
 {
 	DEBUG_LOG(POWERPC, "%08x: MMU: Segment register %i set to %08x", PowerPC::ppcState.pc, index, value);
 	PowerPC::ppcState.sr[index] = value;
+	Memory::ClearTranslationCache();
 }
 
 void Interpreter::mtsr(UGeckoInstruction _inst)
@@ -354,6 +355,27 @@ void Interpreter::mtspr(UGeckoInstruction _inst)
 		Memory::SDRUpdated();
 		break;
 
+	// Data BATs are checked before the page table, so cached page translations may be stale now.
+	case SPR_DBAT0U:
+	case SPR_DBAT0L:
+	case SPR_DBAT1U:
+	case SPR_DBAT1L:
+	case SPR_DBAT2U:
+	case SPR_DBAT2L:
+	case SPR_DBAT3U:
+	case SPR_DBAT3L:
+	case SPR_DBAT4U:
+	case SPR_DBAT4L:
+	case SPR_DBAT5U:
+	case SPR_DBAT5L:
+	case SPR_DBAT6U:
+	case SPR_DBAT6L:
+	case SPR_DBAT7U:
+	case SPR_DBAT7L:
+	case SPR_HID4:
+		Memory::ClearTranslationCache();
+		break;
+
 	case SPR_XER:
 		SetXER(rSPR(iIndex));
 		break;
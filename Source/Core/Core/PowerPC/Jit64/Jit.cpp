@@ -12,14 +12,17 @@
 
 #include "Common/CommonTypes.h"
 #include "Common/StringUtil.h"
+#include "Core/CoreTiming.h"
 #include "Core/PatchEngine.h"
 #include "Core/HLE/HLE.h"
 #include "Core/HW/ProcessorInterface.h"
 #include "Core/PowerPC/Profiler.h"
+#include "Core/PowerPC/Interpreter/Interpreter.h"
 #include "Core/PowerPC/Jit64/Jit.h"
 #include "Core/PowerPC/Jit64/Jit64_Tables.h"
 #include "Core/PowerPC/Jit64/JitAsm.h"
 #include "Core/PowerPC/Jit64/JitRegCache.h"
+#include "Core/PowerPC/JitCommon/JitProfile.h"
 #if defined(_DEBUG) || defined(DEBUGFAST)
 #include "Common/GekkoDisassembler.h"
 #endif
@@ -200,6 +203,7 @@ void Jit64::Init()
 	// important: do this *after* generating the global asm routines, because we can't use farcode in them.
 	// it'll crash because the farcode functions get cleared on JIT clears.
 	farcode.Init(js.memcheck ? FARCODE_SIZE_MMU : FARCODE_SIZE);
+	ResetCodeRings();
 
 	code_block.m_stats = &js.st;
 	code_block.m_gpa = &js.gpa;
@@ -213,6 +217,8 @@ void Jit64::ClearCache()
 	trampolines.ClearCodeSpace();
 	farcode.ClearCodeSpace();
 	ClearCodeSpace();
+	ResetCodeRings();
+	m_interpreted_runs.clear();
 	m_clear_cache_asap = false;
 }
 
@@ -341,6 +347,11 @@ void Jit64::JustWriteExit(u32 destination, bool bl, u32 after)
 	linkData.exitAddress = destination;
 	linkData.linkStatus = false;
 
+	// Always store the pc, so that the block cache can point the exit back at the
+	// dispatcher if the destination gets evicted.
+	MOV(32, PPCSTATE(pc), Imm32(destination));
+	linkData.exitPtrs = GetWritableCodePtr();
+
 	// Link opportunity!
 	int block;
 	if (jo.enableBlocklink && (block = blocks.GetBlockNumberFromStartAddress(destination)) >= 0)
@@ -348,7 +359,6 @@ void Jit64::JustWriteExit(u32 destination, bool bl, u32 after)
 		// It exists! Joy of joy!
 		JitBlock* jb = blocks.GetBlock(block);
 		const u8* addr = jb->checkedEntry;
-		linkData.exitPtrs = GetWritableCodePtr();
 		if (bl)
 			CALL(addr);
 		else
@@ -357,8 +367,6 @@ void Jit64::JustWriteExit(u32 destination, bool bl, u32 after)
 	}
 	else
 	{
-		MOV(32, PPCSTATE(pc), Imm32(destination));
-		linkData.exitPtrs = GetWritableCodePtr();
 		if (bl)
 			CALL(asm_routines.dispatcher);
 		else
@@ -442,6 +450,24 @@ void Jit64::WriteExceptionExit()
 	JMP(asm_routines.dispatcher, true);
 }
 
+bool Jit64::IsIdleLoop(const PPCAnalyst::CodeOp* op)
+{
+	return op->branchIsIdleLoop &&
+	       SConfig::GetInstance().m_LocalCoreStartupParameter.bSkipIdle &&
+	       PowerPC::GetState() != PowerPC::CPU_STEPPING;
+}
+
+void Jit64::WriteIdleExit(u32 destination)
+{
+	// Going around the loop again won't change anything until the next event runs, so let
+	// it run now. The loop is checked again afterwards.
+	ABI_PushRegistersAndAdjustStack({}, 0);
+	ABI_CallFunction(reinterpret_cast<void *>(&CoreTiming::Idle));
+	ABI_PopRegistersAndAdjustStack({}, 0);
+	MOV(32, PPCSTATE(pc), Imm32(destination));
+	WriteExceptionExit();
+}
+
 void Jit64::WriteExternalExceptionExit()
 {
 	Cleanup();
@@ -491,18 +517,89 @@ void Jit64::Trace()
 
 void Jit64::Jit(u32 em_address)
 {
-	if (GetSpaceLeft() < 0x10000 ||
-	    farcode.GetSpaceLeft() < 0x10000 ||
-		blocks.IsFull() ||
-		SConfig::GetInstance().m_LocalCoreStartupParameter.bJITNoBlockCache ||
-		m_clear_cache_asap)
+	if (RunInInterpreter(em_address))
+		return;
+
+	if (SConfig::GetInstance().m_LocalCoreStartupParameter.bJITNoBlockCache ||
+		m_clear_cache_asap ||
+		!MakeRoomForBlock())
 	{
 		ClearCache();
 	}
 
+	CompileBlock(em_address);
+
+	// Blocks that ran in earlier sessions get compiled a few at a time while we're here
+	// anyway, so that the game finds them ready instead of stuttering on each of them.
+	JitProfile::PrefetchedBlock prefetched;
+	for (int i = 0; i < PREFETCH_BLOCKS_PER_MISS && HasRoomForBlock(); i++)
+	{
+		if (!JitProfile::PopPrefetchedBlock(&prefetched))
+			break;
+
+		bool conditional_continue = (prefetched.flags & JitProfile::BLOCK_CONDITIONAL_CONTINUE) != 0;
+		if (conditional_continue != analyzer.HasOption(PPCAnalyst::PPCAnalyzer::OPTION_CONDITIONAL_CONTINUE))
+			continue;
+		if (blocks.GetBlockNumberFromStartAddress(prefetched.address) != -1)
+			continue;
+
+		CompileBlock(prefetched.address);
+	}
+}
+
+// Code that only runs a few times (boot, loading screens) isn't worth compiling, and compiling
+// it fills up the code cache and causes stutter. So blocks run in the interpreter until they
+// have been reached iJITTierThreshold times. Stores to the FIFO found in the meantime are
+// already known when the block is finally compiled.
+bool Jit64::RunInInterpreter(u32 em_address)
+{
+	const SCoreStartupParameter& params = SConfig::GetInstance().m_LocalCoreStartupParameter;
+	if (params.iJITTierThreshold <= 0 || params.bEnableDebugging)
+		return false;
+
+	u32& runs = m_interpreted_runs[em_address];
+	if (runs >= (u32)params.iJITTierThreshold)
+	{
+		m_interpreted_runs.erase(em_address);
+		return false;
+	}
+	runs++;
+
+	Interpreter* interpreter = Interpreter::getInstance();
+	Interpreter::m_EndBlock = false;
+	int cycles = 0;
+	while (!Interpreter::m_EndBlock)
+		cycles += interpreter->SingleStepInner();
+	PowerPC::ppcState.downcount -= cycles;
+
+	// Same as the interpreter's own loop; taking an external exception a bit early is fine.
+	if (PowerPC::ppcState.Exceptions)
+	{
+		PowerPC::CheckExceptions();
+		PC = NPC;
+	}
+	return true;
+}
+
+void Jit64::CompileBlock(u32 em_address)
+{
+	if (JitProfile::IsEnabled())
+		JitProfile::GetFifoWrites(em_address, &js.fifoWriteAddresses);
+
 	int block_num = blocks.AllocateBlock(em_address);
 	JitBlock *b = blocks.GetBlock(block_num);
-	blocks.FinalizeBlock(block_num, jo.enableBlocklink, DoJit(em_address, &code_buffer, b));
+	b->farCodeStart = farcode.GetCodePtr();
+	const u8* entry = DoJit(em_address, &code_buffer, b);
+	b->farCodeSize = (u32)(farcode.GetCodePtr() - b->farCodeStart);
+	blocks.FinalizeBlock(block_num, jo.enableBlocklink, entry);
+
+	if (JitProfile::IsEnabled())
+	{
+		u32 flags = 0;
+		if (analyzer.HasOption(PPCAnalyst::PPCAnalyzer::OPTION_CONDITIONAL_CONTINUE))
+			flags |= JitProfile::BLOCK_CONDITIONAL_CONTINUE;
+		JitProfile::RecordBlock(em_address, b->originalSize, flags);
+	}
 }
 
 const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer *code_buf, JitBlock *b)
@@ -537,6 +634,7 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer *code_buf, JitBloc
 	js.blockStart = em_address;
 	js.fifoBytesThisBlock = 0;
 	js.curBlock = b;
+	js.guestLines.clear();
 	jit->js.numLoadStoreInst = 0;
 	jit->js.numFloatingPointInst = 0;
 
@@ -567,10 +665,13 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer *code_buf, JitBloc
 	}
 
 	// Conditionally add profiling code.
-	if (Profiler::g_ProfileBlocks)
+	if (Profiler::g_ProfileBlocks || Profiler::IsSampling() || JitProfile::IsEnabled())
 	{
 		MOV(64, R(RSCRATCH), Imm64((u64)&b->runCount));
 		ADD(32, MatR(RSCRATCH), Imm8(1));
+	}
+	if (Profiler::g_ProfileBlocks)
+	{
 		b->ticCounter = 0;
 		b->ticStart = 0;
 		b->ticStop = 0;
@@ -605,6 +706,9 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer *code_buf, JitBloc
 		const GekkoOPInfo *opinfo = ops[i].opinfo;
 		js.downcountAmount += opinfo->numCycles;
 
+		if (JitRegister::IsEnabled())
+			js.guestLines.push_back({ GetCodePtr(), ops[i].address });
+
 		if (i == (code_block.m_num_instructions - 1))
 		{
 			// WARNING - cmp->branch merging will screw this up.
@@ -751,7 +855,8 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer *code_buf, JitBloc
 					fpr.BindToRegister(reg, true, false);
 			}
 
-			Jit64Tables::CompileInstruction(ops[i]);
+			if (!EmitConstantResult(ops[i]))
+				Jit64Tables::CompileInstruction(ops[i]);
 
 			// If we have a register that will never be used again, flush it.
 			for (int j : ~ops[i].gprInUse)
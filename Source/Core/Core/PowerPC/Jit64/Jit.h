@@ -18,6 +18,8 @@
 // ----------
 #pragma once
 
+#include <unordered_map>
+
 #include "Common/x64ABI.h"
 #include "Common/x64Analyzer.h"
 #include "Common/x64Emitter.h"
@@ -54,6 +56,19 @@ private:
 	bool m_clear_cache_asap;
 	u8* m_stack;
 
+	// How many blocks from the warm start profile to compile whenever we're in the
+	// JIT for a block the game is about to run.
+	enum
+	{
+		PREFETCH_BLOCKS_PER_MISS = 16,
+	};
+
+	// Blocks that were run by the interpreter instead of being compiled, and how often.
+	std::unordered_map<u32, u32> m_interpreted_runs;
+
+	void CompileBlock(u32 em_address);
+	bool RunInInterpreter(u32 em_address);
+
 public:
 	Jit64() : code_buffer(32000) {}
 	~Jit64() {}
@@ -109,6 +124,9 @@ public:
 	void WriteExceptionExit();
 	void WriteExternalExceptionExit();
 	void WriteRfiExitDestInRSCRATCH();
+	// Whether the branch closes a loop that PPCAnalyzer found to be idle.
+	bool IsIdleLoop(const PPCAnalyst::CodeOp* op);
+	void WriteIdleExit(u32 destination);
 	void WriteCallInterpreter(UGeckoInstruction _inst);
 	bool Cleanup();
 
@@ -119,6 +137,7 @@ public:
 	void FinalizeCarry(Gen::CCFlags cond);
 	void FinalizeCarry(bool ca);
 	void ComputeRC(const Gen::OpArg & arg, bool needs_test = true, bool needs_sext = true);
+	bool EmitConstantResult(const PPCAnalyst::CodeOp& op);
 
 	// Use to extract bytes from a register using the regcache. offset is in bytes.
 	Gen::OpArg ExtractFromReg(int reg, int offset);
@@ -2,6 +2,7 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include "Common/JitRegister.h"
 #include "Common/MemoryUtil.h"
 
 #include "Core/PowerPC/Jit64/Jit.h"
@@ -136,9 +137,19 @@ void Jit64AsmRoutineManager::Generate()
 			// Jit might have cleared the code cache
 			ResetStack();
 
+			// Or it might have run the block in the interpreter, which uses up cycles.
+			FixupBranch interpreted;
+			if (SConfig::GetInstance().m_LocalCoreStartupParameter.iJITTierThreshold > 0)
+			{
+				CMP(32, PPCSTATE(downcount), Imm8(0));
+				interpreted = J_CC(CC_LE, true);
+			}
+
 			JMP(dispatcherNoCheck); // no point in special casing this
 
 		SetJumpTarget(bail);
+		if (SConfig::GetInstance().m_LocalCoreStartupParameter.iJITTierThreshold > 0)
+			SetJumpTarget(interpreted);
 		doTiming = GetCodePtr();
 
 		// Test external exceptions.
@@ -166,6 +177,8 @@ void Jit64AsmRoutineManager::Generate()
 	ABI_PopRegistersAndAdjustStack(ABI_ALL_CALLEE_SAVED, 8, 16);
 	RET();
 
+	JitRegister::Register(enterCode, (u32)(GetCodePtr() - enterCode), "JIT_Loop");
+
 	GenerateCommon();
 }
 
@@ -188,10 +201,13 @@ void Jit64AsmRoutineManager::GenerateCommon()
 	GenFifoWrite(32);
 	fifoDirectWrite64 = AlignCode4();
 	GenFifoWrite(64);
+	JitRegister::Register(fifoDirectWrite8, (u32)(GetCodePtr() - fifoDirectWrite8), "JIT_FifoDirectWrite");
 	frsqrte = AlignCode4();
 	GenFrsqrte();
+	JitRegister::Register(frsqrte, (u32)(GetCodePtr() - frsqrte), "JIT_Frsqrte");
 	fres = AlignCode4();
 	GenFres();
+	JitRegister::Register(fres, (u32)(GetCodePtr() - fres), "JIT_Fres");
 
 	GenQuantizedLoads();
 	GenQuantizedStores();
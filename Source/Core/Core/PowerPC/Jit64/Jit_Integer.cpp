@@ -131,6 +131,10 @@ void Jit64::FinalizeCarryOverflow(bool oe, bool inv)
 void Jit64::ComputeRC(const Gen::OpArg & arg, bool needs_test, bool needs_sext)
 {
 	_assert_msg_(DYNA_REC, arg.IsSimpleReg() || arg.IsImm(), "Invalid ComputeRC operand");
+	// Overwritten before anything reads it.
+	if (!js.op->wantsCR0)
+		return;
+
 	if (arg.IsImm())
 	{
 		MOV(64, PPCSTATE(cr_val[0]), Imm32((s32)arg.offset));
@@ -170,6 +174,24 @@ void Jit64::ComputeRC(const Gen::OpArg & arg, bool needs_test, bool needs_sext)
 	}
 }
 
+// Integer instructions whose inputs the analyzer found to be constant just set the
+// result as an immediate.
+bool Jit64::EmitConstantResult(const PPCAnalyst::CodeOp& op)
+{
+	const SCoreStartupParameter& params = SConfig::GetInstance().m_LocalCoreStartupParameter;
+	if (!op.outputIsConstant || params.bJITOff || params.bJITIntegerOff)
+		return false;
+	// The analyzer doesn't compute the carry.
+	if (op.outputCA && op.wantsCA)
+		return false;
+
+	int d = *op.regsOut.begin();
+	gpr.SetImmediate32(d, op.outputConstant);
+	if (op.outputCR0)
+		ComputeRC(gpr.R(d));
+	return true;
+}
+
 OpArg Jit64::ExtractFromReg(int reg, int offset)
 {
 	OpArg src = gpr.R(reg);
@@ -353,7 +375,11 @@ void Jit64::DoMergedBranch()
 			destination = SignExt16(js.next_inst.BD << 2);
 		else
 			destination = js.next_compilerPC + SignExt16(js.next_inst.BD << 2);
-		WriteExit(destination, js.next_inst.LK, js.next_compilerPC + 4);
+		// Polling loops usually end in a compare merged with the branch back.
+		if (IsIdleLoop(js.next_op))
+			WriteIdleExit(destination);
+		else
+			WriteExit(destination, js.next_inst.LK, js.next_compilerPC + 4);
 	}
 	else if ((js.next_inst.OPCD == 19) && (js.next_inst.SUBOP10 == 528)) // bcctrx
 	{
@@ -453,6 +479,9 @@ void Jit64::cmpXX(UGeckoInstruction inst)
 	int a = inst.RA;
 	int b = inst.RB;
 	int crf = inst.CRFD;
+	if ((crf == 0 && !js.op->wantsCR0) || (crf == 1 && !js.op->wantsCR1))
+		return;
+
 	bool merge_branch = CheckMergedBranch(crf);
 
 	OpArg comparand;
@@ -255,6 +255,7 @@ void JitIL::Init()
 	asm_routines.Init(nullptr);
 
 	farcode.Init(js.memcheck ? FARCODE_SIZE_MMU : FARCODE_SIZE);
+	ResetCodeRings();
 
 	code_block.m_stats = &js.st;
 	code_block.m_gpa = &js.gpa;
@@ -270,7 +271,9 @@ void JitIL::ClearCache()
 {
 	blocks.Clear();
 	trampolines.ClearCodeSpace();
+	farcode.ClearCodeSpace();
 	ClearCodeSpace();
+	ResetCodeRings();
 }
 
 void JitIL::Shutdown()
@@ -384,9 +387,13 @@ void JitIL::WriteExit(u32 destination)
 	JitBlock *b = js.curBlock;
 	JitBlock::LinkData linkData;
 	linkData.exitAddress = destination;
-	linkData.exitPtrs = GetWritableCodePtr();
 	linkData.linkStatus = false;
 
+	// Always store the pc, so that the block cache can point the exit back at the
+	// dispatcher if the destination gets evicted.
+	MOV(32, PPCSTATE(pc), Imm32(destination));
+	linkData.exitPtrs = GetWritableCodePtr();
+
 	// Link opportunity!
 	int block;
 	if (jo.enableBlocklink && (block = blocks.GetBlockNumberFromStartAddress(destination)) >= 0)
@@ -397,7 +404,6 @@ void JitIL::WriteExit(u32 destination)
 	}
 	else
 	{
-		MOV(32, PPCSTATE(pc), Imm32(destination));
 		JMP(asm_routines.dispatcher, true);
 	}
 	b->linkData.push_back(linkData);
@@ -484,14 +490,16 @@ void JitIL::Trace()
 
 void JitIL::Jit(u32 em_address)
 {
-	if (GetSpaceLeft() < 0x10000 || farcode.GetSpaceLeft() < 0x10000 || blocks.IsFull() ||
-		SConfig::GetInstance().m_LocalCoreStartupParameter.bJITNoBlockCache)
+	if (SConfig::GetInstance().m_LocalCoreStartupParameter.bJITNoBlockCache || !MakeRoomForBlock())
 	{
 		ClearCache();
 	}
 	int block_num = blocks.AllocateBlock(em_address);
 	JitBlock *b = blocks.GetBlock(block_num);
-	blocks.FinalizeBlock(block_num, jo.enableBlocklink, DoJit(em_address, &code_buffer, b));
+	b->farCodeStart = farcode.GetCodePtr();
+	const u8* entry = DoJit(em_address, &code_buffer, b);
+	b->farCodeSize = (u32)(farcode.GetCodePtr() - b->farCodeStart);
+	blocks.FinalizeBlock(block_num, jo.enableBlocklink, entry);
 }
 
 const u8* JitIL::DoJit(u32 em_address, PPCAnalyst::CodeBuffer *code_buf, JitBlock *b)
@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include "Common/CPUDetect.h"
+#include "Common/JitRegister.h"
 #include "Common/MathUtil.h"
 #include "Common/MemoryUtil.h"
 
@@ -356,6 +357,8 @@ void CommonAsmRoutines::GenQuantizedStores()
 	pairedStoreQuantized[5] = storePairedU16;
 	pairedStoreQuantized[6] = storePairedS8;
 	pairedStoreQuantized[7] = storePairedS16;
+
+	JitRegister::Register(storePairedIllegal, (u32)(GetCodePtr() - storePairedIllegal), "JIT_QuantizedStore");
 }
 
 // See comment in header for in/outs.
@@ -434,6 +437,8 @@ void CommonAsmRoutines::GenQuantizedSingleStores()
 	singleStoreQuantized[5] = storeSingleU16;
 	singleStoreQuantized[6] = storeSingleS8;
 	singleStoreQuantized[7] = storeSingleS16;
+
+	JitRegister::Register(storeSingleIllegal, (u32)(GetCodePtr() - storeSingleIllegal), "JIT_QuantizedSingleStore");
 }
 
 void CommonAsmRoutines::GenQuantizedLoads()
@@ -647,4 +652,6 @@ void CommonAsmRoutines::GenQuantizedLoads()
 	pairedLoadQuantized[13] = loadPairedU16One;
 	pairedLoadQuantized[14] = loadPairedS8One;
 	pairedLoadQuantized[15] = loadPairedS16One;
+
+	JitRegister::Register(loadPairedIllegal, (u32)(GetCodePtr() - loadPairedIllegal), "JIT_QuantizedLoad");
 }
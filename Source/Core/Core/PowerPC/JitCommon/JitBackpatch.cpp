@@ -73,6 +73,12 @@ bool Jitx86Base::BackPatch(u32 emAddress, SContext* ctx)
 
 	BitSet32 registersInUse = it->second;
 
+	// With the MMU on, this is usually just a page the guest has mapped but we haven't yet.
+	// Retry the access once it is; everything else gets sent to the slow path from now on.
+	auto slow_path = slowPathAtLoc.find(codePtr);
+	if (slow_path != slowPathAtLoc.end() && Memory::MapTranslatedPage(emAddress, info.isMemoryWrite))
+		return true;
+
 	if (!info.isMemoryWrite)
 	{
 		XEmitter emitter(codePtr);
@@ -85,8 +91,15 @@ bool Jitx86Base::BackPatch(u32 emAddress, SContext* ctx)
 		else
 			bswapNopCount = 2;
 
-		const u8 *trampoline = trampolines.GetReadTrampoline(info, registersInUse);
-		emitter.CALL((void *)trampoline);
+		if (slow_path != slowPathAtLoc.end())
+		{
+			emitter.JMP(slow_path->second, true);
+		}
+		else
+		{
+			const u8 *trampoline = trampolines.GetReadTrampoline(info, registersInUse);
+			emitter.CALL((void *)trampoline);
+		}
 		int padding = info.instructionSize + bswapNopCount - BACKPATCH_SIZE;
 		if (padding > 0)
 		{
@@ -101,7 +114,7 @@ bool Jitx86Base::BackPatch(u32 emAddress, SContext* ctx)
 		if (it2 == pcAtLoc.end())
 		{
 			PanicAlert("BackPatch: no pc entry for address %p", codePtr);
-			return nullptr;
+			return false;
 		}
 
 		u32 pc = it2->second;
@@ -138,8 +151,15 @@ bool Jitx86Base::BackPatch(u32 emAddress, SContext* ctx)
 			start = codePtr - bswapSize;
 		}
 		XEmitter emitter(start);
-		const u8 *trampoline = trampolines.GetWriteTrampoline(info, registersInUse, pc);
-		emitter.CALL((void *)trampoline);
+		if (slow_path != slowPathAtLoc.end())
+		{
+			emitter.JMP(slow_path->second, true);
+		}
+		else
+		{
+			const u8 *trampoline = trampolines.GetWriteTrampoline(info, registersInUse, pc);
+			emitter.CALL((void *)trampoline);
+		}
 		ptrdiff_t padding = (codePtr - emitter.GetCodePtr()) + info.instructionSize;
 		if (padding > 0)
 		{
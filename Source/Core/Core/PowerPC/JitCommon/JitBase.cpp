@@ -2,6 +2,7 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <sstream>
 #include <string>
 
@@ -18,6 +19,56 @@ void Jit(u32 em_address)
 	jit->Jit(em_address);
 }
 
+void Jitx86Base::ResetCodeRings()
+{
+	m_near_evicted_end = GetRegion() + GetRegionSize();
+	m_far_evicted_end = farcode.GetRegion() + farcode.GetRegionSize();
+}
+
+void Jitx86Base::EvictNextChunk(Gen::X64CodeBlock* space, u8** evicted_end)
+{
+	u8* region_end = space->GetRegion() + space->GetRegionSize();
+	if (*evicted_end == region_end)
+	{
+		// Everything up to the end is free already; start over from the oldest code.
+		space->ResetCodePtr();
+		*evicted_end = space->GetRegion();
+	}
+
+	u8* chunk_end = std::min(*evicted_end + space->GetRegionSize() / CODE_EVICT_CHUNKS, region_end);
+	blocks.EvictCodeRange(space == &farcode, *evicted_end, chunk_end);
+	*evicted_end = chunk_end;
+}
+
+bool Jitx86Base::MakeRoomForBlock()
+{
+	// Trampolines are shared between blocks, so they can only go all at once.
+	if (trampolines.GetSpaceLeft() < MAX_BLOCK_CODE_SIZE)
+		return false;
+
+	while (m_near_evicted_end - GetWritableCodePtr() < MAX_BLOCK_CODE_SIZE)
+		EvictNextChunk(this, &m_near_evicted_end);
+	while (m_far_evicted_end - farcode.GetWritableCodePtr() < MAX_BLOCK_CODE_SIZE)
+		EvictNextChunk(&farcode, &m_far_evicted_end);
+
+	// Lots of tiny blocks can run out of block numbers before running out of space.
+	for (int i = 0; blocks.IsFull(); i++)
+	{
+		if (i == CODE_EVICT_CHUNKS)
+			return false;
+		EvictNextChunk(this, &m_near_evicted_end);
+	}
+	return true;
+}
+
+bool Jitx86Base::HasRoomForBlock()
+{
+	return trampolines.GetSpaceLeft() >= MAX_BLOCK_CODE_SIZE &&
+	       m_near_evicted_end - GetWritableCodePtr() >= MAX_BLOCK_CODE_SIZE &&
+	       m_far_evicted_end - farcode.GetWritableCodePtr() >= MAX_BLOCK_CODE_SIZE &&
+	       !blocks.IsFull();
+}
+
 u32 Helper_Mask(u8 mb, u8 me)
 {
 	return (((mb > me) ?
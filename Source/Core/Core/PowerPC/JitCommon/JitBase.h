@@ -9,7 +9,9 @@
 //#define JIT_LOG_FPR     // Enables logging of the PPC floating point regs
 
 #include <unordered_set>
+#include <vector>
 
+#include "Common/JitRegister.h"
 #include "Common/x64ABI.h"
 #include "Common/x64Analyzer.h"
 #include "Common/x64Emitter.h"
@@ -96,6 +98,9 @@ protected:
 		JitBlock *curBlock;
 
 		std::unordered_set<u32> fifoWriteAddresses;
+
+		// Where each guest instruction's code starts, for JitRegister.
+		std::vector<JitRegister::GuestLine> guestLines;
 	};
 
 	PPCAnalyst::CodeBlock code_block;
@@ -121,6 +126,25 @@ protected:
 	bool BackPatch(u32 emAddress, SContext* ctx);
 	JitBlockCache blocks;
 	TrampolineCache trampolines;
+
+	// The near and far code spaces are used as rings. Once one fills up, writing wraps
+	// around to its start and the oldest blocks are evicted a chunk at a time just ahead
+	// of the write pointer, so only a slice of the hot code has to be recompiled.
+	enum
+	{
+		CODE_EVICT_CHUNKS = 8,
+		// No single block is expected to emit more than this.
+		MAX_BLOCK_CODE_SIZE = 0x10000,
+	};
+	u8* m_near_evicted_end;
+	u8* m_far_evicted_end;
+
+	void ResetCodeRings();
+	void EvictNextChunk(Gen::X64CodeBlock* space, u8** evicted_end);
+	// Returns false if the whole cache has to be cleared instead.
+	bool MakeRoomForBlock();
+	// Whether another block fits without evicting anything.
+	bool HasRoomForBlock();
 public:
 	JitBlockCache *GetBlockCache() override { return &blocks; }
 	bool HandleFault(uintptr_t access_address, SContext* ctx) override;
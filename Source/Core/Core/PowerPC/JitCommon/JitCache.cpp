@@ -9,12 +9,17 @@
 // performance hit, it's not enabled by default, but it's useful for
 // locating performance issues.
 
+#include <algorithm>
+
 #include "disasm.h"
 
 #include "Common/CommonTypes.h"
+#include "Common/JitRegister.h"
 #include "Common/MemoryUtil.h"
+#include "Common/StringUtil.h"
 #include "Core/PowerPC/JitInterface.h"
 #include "Core/PowerPC/JitCommon/JitBase.h"
+#include "Core/PowerPC/JitCommon/JitProfile.h"
 
 #ifdef _WIN32
 #include <windows.h>
@@ -36,7 +41,7 @@ using namespace Gen;
 
 	bool JitBaseBlockCache::IsFull() const
 	{
-		return GetNumBlocks() >= MAX_NUM_BLOCKS - 1;
+		return free_blocks.empty() && GetNumBlocks() >= MAX_NUM_BLOCKS - 1;
 	}
 
 	void JitBaseBlockCache::Init()
@@ -60,6 +65,15 @@ using namespace Gen;
 
 	void JitBaseBlockCache::Shutdown()
 	{
+		if (JitProfile::IsEnabled())
+		{
+			for (int i = 0; i < num_blocks; i++)
+			{
+				if (!blocks[i].invalid)
+					JitProfile::AddRunCount(blocks[i].originalAddress, blocks[i].runCount);
+			}
+		}
+
 		num_blocks = 0;
 		m_initialized = false;
 #if defined USE_OPROFILE && USE_OPROFILE
@@ -92,6 +106,9 @@ using namespace Gen;
 		valid_block.ClearAll();
 
 		num_blocks = 0;
+		free_blocks.clear();
+		near_code_blocks.clear();
+		far_code_blocks.clear();
 		blockCodePointers.fill(nullptr);
 	}
 
@@ -125,12 +142,24 @@ using namespace Gen;
 
 	int JitBaseBlockCache::AllocateBlock(u32 em_address)
 	{
-		JitBlock &b = blocks[num_blocks];
+		int block_num;
+		if (!free_blocks.empty())
+		{
+			block_num = free_blocks.back();
+			free_blocks.pop_back();
+		}
+		else
+		{
+			block_num = num_blocks++; //commit the current block
+		}
+
+		JitBlock &b = blocks[block_num];
 		b.invalid = false;
 		b.originalAddress = em_address;
+		b.farCodeStart = nullptr;
+		b.farCodeSize = 0;
 		b.linkData.clear();
-		num_blocks++; //commit the current block
-		return num_blocks - 1;
+		return block_num;
 	}
 
 	void JitBaseBlockCache::FinalizeBlock(int block_num, bool block_link, const u8 *code_ptr)
@@ -146,18 +175,31 @@ using namespace Gen;
 		for (u32 block = pAddr / 32; block <= (pAddr + (b.originalSize - 1) * 4) / 32; ++block)
 			valid_block.Set(block);
 
-		block_map[std::make_pair(pAddr + 4 * b.originalSize - 1, pAddr)] = block_num;
+		AddToBlockMap(block_num);
+		near_code_blocks.emplace_back(block_num, b.checkedEntry);
+		if (b.farCodeSize)
+			far_code_blocks.emplace_back(block_num, b.farCodeStart);
+
 		if (block_link)
 		{
 			for (const auto& e : b.linkData)
 			{
-				links_to.insert(std::pair<u32, int>(e.exitAddress, block_num));
+				std::vector<int>& sources = links_to[e.exitAddress];
+				if (std::find(sources.begin(), sources.end(), block_num) == sources.end())
+					sources.push_back(block_num);
 			}
 
 			LinkBlock(block_num);
 			LinkBlockExits(block_num);
 		}
 
+		if (JitRegister::IsEnabled())
+		{
+			JitRegister::Register(b.checkedEntry, (u32)(b.normalEntry + b.codeSize - b.checkedEntry),
+			                      StringFromFormat("JIT_PPC_%08x", b.originalAddress), jit->js.guestLines);
+			JitRegister::Register(b.farCodeStart, b.farCodeSize, StringFromFormat("JIT_PPC_%08x_far", b.originalAddress));
+		}
+
 #if defined USE_OPROFILE && USE_OPROFILE
 		char buf[100];
 		sprintf(buf, "EmuCode%x", b.originalAddress);
@@ -248,38 +290,114 @@ using namespace Gen;
 	{
 		LinkBlockExits(i);
 		JitBlock &b = blocks[i];
-		// equal_range(b) returns pair<iterator,iterator> representing the range
-		// of element with key b
-		auto ppp = links_to.equal_range(b.originalAddress);
-
-		if (ppp.first == ppp.second)
+		auto it = links_to.find(b.originalAddress);
+		if (it == links_to.end())
 			return;
 
-		for (auto iter = ppp.first; iter != ppp.second; ++iter)
+		for (int source : it->second)
 		{
-			// PanicAlert("Linking block %i to block %i", iter->second, i);
-			LinkBlockExits(iter->second);
+			// PanicAlert("Linking block %i to block %i", source, i);
+			LinkBlockExits(source);
 		}
 	}
 
+	// The sources stay in links_to so that they get linked again once the
+	// address is recompiled.
 	void JitBaseBlockCache::UnlinkBlock(int i)
 	{
 		JitBlock &b = blocks[i];
-		auto ppp = links_to.equal_range(b.originalAddress);
-
-		if (ppp.first == ppp.second)
+		auto it = links_to.find(b.originalAddress);
+		if (it == links_to.end())
 			return;
 
-		for (auto iter = ppp.first; iter != ppp.second; ++iter)
+		for (int source : it->second)
 		{
-			JitBlock &sourceBlock = blocks[iter->second];
+			JitBlock &sourceBlock = blocks[source];
 			for (auto& e : sourceBlock.linkData)
 			{
-				if (e.exitAddress == b.originalAddress)
+				if (e.exitAddress == b.originalAddress && e.linkStatus)
+				{
+					WriteUnlinkBlock(e.exitPtrs);
 					e.linkStatus = false;
+				}
 			}
 		}
-		links_to.erase(b.originalAddress);
+	}
+
+	void JitBaseBlockCache::AddToBlockMap(int i)
+	{
+		const JitBlock &b = blocks[i];
+		u32 pAddr = b.originalAddress & 0x1FFFFFFF;
+		u32 pEnd = pAddr + 4 * std::max(b.originalSize, 1u) - 1;
+		for (u32 bucket = pAddr >> BLOCK_MAP_SHIFT; bucket <= pEnd >> BLOCK_MAP_SHIFT; ++bucket)
+			block_map[bucket].push_back(i);
+	}
+
+	void JitBaseBlockCache::RemoveFromBlockMap(int i)
+	{
+		const JitBlock &b = blocks[i];
+		u32 pAddr = b.originalAddress & 0x1FFFFFFF;
+		u32 pEnd = pAddr + 4 * std::max(b.originalSize, 1u) - 1;
+		for (u32 bucket = pAddr >> BLOCK_MAP_SHIFT; bucket <= pEnd >> BLOCK_MAP_SHIFT; ++bucket)
+		{
+			auto it = block_map.find(bucket);
+			if (it == block_map.end())
+				continue;
+			std::vector<int>& bucket_blocks = it->second;
+			bucket_blocks.erase(std::remove(bucket_blocks.begin(), bucket_blocks.end(), i), bucket_blocks.end());
+			if (bucket_blocks.empty())
+				block_map.erase(it);
+		}
+	}
+
+	void JitBaseBlockCache::FreeBlock(int i)
+	{
+		JitBlock &b = blocks[i];
+		if (!b.invalid)
+		{
+			RemoveFromBlockMap(i);
+			DestroyBlock(i, false);
+		}
+
+		// Nothing may write to this block's exits once its code space is reused.
+		for (const auto& e : b.linkData)
+		{
+			auto it = links_to.find(e.exitAddress);
+			if (it == links_to.end())
+				continue;
+			std::vector<int>& sources = it->second;
+			sources.erase(std::remove(sources.begin(), sources.end(), i), sources.end());
+			if (sources.empty())
+				links_to.erase(it);
+		}
+
+		b.linkData.clear();
+		b.checkedEntry = nullptr;
+		b.normalEntry = nullptr;
+		b.codeSize = 0;
+		b.farCodeStart = nullptr;
+		b.farCodeSize = 0;
+		b.runCount = 0;
+		blockCodePointers[i] = nullptr;
+		free_blocks.push_back(i);
+	}
+
+	void JitBaseBlockCache::EvictCodeRange(bool far_code, const u8* start, const u8* end)
+	{
+		// Once the space has wrapped around, the code written since sits behind the old code in
+		// the queue, below start, and has to stay.
+		std::deque<std::pair<int, const u8*>>& queue = far_code ? far_code_blocks : near_code_blocks;
+		while (!queue.empty() && queue.front().second >= start && queue.front().second < end)
+		{
+			int i = queue.front().first;
+			const u8* code = queue.front().second;
+			queue.pop_front();
+
+			// Blocks freed along with the other code space may have had their number handed out again.
+			const JitBlock &b = blocks[i];
+			if ((far_code ? b.farCodeStart : b.checkedEntry) == code)
+				FreeBlock(i);
+		}
 	}
 
 	void JitBaseBlockCache::DestroyBlock(int block_num, bool invalidate)
@@ -299,6 +417,9 @@ using namespace Gen;
 		b.invalid = true;
 		*GetICachePtr(b.originalAddress) = JIT_ICACHE_INVALID_WORD;
 
+		if (JitProfile::IsEnabled())
+			JitProfile::AddRunCount(b.originalAddress, b.runCount);
+
 		UnlinkBlock(block_num);
 
 		// Send anyone who tries to run this block back to the dispatcher.
@@ -323,20 +444,46 @@ using namespace Gen;
 		}
 
 		// destroy JIT blocks
-		// !! this works correctly under assumption that any two overlapping blocks end at the same address
-		if (destroy_block)
+		if (destroy_block && length)
 		{
-			std::map<std::pair<u32,u32>, u32>::iterator it1 = block_map.lower_bound(std::make_pair(pAddr, 0)), it2 = it1;
-			while (it2 != block_map.end() && it2->first.second < pAddr + length)
+			u64 pEnd = (u64)pAddr + length;
+			auto intersects = [&](int i) {
+				const JitBlock &b = blocks[i];
+				u32 start = b.originalAddress & 0x1FFFFFFF;
+				return start < pEnd && start + 4 * b.originalSize > pAddr;
+			};
+
+			std::vector<int> to_destroy;
+			u64 first_bucket = pAddr >> BLOCK_MAP_SHIFT;
+			u64 last_bucket = (pEnd - 1) >> BLOCK_MAP_SHIFT;
+			if (last_bucket - first_bucket + 1 > block_map.size())
+			{
+				// Huge ranges touch fewer buckets by walking the whole map.
+				for (const auto& bucket : block_map)
+					for (int i : bucket.second)
+						if (intersects(i))
+							to_destroy.push_back(i);
+			}
+			else
 			{
-				JitBlock &b = blocks[it2->second];
-				*GetICachePtr(b.originalAddress) = JIT_ICACHE_INVALID_WORD;
-				DestroyBlock(it2->second, true);
-				++it2;
+				for (u64 bucket = first_bucket; bucket <= last_bucket; ++bucket)
+				{
+					auto it = block_map.find((u32)bucket);
+					if (it == block_map.end())
+						continue;
+					for (int i : it->second)
+						if (intersects(i))
+							to_destroy.push_back(i);
+				}
 			}
-			if (it1 != it2)
+
+			// Blocks spanning several buckets show up once per bucket.
+			std::sort(to_destroy.begin(), to_destroy.end());
+			to_destroy.erase(std::unique(to_destroy.begin(), to_destroy.end()), to_destroy.end());
+			for (int i : to_destroy)
 			{
-				block_map.erase(it1, it2);
+				RemoveFromBlockMap(i);
+				DestroyBlock(i, true);
 			}
 
 			// If the code was actually modified, we need to clear the relevant entries from the
@@ -360,6 +507,12 @@ using namespace Gen;
 			emit.JMP(address, true);
 	}
 
+	void JitBlockCache::WriteUnlinkBlock(u8* location)
+	{
+		// The exit has already stored the destination pc, so the dispatcher can take over.
+		WriteLinkBlock(location, jit->GetAsmRoutines()->dispatcher);
+	}
+
 	void JitBlockCache::WriteDestroyBlock(const u8* location, u32 address)
 	{
 		XEmitter emit((u8 *)location);
@@ -6,8 +6,10 @@
 
 #include <array>
 #include <bitset>
-#include <map>
+#include <deque>
 #include <memory>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "Core/PowerPC/Gekko.h"
@@ -41,6 +43,10 @@ struct JitBlock
 	u32 originalSize;
 	int runCount;  // for profiling.
 
+	// The part of the block that was emitted into the far code cache, if any.
+	const u8 *farCodeStart;
+	u32 farCodeSize;
+
 	bool invalid;
 
 	struct LinkData
@@ -108,13 +114,20 @@ class JitBaseBlockCache
 	enum
 	{
 		MAX_NUM_BLOCKS = 65536 * 2,
+		// block_map buckets cover this many bytes of physical address space
+		BLOCK_MAP_SHIFT = 12,
 	};
 
 	std::array<const u8*, MAX_NUM_BLOCKS> blockCodePointers;
 	std::array<JitBlock, MAX_NUM_BLOCKS> blocks;
 	int num_blocks;
-	std::multimap<u32, int> links_to;
-	std::map<std::pair<u32,u32>, u32> block_map; // (end_addr, start_addr) -> number
+	std::vector<int> free_blocks; // evicted block numbers that can be handed out again
+	std::unordered_map<u32, std::vector<int>> links_to; // exit address -> blocks with an exit there
+	std::unordered_map<u32, std::vector<int>> block_map; // physical address >> BLOCK_MAP_SHIFT -> blocks covering it
+	// Blocks in the order their near and far code was written, along with where it starts.
+	// The code spaces are filled and evicted in address order, so the oldest code is in front.
+	std::deque<std::pair<int, const u8*>> near_code_blocks;
+	std::deque<std::pair<int, const u8*>> far_code_blocks;
 	ValidBlockBitSet valid_block;
 
 	bool m_initialized;
@@ -123,10 +136,16 @@ class JitBaseBlockCache
 	void LinkBlockExits(int i);
 	void LinkBlock(int i);
 	void UnlinkBlock(int i);
+	void AddToBlockMap(int i);
+	void RemoveFromBlockMap(int i);
+	void FreeBlock(int i);
 
 	// Virtual for overloaded
 	virtual void WriteLinkBlock(u8* location, const u8* address) = 0;
 	virtual void WriteDestroyBlock(const u8* location, u32 address) = 0;
+	// Points a linked exit back at the dispatcher. Backends that leave this empty keep
+	// jumping to the destroyed block's stub instead, and can't use EvictCodeRange.
+	virtual void WriteUnlinkBlock(u8* location) {}
 
 public:
 	JitBaseBlockCache() : num_blocks(0), m_initialized(false)
@@ -162,6 +181,11 @@ public:
 	// DOES NOT WORK CORRECTLY WITH INLINING
 	void InvalidateICache(u32 address, const u32 length, bool forced);
 	void DestroyBlock(int block_num, bool invalidate);
+
+	// Throws away the oldest blocks of the near or far code space as long as their code starts
+	// in [start, end), so that the range can be written again, and frees their block numbers
+	// for reuse.
+	void EvictCodeRange(bool far_code, const u8* start, const u8* end);
 };
 
 // x86 BlockCache
@@ -170,4 +194,5 @@ class JitBlockCache : public JitBaseBlockCache
 private:
 	void WriteLinkBlock(u8* location, const u8* address) override;
 	void WriteDestroyBlock(const u8* location, u32 address) override;
+	void WriteUnlinkBlock(u8* location) override;
 };
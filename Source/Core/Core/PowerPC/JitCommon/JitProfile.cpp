@@ -0,0 +1,270 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Common/Flag.h"
+#include "Common/Hash.h"
+#include "Common/MPSCQueue.h"
+#include "Common/Thread.h"
+#include "Core/HW/Memmap.h"
+#include "Core/PowerPC/JitCommon/JitProfile.h"
+
+namespace JitProfile
+{
+
+enum
+{
+	PROFILE_MAGIC = 0x5054494A, // "JITP"
+	PROFILE_VERSION = 1,
+	// Only the hottest blocks are kept, so that profiles of long sessions stay small.
+	MAX_PROFILE_BLOCKS = 0x8000,
+};
+
+// On-disk format, followed by num_blocks BlockEntry and num_fifo_writes u32.
+struct ProfileHeader
+{
+	u32 magic;
+	u32 version;
+	u32 num_blocks;
+	u32 num_fifo_writes;
+};
+
+struct BlockEntry
+{
+	u32 address;
+	u32 num_instructions;
+	u32 hash; // of the instruction words the block was compiled from
+	u32 flags;
+	u64 run_count;
+};
+
+static bool s_enabled = false;
+static std::string s_filename;
+
+// Only touched by the CPU thread once emulation is running.
+static std::unordered_map<u32, BlockEntry> s_blocks;
+static std::set<u32> s_fifo_writes;
+
+static std::thread s_prefetch_thread;
+static Common::Flag s_prefetch_stop;
+static Common::MPSCQueue<PrefetchedBlock> s_prefetched;
+
+static bool HashCode(u32 address, u32 num_instructions, u32* hash)
+{
+	if (num_instructions == 0)
+		return false;
+
+	// The block must lie in one contiguous piece of RAM.
+	u32 last = address + 4 * (num_instructions - 1);
+	if (last < address || (address >> 28) != (last >> 28) ||
+	    !Memory::IsRAMAddress(address) || !Memory::IsRAMAddress(last))
+		return false;
+
+	*hash = HashAdler32(Memory::GetPointer(address), 4 * num_instructions);
+	return true;
+}
+
+static bool IsUnchanged(const BlockEntry& entry)
+{
+	u32 hash;
+	return HashCode(entry.address, entry.num_instructions, &hash) && hash == entry.hash;
+}
+
+static void Load()
+{
+	File::IOFile f(s_filename, "rb");
+	if (!f)
+		return;
+
+	ProfileHeader header;
+	if (!f.ReadArray(&header, 1) || header.magic != PROFILE_MAGIC || header.version != PROFILE_VERSION)
+	{
+		WARN_LOG(DYNA_REC, "Ignoring JIT profile %s from another version", s_filename.c_str());
+		return;
+	}
+
+	std::vector<BlockEntry> blocks(header.num_blocks);
+	std::vector<u32> fifo_writes(header.num_fifo_writes);
+	if (!f.ReadArray(blocks.data(), blocks.size()) || !f.ReadArray(fifo_writes.data(), fifo_writes.size()))
+	{
+		WARN_LOG(DYNA_REC, "JIT profile %s is truncated", s_filename.c_str());
+		return;
+	}
+
+	for (BlockEntry& entry : blocks)
+	{
+		// Older sessions count for less, so blocks the game stopped using fall out eventually.
+		entry.run_count /= 2;
+		s_blocks[entry.address] = entry;
+	}
+	s_fifo_writes.insert(fifo_writes.begin(), fifo_writes.end());
+
+	INFO_LOG(DYNA_REC, "Loaded JIT profile with %u blocks from %s", header.num_blocks, s_filename.c_str());
+}
+
+static void Save()
+{
+	std::vector<BlockEntry> blocks;
+	blocks.reserve(s_blocks.size());
+	for (const auto& entry : s_blocks)
+		if (entry.second.run_count)
+			blocks.push_back(entry.second);
+
+	if (blocks.size() > MAX_PROFILE_BLOCKS)
+	{
+		std::nth_element(blocks.begin(), blocks.begin() + MAX_PROFILE_BLOCKS, blocks.end(),
+			[](const BlockEntry& a, const BlockEntry& b) { return a.run_count > b.run_count; });
+		blocks.resize(MAX_PROFILE_BLOCKS);
+	}
+
+	std::vector<u32> fifo_writes(s_fifo_writes.begin(), s_fifo_writes.end());
+
+	File::CreateFullPath(s_filename);
+	File::IOFile f(s_filename, "wb");
+	if (!f)
+	{
+		ERROR_LOG(DYNA_REC, "Couldn't write JIT profile %s", s_filename.c_str());
+		return;
+	}
+
+	ProfileHeader header = { PROFILE_MAGIC, PROFILE_VERSION, (u32)blocks.size(), (u32)fifo_writes.size() };
+	f.WriteArray(&header, 1);
+	f.WriteArray(blocks.data(), blocks.size());
+	f.WriteArray(fifo_writes.data(), fifo_writes.size());
+}
+
+// Runs on its own thread while the game boots. Compiling has to stay on the CPU thread,
+// but finding out which blocks are worth compiling doesn't.
+static void PrefetchThread(std::vector<BlockEntry> candidates)
+{
+	Common::SetCurrentThreadName("JIT profile prefetch");
+
+	std::sort(candidates.begin(), candidates.end(),
+		[](const BlockEntry& a, const BlockEntry& b) { return a.run_count > b.run_count; });
+
+	size_t queued = 0;
+	for (const BlockEntry& entry : candidates)
+	{
+		if (s_prefetch_stop.IsSet())
+			break;
+
+		// Reading RAM while the game runs is racy, but a torn read only costs us a
+		// block; the JIT reads the code again when it compiles it.
+		if (!IsUnchanged(entry))
+			continue;
+
+		s_prefetched.Push(PrefetchedBlock{ entry.address, entry.flags });
+		queued++;
+	}
+
+	INFO_LOG(DYNA_REC, "%u of %u profiled blocks are ready to compile", (u32)queued, (u32)candidates.size());
+}
+
+void Init(const std::string& game_id)
+{
+	if (game_id.empty())
+		return;
+
+	s_filename = File::GetUserPath(D_CACHE_IDX) + game_id + ".jitprofile";
+	s_blocks.clear();
+	s_fifo_writes.clear();
+	Load();
+	s_enabled = true;
+}
+
+void Shutdown()
+{
+	if (!s_enabled)
+		return;
+
+	s_prefetch_stop.Set();
+	if (s_prefetch_thread.joinable())
+		s_prefetch_thread.join();
+	s_prefetch_stop.Clear();
+	s_prefetched.Clear();
+
+	Save();
+	s_blocks.clear();
+	s_fifo_writes.clear();
+	s_enabled = false;
+}
+
+bool IsEnabled()
+{
+	return s_enabled;
+}
+
+void StartPrefetch()
+{
+	if (!s_enabled || s_prefetch_thread.joinable() || s_blocks.empty())
+		return;
+
+	std::vector<BlockEntry> candidates;
+	candidates.reserve(s_blocks.size());
+	for (const auto& entry : s_blocks)
+		candidates.push_back(entry.second);
+
+	s_prefetch_thread = std::thread(PrefetchThread, std::move(candidates));
+}
+
+bool PopPrefetchedBlock(PrefetchedBlock* block)
+{
+	return s_enabled && s_prefetched.Pop(*block);
+}
+
+void RecordBlock(u32 address, u32 num_instructions, u32 flags)
+{
+	u32 hash;
+	if (!HashCode(address, num_instructions, &hash))
+		return;
+
+	auto it = s_blocks.find(address);
+	if (it != s_blocks.end() && it->second.hash == hash && it->second.num_instructions == num_instructions)
+	{
+		it->second.flags = flags;
+		return;
+	}
+
+	// New code at this address; whatever ran here before doesn't tell us anything.
+	s_blocks[address] = BlockEntry{ address, num_instructions, hash, flags, 0 };
+}
+
+void AddRunCount(u32 address, u64 run_count)
+{
+	auto it = s_blocks.find(address);
+	if (it != s_blocks.end())
+		it->second.run_count += run_count;
+}
+
+void RecordFifoWrite(u32 address)
+{
+	if (s_enabled)
+		s_fifo_writes.insert(address);
+}
+
+void GetFifoWrites(u32 em_address, std::unordered_set<u32>* fifo_writes)
+{
+	auto it = s_blocks.find(em_address);
+	if (it == s_blocks.end())
+		return;
+
+	const BlockEntry& entry = it->second;
+	auto first = s_fifo_writes.lower_bound(entry.address);
+	auto last = s_fifo_writes.lower_bound(entry.address + 4 * entry.num_instructions);
+	if (first == last || !IsUnchanged(entry))
+		return;
+
+	fifo_writes->insert(first, last);
+}
+
+}
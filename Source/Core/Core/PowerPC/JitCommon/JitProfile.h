@@ -0,0 +1,53 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+// Remembers which blocks a game ran in earlier sessions, so that the JIT can
+// compile them as soon as the game's code is in memory instead of stuttering
+// through them one by one the first time each area is reached.
+
+#include <string>
+#include <unordered_set>
+
+#include "Common/CommonTypes.h"
+
+namespace JitProfile
+{
+
+enum BlockFlags
+{
+	// The analyzer kept going past conditional branches when the block was compiled.
+	BLOCK_CONDITIONAL_CONTINUE = (1 << 0),
+};
+
+struct PrefetchedBlock
+{
+	u32 address;
+	u32 flags;
+};
+
+// Loads the profile of the given game and starts recording this session's blocks.
+void Init(const std::string& game_id);
+// Writes the profile back to disk.
+void Shutdown();
+bool IsEnabled();
+
+// Starts a background pass that checks which profiled blocks are still in memory,
+// unchanged, and queues them up hottest first. Call once the game's code is loaded.
+void StartPrefetch();
+// CPU thread only.
+bool PopPrefetchedBlock(PrefetchedBlock* block);
+
+// Called by the JIT for each block it compiles, and by the block cache when a block
+// goes away, to add up how often it ran.
+void RecordBlock(u32 address, u32 num_instructions, u32 flags);
+void AddRunCount(u32 address, u64 run_count);
+
+// Stores that needed a FIFO check in earlier sessions. Only addresses inside a
+// profiled block that is still unchanged at em_address are added.
+void RecordFifoWrite(u32 address);
+void GetFifoWrites(u32 em_address, std::unordered_set<u32>* fifo_writes);
+
+}
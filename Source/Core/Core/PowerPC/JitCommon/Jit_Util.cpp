@@ -290,6 +290,57 @@ FixupBranch EmuCodeBlock::CheckIfSafeAddress(OpArg reg_value, X64Reg reg_addr, B
 	}
 }
 
+bool EmuCodeBlock::UseMMUFastmem(int flags)
+{
+	// Without far code there's nowhere to put the slow path that faulting accesses jump to.
+	return jit->js.memcheck &&
+	       SConfig::GetInstance().m_LocalCoreStartupParameter.bFastmem &&
+	       farcode.Enabled() &&
+	       !(flags & SAFE_LOADSTORE_NO_FASTMEM)
+#ifdef ENABLE_MEM_CHECK
+	       && !SConfig::GetInstance().m_LocalCoreStartupParameter.bEnableDebugging
+#endif
+	       ;
+}
+
+bool EmuCodeBlock::ProbeTranslationCache(X64Reg reg_addr, int accessSize, BitSet32 registers_in_use, Memory::XCheckTLBFlag flag,
+                                         X64Reg* reg_host, FixupBranch* not_cached, FixupBranch* crosses_page)
+{
+	if (!SConfig::GetInstance().m_LocalCoreStartupParameter.bMMU)
+		return false;
+#ifdef ENABLE_MEM_CHECK
+	// Memory checks are done by the Read/Write functions.
+	if (SConfig::GetInstance().m_LocalCoreStartupParameter.bEnableDebugging)
+		return false;
+#endif
+
+	X64Reg scratch[2];
+	int num_scratch = 0;
+	for (X64Reg reg : {RSCRATCH, RSCRATCH2, RSCRATCH_EXTRA})
+	{
+		if (num_scratch < 2 && !registers_in_use[reg] && reg != reg_addr)
+			scratch[num_scratch++] = reg;
+	}
+	if (num_scratch < 2)
+		return false;
+
+	X64Reg page = scratch[0];
+	X64Reg offset = scratch[1];
+	MOV(32, R(page), R(reg_addr));
+	SHR(32, R(page), Imm8(12));
+	MOV(64, R(offset), ImmPtr(Memory::GetTranslationCache(flag)));
+	MOV(32, R(page), MComplex(offset, page, SCALE_4, 0));
+	TEST(32, R(page), R(page));
+	*not_cached = J_CC(CC_Z);
+	MOV(32, R(offset), R(reg_addr));
+	AND(32, R(offset), Imm32(0xFFF));
+	CMP(32, R(offset), Imm32(0x1000 - accessSize / 8));
+	*crosses_page = J_CC(CC_A);
+	OR(32, R(page), R(offset));
+	*reg_host = page;
+	return true;
+}
+
 void EmuCodeBlock::SafeLoadToReg(X64Reg reg_value, const Gen::OpArg & opAddress, int accessSize, s32 offset, BitSet32 registersInUse, bool signExtend, int flags)
 {
 	if (!jit->js.memcheck)
@@ -374,13 +425,44 @@ void EmuCodeBlock::SafeLoadToReg(X64Reg reg_value, const Gen::OpArg & opAddress,
 			}
 
 			FixupBranch slow, exit;
-			slow = CheckIfSafeAddress(R(reg_value), reg_addr, registersInUse, mem_mask);
-			UnsafeLoadToReg(reg_value, R(reg_addr), accessSize, 0, signExtend);
-			if (farcode.Enabled())
+			if (UseMMUFastmem(flags) && !(flags & SAFE_LOADSTORE_NO_SWAP))
+			{
+				// Pages the guest has mapped get mapped into the arena when they first fault.
+				const u8* backpatchStart = GetCodePtr();
+				u8* mov = UnsafeLoadToReg(reg_value, R(reg_addr), accessSize, 0, signExtend);
+				ptrdiff_t padding = BACKPATCH_SIZE - (GetCodePtr() - backpatchStart);
+				if (padding > 0)
+					NOP(padding);
+				registersInUseAtLoc[mov] = registersInUse;
 				SwitchToFarCode();
+				slowPathAtLoc[mov] = GetCodePtr();
+			}
 			else
-				exit = J(true);
-			SetJumpTarget(slow);
+			{
+				slow = CheckIfSafeAddress(R(reg_value), reg_addr, registersInUse, mem_mask);
+				UnsafeLoadToReg(reg_value, R(reg_addr), accessSize, 0, signExtend);
+				if (farcode.Enabled())
+					SwitchToFarCode();
+				else
+					exit = J(true);
+				SetJumpTarget(slow);
+			}
+
+			BitSet32 probe_in_use = registersInUse;
+			probe_in_use[reg_addr] = true;
+			probe_in_use[reg_value] = true;
+			X64Reg reg_host;
+			FixupBranch not_cached, crosses_page, exit_cached;
+			bool probed = ProbeTranslationCache(reg_addr, accessSize, probe_in_use, Memory::FLAG_READ,
+			                                    &reg_host, &not_cached, &crosses_page);
+			if (probed)
+			{
+				UnsafeLoadToReg(reg_value, R(reg_host), accessSize, 0, signExtend);
+				exit_cached = J(true);
+				SetJumpTarget(not_cached);
+				SetJumpTarget(crosses_page);
+			}
+
 			size_t rsp_alignment = (flags & SAFE_LOADSTORE_NO_PROLOG) ? 8 : 0;
 			ABI_PushRegistersAndAdjustStack(registersInUse, rsp_alignment);
 			switch (accessSize)
@@ -418,6 +500,8 @@ void EmuCodeBlock::SafeLoadToReg(X64Reg reg_value, const Gen::OpArg & opAddress,
 				SwitchToNearCode();
 			}
 			SetJumpTarget(exit);
+			if (probed)
+				SetJumpTarget(exit_cached);
 		}
 	}
 }
@@ -591,13 +675,44 @@ void EmuCodeBlock::SafeWriteRegToReg(OpArg reg_value, X64Reg reg_addr, int acces
 	bool swap = !(flags & SAFE_LOADSTORE_NO_SWAP);
 
 	FixupBranch slow, exit;
-	slow = CheckIfSafeAddress(reg_value, reg_addr, registersInUse, mem_mask);
-	UnsafeWriteRegToReg(reg_value, reg_addr, accessSize, 0, swap);
-	if (farcode.Enabled())
+	if (UseMMUFastmem(flags) && (reg_value.IsImm() || swap))
+	{
+		const u8* backpatchStart = GetCodePtr();
+		u8* mov = UnsafeWriteRegToReg(reg_value, reg_addr, accessSize, 0, swap);
+		ptrdiff_t padding = BACKPATCH_SIZE - (GetCodePtr() - backpatchStart);
+		if (padding > 0)
+			NOP(padding);
+		registersInUseAtLoc[mov] = registersInUse;
+		pcAtLoc[mov] = jit->js.compilerPC;
 		SwitchToFarCode();
+		slowPathAtLoc[mov] = GetCodePtr();
+	}
 	else
-		exit = J(true);
-	SetJumpTarget(slow);
+	{
+		slow = CheckIfSafeAddress(reg_value, reg_addr, registersInUse, mem_mask);
+		UnsafeWriteRegToReg(reg_value, reg_addr, accessSize, 0, swap);
+		if (farcode.Enabled())
+			SwitchToFarCode();
+		else
+			exit = J(true);
+		SetJumpTarget(slow);
+	}
+
+	BitSet32 probe_in_use = registersInUse;
+	probe_in_use[reg_addr] = true;
+	if (reg_value.IsSimpleReg())
+		probe_in_use[reg_value.GetSimpleReg()] = true;
+	X64Reg reg_host;
+	FixupBranch not_cached, crosses_page, exit_cached;
+	bool probed = ProbeTranslationCache(reg_addr, accessSize, probe_in_use, Memory::FLAG_WRITE,
+	                                    &reg_host, &not_cached, &crosses_page);
+	if (probed)
+	{
+		UnsafeWriteRegToReg(reg_value, reg_host, accessSize, 0, swap);
+		exit_cached = J(true);
+		SetJumpTarget(not_cached);
+		SetJumpTarget(crosses_page);
+	}
 
 	// PC is used by memory watchpoints (if enabled) or to print accurate PC locations in debug logs
 	MOV(32, PPCSTATE(pc), Imm32(jit->js.compilerPC));
@@ -639,6 +754,8 @@ void EmuCodeBlock::SafeWriteRegToReg(OpArg reg_value, X64Reg reg_addr, int acces
 		SwitchToNearCode();
 	}
 	SetJumpTarget(exit);
+	if (probed)
+		SetJumpTarget(exit_cached);
 }
 
 void EmuCodeBlock::WriteToConstRamAddress(int accessSize, OpArg arg, u32 address, bool swap)
@@ -9,6 +9,7 @@
 #include "Common/BitSet.h"
 #include "Common/CPUDetect.h"
 #include "Common/x64Emitter.h"
+#include "Core/HW/Memmap.h"
 
 namespace MMIO { class Mapping; }
 
@@ -77,7 +78,16 @@ public:
 	void LoadAndSwap(int size, Gen::X64Reg dst, const Gen::OpArg& src);
 	void SwapAndStore(int size, const Gen::OpArg& dst, Gen::X64Reg src);
 
+	// With the MMU on, whether to access memory through the fastmem arena and fall back to the
+	// slow path in far code.
+	bool UseMMUFastmem(int flags);
 	Gen::FixupBranch CheckIfSafeAddress(Gen::OpArg reg_value, Gen::X64Reg reg_addr, BitSet32 registers_in_use, u32 mem_mask);
+	// With the MMU on, looks the page of reg_addr up in Memory's translation cache and leaves
+	// the matching fastmem arena offset in *reg_host. The two branches are taken if the page
+	// isn't cached or the access crosses into the next page. Returns false without emitting
+	// anything if there aren't two scratch registers outside registers_in_use.
+	bool ProbeTranslationCache(Gen::X64Reg reg_addr, int accessSize, BitSet32 registers_in_use, Memory::XCheckTLBFlag flag,
+	                           Gen::X64Reg* reg_host, Gen::FixupBranch* not_cached, Gen::FixupBranch* crosses_page);
 	void UnsafeLoadRegToReg(Gen::X64Reg reg_addr, Gen::X64Reg reg_value, int accessSize, s32 offset = 0, bool signExtend = false);
 	void UnsafeLoadRegToRegNoSwap(Gen::X64Reg reg_addr, Gen::X64Reg reg_value, int accessSize, s32 offset, bool signExtend = false);
 	// these return the address of the MOV, for backpatching
@@ -141,4 +151,7 @@ public:
 protected:
 	std::unordered_map<u8 *, BitSet32> registersInUseAtLoc;
 	std::unordered_map<u8 *, u32> pcAtLoc;
+	// With the MMU on, fastmem accesses that can't be mapped are patched to jump here instead
+	// of to a trampoline, since the slow path also has to check for DSI exceptions.
+	std::unordered_map<u8 *, const u8 *> slowPathAtLoc;
 };
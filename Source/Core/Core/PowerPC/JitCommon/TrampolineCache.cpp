@@ -6,6 +6,7 @@
 #include <string>
 
 #include "Common/CommonTypes.h"
+#include "Common/JitRegister.h"
 #include "Common/StringUtil.h"
 #include "Common/x64ABI.h"
 #include "Core/HW/Memmap.h"
@@ -94,6 +95,7 @@ const u8* TrampolineCache::GenerateReadTrampoline(const InstructionInfo &info, B
 
 	ABI_PopRegistersAndAdjustStack(registersInUse, 8);
 	RET();
+	JitRegister::Register(trampoline, (u32)(GetCodePtr() - trampoline), "JIT_ReadTrampoline");
 	return trampoline;
 }
 
@@ -179,6 +181,7 @@ const u8* TrampolineCache::GenerateWriteTrampoline(const InstructionInfo &info,
 	ABI_PopRegistersAndAdjustStack(registersInUse, 8);
 	RET();
 
+	JitRegister::Register(trampoline, (u32)(GetCodePtr() - trampoline), StringFromFormat("JIT_WriteTrampoline_%x", pc));
 	return trampoline;
 }
 
@@ -12,12 +12,15 @@
 #include "Common/PerformanceCounter.h"
 #endif
 
+#include "Common/JitRegister.h"
+
 #include "Core/ConfigManager.h"
 #include "Core/HW/Memmap.h"
 #include "Core/PowerPC/JitInterface.h"
 #include "Core/PowerPC/PPCSymbolDB.h"
 #include "Core/PowerPC/Profiler.h"
 #include "Core/PowerPC/JitCommon/JitBase.h"
+#include "Core/PowerPC/JitCommon/JitProfile.h"
 
 #if _M_X86
 #include "Core/PowerPC/Jit64/Jit.h"
@@ -88,6 +91,13 @@ namespace JitInterface
 			}
 		}
 		jit = static_cast<JitBase*>(ptr);
+		if (SConfig::GetInstance().m_LocalCoreStartupParameter.bJITPerfMap)
+			JitRegister::Init();
+		// Only Jit64 records and prefetches blocks. Breakpoints and single stepping change how
+		// blocks are compiled.
+		if (core == 1 && SConfig::GetInstance().m_LocalCoreStartupParameter.bJITWarmStart &&
+		    !SConfig::GetInstance().m_LocalCoreStartupParameter.bEnableDebugging)
+			JitProfile::Init(SConfig::GetInstance().m_LocalCoreStartupParameter.GetUniqueID());
 		jit->Init();
 		return ptr;
 	}
@@ -183,6 +193,11 @@ namespace JitInterface
 	}
 	bool HandleFault(uintptr_t access_address, SContext* ctx)
 	{
+		// Writes to pages the texture cache watches can come from any thread, and only need
+		// to be retried once the page is writable again.
+		if (Memory::HandleWriteWatchFault(access_address))
+			return true;
+
 		return jit->HandleFault(access_address, ctx);
 	}
 
@@ -228,6 +243,11 @@ namespace JitInterface
 		return inst;
 	}
 
+	void StartWarmStart()
+	{
+		JitProfile::StartPrefetch();
+	}
+
 	void CompileExceptionCheck(ExceptionType type)
 	{
 		if (!jit)
@@ -248,6 +268,7 @@ namespace JitInterface
 			if (optype == OPTYPE_STORE || optype == OPTYPE_STOREFP || (optype == OPTYPE_STOREPS))
 			{
 				exception_addresses->insert(PC);
+				JitProfile::RecordFifoWrite(PC);
 
 				// Invalidate the JIT block so that it gets recompiled with the external exception check included.
 				jit->GetBlockCache()->InvalidateICache(PC, 4, true);
@@ -263,5 +284,7 @@ namespace JitInterface
 			delete jit;
 			jit = nullptr;
 		}
+		JitProfile::Shutdown();
+		JitRegister::Shutdown();
 	}
 }
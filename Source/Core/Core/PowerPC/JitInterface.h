@@ -41,6 +41,10 @@ namespace JitInterface
 
 	void CompileExceptionCheck(ExceptionType type);
 
+	// Starts looking for blocks from earlier sessions to compile ahead of time.
+	// Call once the game's code has been loaded.
+	void StartWarmStart();
+
 	void Shutdown();
 }
 extern bool bMMU;
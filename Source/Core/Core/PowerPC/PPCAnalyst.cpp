@@ -6,6 +6,7 @@
 #include <queue>
 #include <string>
 
+#include "Common/MathUtil.h"
 #include "Common/StringUtil.h"
 
 #include "Core/ConfigManager.h"
@@ -501,6 +502,25 @@ void PPCAnalyzer::SetInstructionStats(CodeBlock *block, CodeOp *code, GekkoOPInf
 	else
 		code->outputCR1 = (opinfo->flags & FL_SET_CR1) ? true : false;
 
+	// mtcrf's CRM field overlaps CRFD; it writes exactly the fields selected by CRM.
+	if (code->inst.OPCD == 31 && code->inst.SUBOP10 == 144)
+	{
+		code->outputCR0 = (code->inst.CRM & 0x80) != 0;
+		code->outputCR1 = (code->inst.CRM & 0x40) != 0;
+	}
+
+	// Branches read CR too, but they can end the block, which counts as reading everything.
+	// Otherwise only CR and system instructions (mfcr, mcrf, ...) read CR fields; be
+	// conservative about which ones.
+	if (opinfo->type == OPTYPE_CR || opinfo->type == OPTYPE_SYSTEM || opinfo->type == OPTYPE_SYSTEMFP)
+	{
+		if (!(code->inst.OPCD == 31 && code->inst.SUBOP10 == 144))
+		{
+			code->wantsCR0 = true;
+			code->wantsCR1 = true;
+		}
+	}
+
 	code->wantsFPRF = (opinfo->flags & FL_READ_FPRF) ? true : false;
 	code->outputFPRF = (opinfo->flags & FL_SET_FPRF) ? true : false;
 	code->canEndBlock = (opinfo->flags & FL_ENDBLOCK) ? true : false;
@@ -606,12 +626,6 @@ void PPCAnalyzer::SetInstructionStats(CodeBlock *block, CodeOp *code, GekkoOPInf
 	case OPTYPE_DOUBLEFP:
 		break;
 	case OPTYPE_BRANCH:
-		if (code->inst.hex == 0x4e800020)
-		{
-			// For analysis purposes, we can assume that blr eats opinfo->flags.
-			code->outputCR0 = true;
-			code->outputCR1 = true;
-		}
 		break;
 	case OPTYPE_SYSTEM:
 	case OPTYPE_SYSTEMFP:
@@ -619,6 +633,170 @@ void PPCAnalyzer::SetInstructionStats(CodeBlock *block, CodeOp *code, GekkoOPInf
 	}
 }
 
+// Finds loops that just poll memory, e.g.
+//   loop: lwz r0, 0x1234(r13)
+//         cmpwi r0, 0
+//         beq loop
+// Every iteration does the same thing until RAM or a hardware register changes, which only
+// happens when an event runs (or another thread, which doesn't care when we look), so the JIT
+// can skip ahead to the next event instead of spinning. MMIO reads are just loads here: the
+// loop is run again after skipping, so a register that changes on its own when read gets
+// read as often as it needs to be.
+void PPCAnalyzer::FindIdleLoop(CodeBlock *block, CodeOp *code)
+{
+	BitSet32 written, read_before_written;
+	bool ca_written = false, ca_read_before_written = false;
+
+	for (u32 i = 0; i < block->m_num_instructions; i++)
+	{
+		CodeOp& op = code[i];
+		UGeckoInstruction inst = op.inst;
+
+		if (op.opinfo->type == OPTYPE_BRANCH)
+		{
+			// Only the first branch can close the loop, and it mustn't touch LR or CTR.
+			u32 destination;
+			if (inst.OPCD == 18 && !inst.LK)
+				destination = (inst.AA ? 0 : op.address) + SignExt26(inst.LI << 2);
+			else if (inst.OPCD == 16 && !inst.LK && (inst.BO & BO_DONT_DECREMENT_FLAG))
+				destination = (inst.AA ? 0 : op.address) + SignExt16(inst.BD << 2);
+			else
+				return;
+
+			op.branchIsIdleLoop = destination == block->m_address;
+			return;
+		}
+
+		// No stores, no system instructions, and nothing that makes the next iteration
+		// different from this one, like SO, CTR or a register that is incremented.
+		if ((op.opinfo->type != OPTYPE_INTEGER && op.opinfo->type != OPTYPE_LOAD) ||
+		    (op.opinfo->flags & FL_SET_OE))
+			return;
+		// The analyzer doesn't know which registers these write.
+		if (!strncmp(op.opinfo->opname, "lsw", 3))
+			return;
+
+		read_before_written |= op.regsIn & ~written;
+		if (read_before_written & op.regsOut)
+			return;
+		written |= op.regsOut;
+
+		if ((op.opinfo->flags & FL_READ_CA) && !ca_written)
+			ca_read_before_written = true;
+		if (op.opinfo->flags & FL_SET_CA)
+		{
+			if (ca_read_before_written)
+				return;
+			ca_written = true;
+		}
+	}
+}
+
+static u32 RotateMask(u32 mb, u32 me)
+{
+	// first make 001111111111111 part
+	u32 begin = 0xFFFFFFFF >> mb;
+	// then make 000000000001111 part, which is used to flip the bits of the first one
+	u32 end = me < 31 ? (0xFFFFFFFF >> (me + 1)) : 0;
+	// do the bitflip
+	u32 mask = begin ^ end;
+	// and invert if backwards
+	return me < mb ? ~mask : mask;
+}
+
+// Computes the result of an integer instruction whose inputs are all known. Only the GPR
+// result is computed; CR0 and CA are left to the JIT.
+static bool EvaluateConstant(UGeckoInstruction inst, BitSet32 known, const u32* gpr, u32* result)
+{
+	bool a_known = known[inst.RA], b_known = known[inst.RB], s_known = known[inst.RS];
+	u32 a = gpr[inst.RA], b = gpr[inst.RB], s = gpr[inst.RS];
+	u32 simm = (u32)(s32)inst.SIMM_16;
+
+	switch (inst.OPCD)
+	{
+	case 7:  *result = a * simm; return a_known; // mulli
+	case 8:  *result = simm - a; return a_known; // subfic
+	case 12: // addic
+	case 13: *result = a + simm; return a_known; // addic.
+	case 14: *result = (inst.RA ? a : 0) + simm; return !inst.RA || a_known; // addi
+	case 15: *result = (inst.RA ? a : 0) + (simm << 16); return !inst.RA || a_known; // addis
+	case 20: // rlwimi
+		*result = (_rotl(s, inst.SH) & RotateMask(inst.MB, inst.ME)) | (a & ~RotateMask(inst.MB, inst.ME));
+		return s_known && a_known;
+	case 21: *result = _rotl(s, inst.SH) & RotateMask(inst.MB, inst.ME); return s_known; // rlwinm
+	case 23: *result = _rotl(s, b & 0x1F) & RotateMask(inst.MB, inst.ME); return s_known && b_known; // rlwnm
+	case 24: *result = s | inst.UIMM; return s_known; // ori
+	case 25: *result = s | (inst.UIMM << 16); return s_known; // oris
+	case 26: *result = s ^ inst.UIMM; return s_known; // xori
+	case 27: *result = s ^ (inst.UIMM << 16); return s_known; // xoris
+	case 28: *result = s & inst.UIMM; return s_known; // andi.
+	case 29: *result = s & (inst.UIMM << 16); return s_known; // andis.
+	case 31:
+		// SUBOP10 includes the OE bit, so none of these are the overflow-checking forms.
+		switch (inst.SUBOP10)
+		{
+		case 28:  *result = s & b; return s_known && b_known; // and
+		case 60:  *result = s & ~b; return s_known && b_known; // andc
+		case 124: *result = ~(s | b); return s_known && b_known; // nor
+		case 284: *result = ~(s ^ b); return s_known && b_known; // eqv
+		case 316: *result = s ^ b; return s_known && b_known; // xor
+		case 412: *result = s | ~b; return s_known && b_known; // orc
+		case 444: *result = s | b; return s_known && b_known; // or
+		case 476: *result = ~(s & b); return s_known && b_known; // nand
+		case 24:  *result = (b & 0x20) ? 0 : s << (b & 0x1F); return s_known && b_known; // slw
+		case 536: *result = (b & 0x20) ? 0 : s >> (b & 0x1F); return s_known && b_known; // srw
+		case 792: *result = (u32)((s32)s >> ((b & 0x20) ? 31 : (b & 0x1F))); return s_known && b_known; // sraw
+		case 824: *result = (u32)((s32)s >> inst.SH); return s_known; // srawi
+		case 922: *result = (u32)(s32)(s16)s; return s_known; // extsh
+		case 954: *result = (u32)(s32)(s8)s; return s_known; // extsb
+		case 26:  *result = s ? 31 - IntLog2(s) : 32; return s_known; // cntlzw
+		case 10:  // addc
+		case 266: *result = a + b; return a_known && b_known; // add
+		case 8:   // subfc
+		case 40:  *result = b - a; return a_known && b_known; // subf
+		case 104: *result = 0 - a; return a_known; // neg
+		case 235: *result = a * b; return a_known && b_known; // mullw
+		case 75:  *result = (u32)(((s64)(s32)a * (s64)(s32)b) >> 32); return a_known && b_known; // mulhw
+		case 11:  *result = (u32)(((u64)a * (u64)b) >> 32); return a_known && b_known; // mulhwu
+		}
+		break;
+	}
+	return false;
+}
+
+// Tracks which GPRs hold a known value through the block, e.g. after lis/ori pairs or chains
+// of addi, so the JIT can treat the results as immediates. The register cache finds many of
+// these on its own, but forgets them whenever it has to flush.
+void PPCAnalyzer::PropagateConstants(CodeBlock *block, CodeOp *code)
+{
+	BitSet32 known;
+	u32 gpr[32] = {};
+
+	for (u32 i = 0; i < block->m_num_instructions; i++)
+	{
+		CodeOp& op = code[i];
+		u32 value;
+
+		op.outputIsConstant = op.opinfo->type == OPTYPE_INTEGER && op.regsOut.Count() == 1 &&
+		                      EvaluateConstant(op.inst, known, gpr, &value);
+		if (op.outputIsConstant)
+		{
+			int reg = *op.regsOut.begin();
+			op.outputConstant = value;
+			known[reg] = true;
+			gpr[reg] = value;
+		}
+		else
+		{
+			known &= ~op.regsOut;
+		}
+
+		// The analyzer doesn't know which registers these write.
+		if (!strncmp(op.opinfo->opname, "lsw", 3))
+			known = BitSet32(0);
+	}
+}
+
 u32 PPCAnalyzer::Analyze(u32 address, CodeBlock *block, CodeBuffer *buffer, u32 blockSize)
 {
 	// Clear block stats
@@ -799,6 +977,9 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock *block, CodeBuffer *buffer, u32
 	if (block->m_num_instructions > 1)
 		ReorderInstructions(block->m_num_instructions, code);
 
+	FindIdleLoop(block, code);
+	PropagateConstants(block, code);
+
 	if ((!found_exit && num_inst > 0) || blockSize == 1)
 	{
 		// We couldn't find an exit
@@ -43,6 +43,13 @@ struct CodeOp //16B
 	bool outputCA;
 	bool canEndBlock;
 	bool skip;  // followed BL-s for example
+	// a branch back to the start of the block that can only be taken again once something
+	// outside the CPU has changed memory, see PPCAnalyzer::FindIdleLoop
+	bool branchIsIdleLoop;
+	// the instruction's GPR result only depends on values known at compile time,
+	// see PPCAnalyzer::PropagateConstants
+	bool outputIsConstant;
+	u32 outputConstant;
 	// which registers are still needed after this instruction in this block
 	BitSet32 fprInUse;
 	BitSet32 gprInUse;
@@ -170,6 +177,8 @@ private:
 	void ReorderInstructionsCore(u32 instructions, CodeOp* code, bool reverse, ReorderType type);
 	void ReorderInstructions(u32 instructions, CodeOp *code);
 	void SetInstructionStats(CodeBlock *block, CodeOp *code, GekkoOPInfo *opinfo, u32 index);
+	void FindIdleLoop(CodeBlock *block, CodeOp *code);
+	void PropagateConstants(CodeBlock *block, CodeOp *code);
 
 	// Options
 	u32 m_options;
@@ -20,6 +20,7 @@
 #include "Core/PowerPC/JitInterface.h"
 #include "Core/PowerPC/PowerPC.h"
 #include "Core/PowerPC/PPCTables.h"
+#include "Core/PowerPC/Profiler.h"
 #include "Core/PowerPC/Interpreter/Interpreter.h"
 
 
@@ -116,6 +117,7 @@ static void ResetRegisters()
 void Init(int cpu_core)
 {
 	FPURoundMode::SetPrecisionMode(FPURoundMode::PREC_53);
+	Profiler::Init();
 
 	memset(ppcState.sr, 0, sizeof(ppcState.sr));
 	ppcState.dtlb_last = 0;
@@ -169,6 +171,8 @@ void Init(int cpu_core)
 
 void Shutdown()
 {
+	// The sampler looks at the JIT's blocks.
+	Profiler::StopSampling();
 	JitInterface::Shutdown();
 	interpreter->Shutdown();
 	cpu_core_base = nullptr;
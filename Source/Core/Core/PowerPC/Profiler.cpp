@@ -2,9 +2,29 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <cinttypes>
+#include <map>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "Common/FileUtil.h"
+#include "Common/Flag.h"
+#include "Common/StringUtil.h"
+#include "Common/Thread.h"
+#include "Common/Timer.h"
+
+#include "Core/Core.h"
+#include "Core/CoreTiming.h"
+#include "Core/HW/Memmap.h"
 #include "Core/PowerPC/JitInterface.h"
+#include "Core/PowerPC/PowerPC.h"
+#include "Core/PowerPC/PPCSymbolDB.h"
 #include "Core/PowerPC/Profiler.h"
+#include "Core/PowerPC/JitCommon/JitBase.h"
 
 namespace Profiler
 {
@@ -16,4 +36,274 @@ void WriteProfileResults(const std::string& filename)
 	JitInterface::WriteProfileResults(filename);
 }
 
+enum
+{
+	MAX_STACK_DEPTH = 32,
+	// How many samples go by between updates of the on-screen top list.
+	SAMPLES_PER_REPORT = 2000,
+	REPORT_LENGTH = 5,
+};
+
+struct FunctionStats
+{
+	u64 samples;
+	u64 host_us;
+	u64 guest_cycles;
+};
+
+static std::thread s_sampling_thread;
+static Common::Flag s_sampling;
+static int s_report_event;
+
+// The sampling thread only records addresses. The JIT's blocks are only safe to look at on
+// the CPU thread and the symbol database belongs to the CPU and UI threads, so entry counts
+// are collected and addresses turned into functions with every report. That keeps the raw
+// samples down to one report's worth, and the rest is bounded by the number of functions.
+static std::mutex s_samples_lock;
+static std::map<std::vector<u32>, FunctionStats> s_new_stacks; // PC and return addresses, outermost first -> stats
+static std::map<std::vector<u32>, u64> s_stacks; // function addresses, outermost first -> samples
+static std::map<u32, FunctionStats> s_functions; // function address -> stats
+static std::map<u32, u64> s_entries; // block address -> entries, as of the last collection
+static u64 s_total_us;
+static u64 s_total_cycles;
+
+// Finding the function for an address that isn't a function start is a linear search, so
+// remember the answers. Protected by s_samples_lock.
+static std::unordered_map<u32, u32> s_function_cache;
+
+static u32 GetFunctionAddress(u32 addr)
+{
+	auto it = s_function_cache.find(addr);
+	if (it != s_function_cache.end())
+		return it->second;
+
+	Symbol* symbol = g_symbolDB.GetSymbolFromAddr(addr);
+	u32 function = symbol ? symbol->address : addr;
+	s_function_cache[addr] = function;
+	return function;
+}
+
+// Must be called with s_samples_lock held.
+static void FoldNewSamples()
+{
+	std::vector<u32> functions;
+	for (const auto& entry : s_new_stacks)
+	{
+		functions.clear();
+		for (u32 addr : entry.first)
+			functions.push_back(GetFunctionAddress(addr));
+		s_stacks[functions] += entry.second.samples;
+
+		FunctionStats& stats = s_functions[functions.back()];
+		stats.samples += entry.second.samples;
+		stats.host_us += entry.second.host_us;
+		stats.guest_cycles += entry.second.guest_cycles;
+	}
+	s_new_stacks.clear();
+}
+
+static std::string GetFunctionName(u32 function)
+{
+	Symbol* symbol = g_symbolDB.GetSymbolFromAddr(function);
+	if (!symbol || symbol->name.empty())
+		return StringFromFormat("%08x", function);
+	return symbol->name;
+}
+
+static bool IsStackBottom(u32 addr)
+{
+	return !addr || !Memory::IsRAMAddress(addr);
+}
+
+// Follows the back chain the same way the debugger's callstack does.
+static void GetStack(std::vector<u32>* stack)
+{
+	stack->clear();
+	stack->push_back(PowerPC::ppcState.pc);
+
+	u32 addr = PowerPC::ppcState.gpr[1];
+	if (IsStackBottom(addr))
+		return;
+	addr = Memory::ReadUnchecked_U32(addr);
+	while (stack->size() < MAX_STACK_DEPTH && !IsStackBottom(addr) && !IsStackBottom(addr + 4))
+	{
+		stack->push_back(Memory::ReadUnchecked_U32(addr + 4) - 4);
+		addr = Memory::ReadUnchecked_U32(addr);
+	}
+	std::reverse(stack->begin(), stack->end());
+}
+
+// Entry counts come from the JIT blocks that start at the function. Only call this on the
+// CPU thread or while it's paused.
+static void CollectEntryCounts()
+{
+	std::map<u32, u64> entries;
+	if (jit && PowerPC::GetMode() == PowerPC::MODE_JIT)
+	{
+		JitBaseBlockCache* blocks = jit->GetBlockCache();
+		for (int i = 0; i < blocks->GetNumBlocks(); i++)
+		{
+			const JitBlock* block = blocks->GetBlock(i);
+			if (!block->invalid && block->runCount > 0)
+				entries[block->originalAddress] += block->runCount;
+		}
+	}
+
+	std::lock_guard<std::mutex> lk(s_samples_lock);
+	s_entries.swap(entries);
+	FoldNewSamples();
+}
+
+// Runs on the CPU thread every SAMPLES_PER_REPORT samples.
+static void ReportCallback(u64 userdata, int cyclesLate)
+{
+	if (!s_sampling.IsSet())
+		return;
+
+	CollectEntryCounts();
+	for (const std::string& line : GetTopFunctions(REPORT_LENGTH))
+		Core::DisplayMessage(line, 2000);
+}
+
+static void SamplingThread()
+{
+	Common::SetCurrentThreadName("Guest profiler");
+
+	std::vector<u32> stack;
+	u64 last_us = Common::Timer::GetTimeUs();
+	u64 last_ticks = CoreTiming::GetTicks();
+	int samples_since_report = 0;
+
+	while (s_sampling.IsSet())
+	{
+		Common::SleepCurrentThread(1);
+
+		u64 now_us = Common::Timer::GetTimeUs();
+		u64 now_ticks = CoreTiming::GetTicks();
+		u64 elapsed_us = now_us - last_us;
+		u64 elapsed_ticks = now_ticks - last_ticks;
+		last_us = now_us;
+		last_ticks = now_ticks;
+
+		if (Core::GetState() != Core::CORE_RUN)
+			continue;
+
+		GetStack(&stack);
+
+		{
+			std::lock_guard<std::mutex> lk(s_samples_lock);
+			FunctionStats& stats = s_new_stacks[stack];
+			stats.samples++;
+			stats.host_us += elapsed_us;
+			stats.guest_cycles += elapsed_ticks;
+			s_total_us += elapsed_us;
+			s_total_cycles += elapsed_ticks;
+		}
+
+		if (++samples_since_report == SAMPLES_PER_REPORT)
+		{
+			samples_since_report = 0;
+			CoreTiming::ScheduleEvent_Threadsafe(0, s_report_event);
+		}
+	}
+}
+
+void Init()
+{
+	s_report_event = CoreTiming::RegisterEvent("ProfilerReport", ReportCallback);
+}
+
+void StartSampling()
+{
+	if (s_sampling.IsSet())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lk(s_samples_lock);
+		s_new_stacks.clear();
+		s_stacks.clear();
+		s_functions.clear();
+		s_entries.clear();
+		s_total_us = 0;
+		s_total_cycles = 0;
+		s_function_cache.clear();
+	}
+
+	s_sampling.Set();
+	s_sampling_thread = std::thread(SamplingThread);
+}
+
+void StopSampling()
+{
+	if (!s_sampling.TestAndClear())
+		return;
+	s_sampling_thread.join();
+	CollectEntryCounts();
+}
+
+bool IsSampling()
+{
+	return s_sampling.IsSet();
+}
+
+void WriteFlameGraph(const std::string& filename)
+{
+	File::IOFile f(filename, "w");
+	if (!f)
+	{
+		PanicAlert("Failed to open %s", filename.c_str());
+		return;
+	}
+
+	std::lock_guard<std::mutex> lk(s_samples_lock);
+	FoldNewSamples();
+
+	for (const auto& entry : s_stacks)
+	{
+		std::string line;
+		for (u32 function : entry.first)
+		{
+			if (!line.empty())
+				line += ';';
+			std::string name = GetFunctionName(function);
+			std::replace(name.begin(), name.end(), ';', ':');
+			line += name;
+		}
+		fprintf(f.GetHandle(), "%s %" PRIu64 "\n", line.c_str(), entry.second);
+	}
+}
+
+std::vector<std::string> GetTopFunctions(size_t count)
+{
+	std::vector<std::pair<u32, FunctionStats>> functions;
+	std::map<u32, u64> entries;
+	u64 total_us, total_cycles;
+	{
+		std::lock_guard<std::mutex> lk(s_samples_lock);
+		FoldNewSamples();
+		functions.assign(s_functions.begin(), s_functions.end());
+		entries = s_entries;
+		total_us = std::max<u64>(s_total_us, 1);
+		total_cycles = std::max<u64>(s_total_cycles, 1);
+	}
+
+	count = std::min(count, functions.size());
+	std::partial_sort(functions.begin(), functions.begin() + count, functions.end(),
+		[](const std::pair<u32, FunctionStats>& a, const std::pair<u32, FunctionStats>& b) {
+			return a.second.host_us > b.second.host_us;
+		});
+
+	std::vector<std::string> lines;
+	for (size_t i = 0; i < count; i++)
+	{
+		const FunctionStats& stats = functions[i].second;
+		auto it = entries.find(functions[i].first);
+		lines.push_back(StringFromFormat("%s: %.1f%% host, %.1f%% guest cycles, %" PRIu64 " entries",
+			GetFunctionName(functions[i].first).c_str(),
+			100.0 * stats.host_us / total_us, 100.0 * stats.guest_cycles / total_cycles,
+			it != entries.end() ? it->second : 0));
+	}
+	return lines;
+}
+
 }  // namespace
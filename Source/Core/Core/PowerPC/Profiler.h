@@ -7,6 +7,7 @@
 
 #include <cstddef>
 #include <string>
+#include <vector>
 
 #include "Common/CommonTypes.h"
 
@@ -57,4 +58,20 @@ namespace Profiler
 extern bool g_ProfileBlocks;
 
 void WriteProfileResults(const std::string& filename);
+
+// Sampling profiler for guest code. A thread samples the PC and the guest stack about
+// once a millisecond and charges the host time and guest cycles that passed to the
+// PPCSymbolDB function that was running. While it runs, JIT blocks also count their
+// entries, so the JIT cache should be cleared when it's switched on or off.
+// Init registers the CPU thread event that collects the entry counts while sampling.
+void Init();
+void StartSampling();
+// Collects the final entry counts, so the CPU thread must be paused or stopped.
+void StopSampling();
+bool IsSampling();
+
+// Writes one line per sampled call stack in the folded format that flamegraph.pl reads.
+void WriteFlameGraph(const std::string& filename);
+// The most expensive functions so far, one per line.
+std::vector<std::string> GetTopFunctions(size_t count);
 }
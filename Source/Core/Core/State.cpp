@@ -2,10 +2,17 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
 #include <mutex>
 #include <thread>
 #include <lzo/lzo1x.h>
 
+#include "AudioCommon/AudioCommon.h"
+
 #include "Common/CommonTypes.h"
 #include "Common/Event.h"
 #include "Common/StringUtil.h"
@@ -14,10 +21,12 @@
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
 #include "Core/CoreTiming.h"
+#include "Core/DSPEmulator.h"
 #include "Core/Movie.h"
 #include "Core/State.h"
 #include "Core/HW/CPU.h"
 #include "Core/HW/DSP.h"
+#include "Core/HW/EXI.h"
 #include "Core/HW/HW.h"
 #include "Core/HW/Memmap.h"
 #include "Core/HW/SystemTimers.h"
@@ -41,12 +50,20 @@ static const u32 IN_LEN = 128 * 1024u;
 
 static const u32 OUT_LEN = IN_LEN + (IN_LEN / 16) + 64 + 3;
 
-static unsigned char __LZO_MMODEL out[OUT_LEN];
-
-#define HEAP_ALLOC(var, size) \
-	lzo_align_t __LZO_MMODEL var[((size) + (sizeof(lzo_align_t) - 1)) / sizeof(lzo_align_t)]
+// Every IN_LEN chunk of a compressed state is an independent LZO stream, so chunks
+// can be compressed and decompressed on all cores at once.
+static unsigned int GetNumCompressionThreads(size_t num_chunks)
+{
+	const unsigned int cores = std::max(std::thread::hardware_concurrency(), 1u);
+	return (unsigned int)std::min<size_t>(cores, num_chunks);
+}
 
-static HEAP_ALLOC(wrkmem, LZO1X_1_MEM_COMPRESS);
+// A state buffer of 'size' bytes is always stored as size / IN_LEN full chunks
+// followed by one (possibly empty) partial chunk.
+static size_t GetNumChunks(size_t size)
+{
+	return size / IN_LEN + 1;
+}
 
 static std::string g_last_filename;
 
@@ -64,7 +81,7 @@ static Common::Event g_compressAndDumpStateSyncEvent;
 static std::thread g_save_thread;
 
 // Don't forget to increase this after doing changes on the savestate system
-static const u32 STATE_VERSION = 36;
+static const u32 STATE_VERSION = 37;
 
 enum
 {
@@ -133,10 +150,9 @@ void LoadFromBuffer(std::vector<u8>& buffer)
 	Core::PauseAndLock(false, wasUnpaused);
 }
 
-void SaveToBuffer(std::vector<u8>& buffer)
+// The caller has to make sure nothing else is touching the state.
+static void SaveToBufferLocked(std::vector<u8>& buffer)
 {
-	bool wasUnpaused = Core::PauseAndLock(true);
-
 	u8* ptr = nullptr;
 	PointerWrap p(&ptr, PointerWrap::MODE_MEASURE);
 
@@ -147,6 +163,13 @@ void SaveToBuffer(std::vector<u8>& buffer)
 	ptr = &buffer[0];
 	p.SetMode(PointerWrap::MODE_WRITE);
 	DoState(p);
+}
+
+void SaveToBuffer(std::vector<u8>& buffer)
+{
+	bool wasUnpaused = Core::PauseAndLock(true);
+
+	SaveToBufferLocked(buffer);
 
 	Core::PauseAndLock(false, wasUnpaused);
 }
@@ -162,6 +185,109 @@ void VerifyBuffer(std::vector<u8>& buffer)
 	Core::PauseAndLock(false, wasUnpaused);
 }
 
+// A delta base is a full state taken right after write protecting all of memory. A delta
+// against it holds the rest of the state in full, but only the memory pages written since,
+// as page-indexed records from Memory::DoState. Both start with a header whose generation
+// ties a delta to its base.
+static const u32 DELTA_MAGIC = 0x544C4544; // "DELT"
+
+struct DeltaHeader
+{
+	u32 magic;
+	u32 is_delta;
+	u64 generation;
+};
+
+static bool ReadDeltaHeader(const std::vector<u8>& buffer, DeltaHeader* header)
+{
+	if (buffer.size() < sizeof(*header))
+		return false;
+	memcpy(header, &buffer[0], sizeof(*header));
+	return header->magic == DELTA_MAGIC;
+}
+
+static void SaveWithDeltaHeader(std::vector<u8>& buffer, const DeltaHeader& header)
+{
+	u8* ptr = nullptr;
+	PointerWrap p(&ptr, PointerWrap::MODE_MEASURE);
+
+	DoState(p);
+	const size_t buffer_size = reinterpret_cast<size_t>(ptr);
+	buffer.resize(sizeof(header) + buffer_size);
+	memcpy(&buffer[0], &header, sizeof(header));
+
+	ptr = &buffer[sizeof(header)];
+	p.SetMode(PointerWrap::MODE_WRITE);
+	DoState(p);
+}
+
+static bool LoadWithDeltaHeader(const std::vector<u8>& buffer)
+{
+	u8* ptr = const_cast<u8*>(&buffer[sizeof(DeltaHeader)]);
+	PointerWrap p(&ptr, PointerWrap::MODE_READ);
+	DoState(p);
+	return p.GetMode() == PointerWrap::MODE_READ;
+}
+
+void SaveToDeltaBase(std::vector<u8>& base)
+{
+	bool wasUnpaused = Core::PauseAndLock(true);
+
+	// Protect the pages first, so that anything the save itself writes back ends up in the deltas.
+	const DeltaHeader header = { DELTA_MAGIC, false, Memory::WatchAllPages() };
+	SaveWithDeltaHeader(base, header);
+
+	Core::PauseAndLock(false, wasUnpaused);
+}
+
+bool SaveToDeltaBuffer(const std::vector<u8>& base, std::vector<u8>& delta)
+{
+	DeltaHeader base_header;
+	if (!ReadDeltaHeader(base, &base_header) || base_header.is_delta)
+	{
+		ERROR_LOG(COMMON, "Incremental state requested without a base state");
+		return false;
+	}
+
+	bool wasUnpaused = Core::PauseAndLock(true);
+
+	const DeltaHeader header = { DELTA_MAGIC, true, base_header.generation };
+	Memory::BeginDeltaState(base_header.generation);
+	SaveWithDeltaHeader(delta, header);
+	Memory::EndDeltaState();
+
+	Core::PauseAndLock(false, wasUnpaused);
+	return true;
+}
+
+bool LoadFromDeltaBuffer(const std::vector<u8>& base, const std::vector<u8>& delta)
+{
+	DeltaHeader base_header, delta_header;
+	if (!ReadDeltaHeader(base, &base_header) || base_header.is_delta ||
+	    !ReadDeltaHeader(delta, &delta_header) || !delta_header.is_delta ||
+	    delta_header.generation != base_header.generation)
+	{
+		ERROR_LOG(COMMON, "Incremental state doesn't match its base state");
+		return false;
+	}
+
+	bool wasUnpaused = Core::PauseAndLock(true);
+
+	bool success = LoadWithDeltaHeader(base);
+	if (success)
+	{
+		Memory::BeginDeltaState(delta_header.generation);
+		success = LoadWithDeltaHeader(delta);
+		Memory::EndDeltaState();
+	}
+
+	Core::PauseAndLock(false, wasUnpaused);
+
+	if (!success)
+		ERROR_LOG(COMMON, "Failed to load incremental state");
+	return success;
+}
+
 // return state number not in map
 static int GetEmptySlot(std::map<double, int> m)
 {
@@ -263,33 +389,62 @@ static void CompressAndDumpState(CompressAndDumpState_args save_args)
 
 	if (header.size != 0) // non-zero header size means the state is compressed
 	{
-		lzo_uint i = 0;
-		while (true)
-		{
-			lzo_uint32 cur_len = 0;
-			lzo_uint out_len = 0;
-
-			if ((i + IN_LEN) >= buffer_size)
+		const size_t num_chunks = GetNumChunks(buffer_size);
+		const unsigned int num_threads = GetNumCompressionThreads(num_chunks);
+
+		std::vector<std::vector<u8>> chunks(num_chunks);
+		std::vector<bool> chunk_done(num_chunks, false);
+		std::mutex chunk_mutex;
+		std::condition_variable chunk_cond;
+		std::atomic<size_t> next_chunk(0);
+
+		auto compress_chunks = [&]() {
+			std::vector<lzo_align_t> wrkmem((LZO1X_1_MEM_COMPRESS + sizeof(lzo_align_t) - 1) / sizeof(lzo_align_t));
+			size_t chunk;
+			while ((chunk = next_chunk++) < num_chunks)
 			{
-				cur_len = (lzo_uint32)(buffer_size - i);
+				const size_t start = chunk * IN_LEN;
+				const lzo_uint cur_len = (lzo_uint)std::min<size_t>(IN_LEN, buffer_size - start);
+				std::vector<u8> out(OUT_LEN);
+				lzo_uint out_len = 0;
+
+				if (lzo1x_1_compress(buffer_data + start, cur_len, &out[0], &out_len, wrkmem.data()) != LZO_E_OK)
+				{
+					PanicAlertT("Internal LZO Error - compression failed");
+					out_len = 0;
+				}
+				out.resize(out_len);
+
+				std::lock_guard<std::mutex> chunk_lock(chunk_mutex);
+				chunks[chunk].swap(out);
+				chunk_done[chunk] = true;
+				chunk_cond.notify_all();
 			}
-			else
+		};
+
+		std::vector<std::thread> workers;
+		for (unsigned int i = 0; i < num_threads; ++i)
+			workers.emplace_back(compress_chunks);
+
+		// Stream the chunks to disk in order while the later ones are still being compressed
+		for (size_t chunk = 0; chunk < num_chunks; ++chunk)
+		{
+			std::vector<u8> out;
 			{
-				cur_len = IN_LEN;
+				std::unique_lock<std::mutex> chunk_lock(chunk_mutex);
+				chunk_cond.wait(chunk_lock, [&] { return chunk_done[chunk]; });
+				out.swap(chunks[chunk]);
 			}
 
-			if (lzo1x_1_compress(buffer_data + i, cur_len, out, &out_len, wrkmem) != LZO_E_OK)
-				PanicAlertT("Internal LZO Error - compression failed");
-
 			// The size of the data to write is 'out_len'
-			f.WriteArray((lzo_uint32*)&out_len, 1);
-			f.WriteBytes(out, out_len);
-
-			if (cur_len != IN_LEN)
-				break;
-
-			i += cur_len;
+			const lzo_uint32 out_len = (lzo_uint32)out.size();
+			f.WriteArray(&out_len, 1);
+			if (out_len)
+				f.WriteBytes(&out[0], out_len);
 		}
+
+		for (std::thread& worker : workers)
+			worker.join();
 	}
 	else // uncompressed
 	{
@@ -388,26 +543,69 @@ static void LoadFileStateData(const std::string& filename, std::vector<u8>& ret_
 
 		buffer.resize(header.size);
 
-		lzo_uint i = 0;
-		while (true)
+		// Read all of the compressed chunks at once, then decompress them in parallel
+		// straight into their final place in the state buffer.
+		std::vector<u8> compressed((size_t)(f.GetSize() - sizeof(StateHeader)));
+		if (!compressed.empty() && !f.ReadBytes(&compressed[0], compressed.size()))
 		{
-			lzo_uint32 cur_len = 0;  // number of bytes to read
-			lzo_uint new_len = 0;  // number of bytes to write
+			PanicAlertT("Internal LZO Error - failed to read compressed state");
+			return;
+		}
 
-			if (!f.ReadArray(&cur_len, 1))
+		std::vector<std::pair<size_t, lzo_uint32>> chunks;
+		size_t pos = 0;
+		while (pos + sizeof(lzo_uint32) <= compressed.size())
+		{
+			lzo_uint32 cur_len;
+			memcpy(&cur_len, &compressed[pos], sizeof(cur_len));
+			pos += sizeof(cur_len);
+			if (cur_len > compressed.size() - pos)
 				break;
+			chunks.emplace_back(pos, cur_len);
+			pos += cur_len;
+		}
 
-			f.ReadBytes(out, cur_len);
-			const int res = lzo1x_decompress(out, cur_len, &buffer[i], &new_len, nullptr);
-			if (res != LZO_E_OK)
+		const size_t num_chunks = GetNumChunks(header.size);
+		if (chunks.size() != num_chunks)
+		{
+			PanicAlertT("Internal LZO Error - state is truncated (%u of %u chunks)",
+				(u32)chunks.size(), (u32)num_chunks);
+			return;
+		}
+
+		std::atomic<size_t> next_chunk(0);
+		std::atomic<bool> failed(false);
+		auto decompress_chunks = [&]() {
+			size_t chunk;
+			while ((chunk = next_chunk++) < num_chunks && !failed)
 			{
-				// This doesn't seem to happen anymore.
-				PanicAlertT("Internal LZO Error - decompression failed (%d) (%li, %li) \n"
-					"Try loading the state again", res, i, new_len);
-				return;
+				const size_t start = chunk * IN_LEN;
+				const lzo_uint expected_len = (lzo_uint)std::min<size_t>(IN_LEN, buffer.size() - start);
+				lzo_uint new_len = expected_len;
+				u8 dummy;
+
+				const int res = lzo1x_decompress_safe(&compressed[chunks[chunk].first], chunks[chunk].second,
+					expected_len ? &buffer[start] : &dummy, &new_len, nullptr);
+				if (res != LZO_E_OK || new_len != expected_len)
+				{
+					ERROR_LOG(COMMON, "State chunk %u failed to decompress (%d)", (u32)chunk, res);
+					failed = true;
+				}
 			}
+		};
 
-			i += new_len;
+		std::vector<std::thread> workers;
+		for (unsigned int i = 1; i < GetNumCompressionThreads(num_chunks); ++i)
+			workers.emplace_back(decompress_chunks);
+		decompress_chunks();
+		for (std::thread& worker : workers)
+			worker.join();
+
+		if (failed)
+		{
+			PanicAlertT("Internal LZO Error - decompression failed\n"
+				"Try loading the state again");
+			return;
 		}
 	}
 	else // uncompressed
@@ -522,6 +720,7 @@ void VerifyAt(const std::string& filename)
 	Core::PauseAndLock(false, wasUnpaused);
 }
 
+static void StopRewindThread();
 
 void Init()
 {
@@ -532,6 +731,7 @@ void Init()
 void Shutdown()
 {
 	Flush();
+	StopRewindThread();
 
 	// swapping with an empty vector, rather than clear()ing
 	// this gives a better guarantee to free the allocated memory right NOW (as opposed to, actually, never)
@@ -605,6 +805,373 @@ void Flush()
 		g_save_thread.join();
 }
 
+// Rewind keeps a fixed amount of memory worth of compressed snapshots. On the CPU thread a
+// snapshot is just the state without memory, plus a copy-on-write snapshot of the pages
+// written since the last one; the rewind thread finishes copying the pages and does the rest.
+// The newest snapshot is kept whole, as its state and an image of all of memory, and each
+// entry holds the XOR of an older snapshot with the one after it, so stepping back only needs
+// the newest snapshot, and the oldest entry can be dropped whenever the ring is full.
+struct RewindEntry
+{
+	u32 state_size; // size of the older snapshot's state
+	std::vector<u8> state; // LZO chunks of the XOR of the states
+	std::vector<u32> pages; // the memory pages written to in between
+	std::vector<u8> memory; // LZO chunks of the XOR of those pages
+};
+
+struct RewindCapture
+{
+	std::vector<u8> state;
+	std::vector<u32> pages;
+	std::unique_ptr<u8[]> page_data;
+};
+
+static std::deque<RewindEntry> g_rewind_entries;
+static size_t g_rewind_memory = 0;
+static std::vector<u8> g_rewind_state;
+static std::vector<u8> g_rewind_image; // every page of memory, by page number
+static RewindCapture g_rewind_capture;
+static std::vector<u8> g_rewind_delta;
+static std::mutex g_rewind_mutex;
+static std::condition_variable g_rewind_cond;
+static std::thread g_rewind_thread;
+static std::atomic<bool> g_rewind_pending(false);
+static bool g_rewind_quit = false;
+static u32 g_rewind_frame = 0;
+// Set from a rewind until the next snapshot, however far the game has run on since
+static bool g_rewind_just_rewound = false;
+// Pages written after this aren't in the newest snapshot.
+static u64 g_rewind_generation = 0;
+// What the last snapshot cost the CPU thread, to tell whether the next one fits the budget.
+static u64 g_rewind_state_time = 0; // in microseconds
+static u64 g_rewind_page_time = 0; // per page, in nanoseconds
+static bool g_rewind_over_budget = false;
+
+static void CompressChunks(const u8* data, size_t size, std::vector<u8>& out, lzo_align_t* wrkmem)
+{
+	out.resize(GetNumChunks(size) * (sizeof(lzo_uint32) + OUT_LEN));
+
+	size_t pos = 0;
+	for (size_t start = 0; ; start += IN_LEN)
+	{
+		const lzo_uint cur_len = (lzo_uint)std::min<size_t>(IN_LEN, size - start);
+		lzo_uint out_len = 0;
+		if (lzo1x_1_compress(data + start, cur_len, &out[pos + sizeof(lzo_uint32)], &out_len, wrkmem) != LZO_E_OK)
+			PanicAlertT("Internal LZO Error - compression failed");
+
+		const lzo_uint32 chunk_len = (lzo_uint32)out_len;
+		memcpy(&out[pos], &chunk_len, sizeof(chunk_len));
+		pos += sizeof(chunk_len) + out_len;
+
+		if (cur_len != IN_LEN)
+			break;
+	}
+	out.resize(pos);
+}
+
+static bool DecompressChunks(const std::vector<u8>& in, u8* data, size_t size)
+{
+	size_t pos = 0;
+	for (size_t start = 0; start <= size; start += IN_LEN)
+	{
+		lzo_uint32 chunk_len;
+		if (pos + sizeof(chunk_len) > in.size())
+			return false;
+		memcpy(&chunk_len, &in[pos], sizeof(chunk_len));
+		pos += sizeof(chunk_len);
+		if (chunk_len > in.size() - pos)
+			return false;
+
+		const lzo_uint cur_len = (lzo_uint)std::min<size_t>(IN_LEN, size - start);
+		lzo_uint new_len = cur_len;
+		u8 dummy;
+		if (lzo1x_decompress_safe(&in[pos], chunk_len, cur_len ? data + start : &dummy, &new_len, nullptr) != LZO_E_OK ||
+		    new_len != cur_len)
+			return false;
+		pos += chunk_len;
+	}
+	return pos == in.size();
+}
+
+// dst ^= src, where the shorter of the two is treated as zero-padded
+static void XorBuffer(std::vector<u8>& dst, const std::vector<u8>& src)
+{
+	if (dst.size() < src.size())
+		dst.resize(src.size(), 0);
+
+	const size_t words = src.size() / sizeof(u64);
+	u64* dst_words = reinterpret_cast<u64*>(dst.data());
+	const u64* src_words = reinterpret_cast<const u64*>(src.data());
+	for (size_t i = 0; i < words; ++i)
+		dst_words[i] ^= src_words[i];
+	for (size_t i = words * sizeof(u64); i < src.size(); ++i)
+		dst[i] ^= src[i];
+}
+
+static void XorPage(u8* dst, const u8* src)
+{
+	u64* dst_words = reinterpret_cast<u64*>(dst);
+	const u64* src_words = reinterpret_cast<const u64*>(src);
+	for (size_t i = 0; i < Memory::WATCH_PAGE_SIZE / sizeof(u64); ++i)
+		dst_words[i] ^= src_words[i];
+}
+
+static void RewindThread()
+{
+	Common::SetCurrentThreadName("Rewind thread");
+
+	std::vector<lzo_align_t> wrkmem((LZO1X_1_MEM_COMPRESS + sizeof(lzo_align_t) - 1) / sizeof(lzo_align_t));
+	std::vector<u8> compressed;
+
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lk(g_rewind_mutex);
+			g_rewind_cond.wait(lk, [] { return g_rewind_pending || g_rewind_quit; });
+			if (g_rewind_quit)
+				return;
+		}
+
+		// The CPU thread won't touch the capture or the newest snapshot until
+		// g_rewind_pending is cleared, so the heavy lifting can run unlocked.
+		Memory::FinishSnapshot();
+
+		RewindCapture& capture = g_rewind_capture;
+		const size_t page_size = Memory::WATCH_PAGE_SIZE;
+		if (!capture.pages.empty() && g_rewind_image.size() < (capture.pages.back() + 1) * page_size)
+			g_rewind_image.resize((capture.pages.back() + 1) * page_size, 0);
+
+		RewindEntry entry;
+		const bool has_previous = !g_rewind_state.empty();
+		if (has_previous)
+		{
+			g_rewind_delta = g_rewind_state;
+			XorBuffer(g_rewind_delta, capture.state);
+			CompressChunks(g_rewind_delta.data(), g_rewind_delta.size(), compressed, wrkmem.data());
+			entry.state_size = (u32)g_rewind_state.size();
+			entry.state.assign(compressed.begin(), compressed.end());
+
+			g_rewind_delta.assign(capture.page_data.get(), capture.page_data.get() + capture.pages.size() * page_size);
+			for (size_t i = 0; i < capture.pages.size(); ++i)
+				XorPage(&g_rewind_delta[i * page_size], &g_rewind_image[capture.pages[i] * page_size]);
+			CompressChunks(g_rewind_delta.data(), g_rewind_delta.size(), compressed, wrkmem.data());
+			entry.pages = capture.pages;
+			entry.memory.assign(compressed.begin(), compressed.end());
+		}
+
+		for (size_t i = 0; i < capture.pages.size(); ++i)
+			memcpy(&g_rewind_image[capture.pages[i] * page_size], capture.page_data.get() + i * page_size, page_size);
+		capture.page_data.reset();
+
+		{
+			std::lock_guard<std::mutex> lk(g_rewind_mutex);
+			if (has_previous)
+			{
+				g_rewind_memory += entry.state.size() + entry.pages.size() * sizeof(u32) + entry.memory.size();
+				g_rewind_entries.push_back(std::move(entry));
+			}
+
+			const size_t budget = (size_t)SConfig::GetInstance().m_LocalCoreStartupParameter.iRewindBufferSize * 1024 * 1024;
+			while (!g_rewind_entries.empty() && g_rewind_memory > budget)
+			{
+				const RewindEntry& oldest = g_rewind_entries.front();
+				g_rewind_memory -= oldest.state.size() + oldest.pages.size() * sizeof(u32) + oldest.memory.size();
+				g_rewind_entries.pop_front();
+			}
+
+			g_rewind_state.swap(capture.state);
+			g_rewind_pending = false;
+		}
+		g_rewind_cond.notify_all();
+	}
+}
+
+static void StopRewindThread()
+{
+	if (!g_rewind_thread.joinable())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lk(g_rewind_mutex);
+		g_rewind_quit = true;
+	}
+	g_rewind_cond.notify_all();
+	g_rewind_thread.join();
+
+	// A snapshot the thread didn't get to still points into the capture.
+	Memory::FinishSnapshot();
+
+	g_rewind_entries.clear();
+	g_rewind_memory = 0;
+	g_rewind_pending = false;
+	g_rewind_frame = 0;
+	g_rewind_just_rewound = false;
+	g_rewind_generation = 0;
+	g_rewind_state_time = 0;
+	g_rewind_page_time = 0;
+	g_rewind_over_budget = false;
+	std::vector<u8>().swap(g_rewind_state);
+	std::vector<u8>().swap(g_rewind_image);
+	std::vector<u8>().swap(g_rewind_delta);
+	g_rewind_capture = RewindCapture();
+}
+
+// Core::PauseAndLock without the CPU, for the CPU thread itself.
+static void LockOtherThreads(bool doLock)
+{
+	ExpansionInterface::PauseAndLock(doLock, true);
+	AudioCommon::PauseAndLock(doLock);
+	DSP::GetDSPEmulator()->PauseAndLock(doLock);
+	g_video_backend->PauseAndLock(doLock, true);
+}
+
+void RewindFrameUpdate()
+{
+	const SCoreStartupParameter& params = SConfig::GetInstance().m_LocalCoreStartupParameter;
+	if (!params.bRewind || Movie::IsMovieActive())
+		return;
+
+	if (++g_rewind_frame < (u32)std::max(params.iRewindInterval, 1) || g_rewind_pending)
+		return;
+
+	// This runs on the CPU thread, so every snapshot has to fit the budget by itself. The state
+	// takes about as long as last time and each written page costs its protection; a snapshot
+	// that wouldn't fit is put off until one does.
+	const u64 budget = std::max(params.iRewindBudget, 1);
+	if (g_rewind_state_time)
+	{
+		std::vector<u32> pages;
+		Memory::GetWrittenPages(g_rewind_generation, &pages);
+		const u64 expected = g_rewind_state_time + pages.size() * g_rewind_page_time / 1000;
+		if (expected > budget)
+		{
+			if (!g_rewind_over_budget)
+			{
+				Core::DisplayMessage(StringFromFormat("Rewind snapshot put off: it would take %u us, the budget is %u us",
+					(u32)expected, (u32)budget), 3000);
+				g_rewind_over_budget = true;
+			}
+			return;
+		}
+	}
+	g_rewind_over_budget = false;
+
+	if (!g_rewind_thread.joinable())
+	{
+		g_rewind_quit = false;
+		g_rewind_thread = std::thread(RewindThread);
+	}
+
+	// This is the CPU thread, so the CPU is already where it has to be; pausing it from here
+	// would race with another thread pausing it. Only the threads that run on their own are held.
+	LockOtherThreads(true);
+
+	const u64 start = Common::Timer::GetTimeUs();
+	Memory::BeginDeltaState(Memory::DELTA_WITHOUT_PAGES);
+	SaveToBufferLocked(g_rewind_capture.state);
+	Memory::EndDeltaState();
+	const u64 saved = Common::Timer::GetTimeUs();
+
+	// After the state, so that anything it wrote back to memory is in the pages.
+	g_rewind_generation = Memory::SnapshotWrittenPages(g_rewind_generation, &g_rewind_capture.pages, &g_rewind_capture.page_data);
+	const u64 end = Common::Timer::GetTimeUs();
+
+	LockOtherThreads(false);
+
+	g_rewind_state_time = std::max<u64>(saved - start, 1);
+	if (!g_rewind_capture.pages.empty())
+		g_rewind_page_time = (end - saved) * 1000 / g_rewind_capture.pages.size();
+	if (end - start > budget)
+		WARN_LOG(COMMON, "Rewind snapshot of %u pages took %u us, over the budget of %u us",
+			(u32)g_rewind_capture.pages.size(), (u32)(end - start), (u32)budget);
+	g_rewind_frame = 0;
+	g_rewind_just_rewound = false;
+
+	{
+		std::lock_guard<std::mutex> lk(g_rewind_mutex);
+		g_rewind_pending = true;
+	}
+	g_rewind_cond.notify_all();
+}
+
+// Makes the newest snapshot the one before it.
+static bool StepBackRewindSnapshot()
+{
+	const RewindEntry& entry = g_rewind_entries.back();
+	const size_t page_size = Memory::WATCH_PAGE_SIZE;
+
+	g_rewind_delta.resize(std::max<size_t>(entry.state_size, g_rewind_state.size()));
+	if (!DecompressChunks(entry.state, g_rewind_delta.data(), g_rewind_delta.size()))
+		return false;
+	XorBuffer(g_rewind_state, g_rewind_delta);
+	g_rewind_state.resize(entry.state_size);
+
+	g_rewind_delta.resize(entry.pages.size() * page_size);
+	if (!DecompressChunks(entry.memory, g_rewind_delta.data(), g_rewind_delta.size()))
+		return false;
+	for (size_t i = 0; i < entry.pages.size(); ++i)
+		XorPage(&g_rewind_image[entry.pages[i] * page_size], &g_rewind_delta[i * page_size]);
+	return true;
+}
+
+void Rewind()
+{
+	if (Movie::IsMovieActive())
+	{
+		Core::DisplayMessage("Rewinding is not available while a movie is active", 2000);
+		return;
+	}
+
+	bool wasUnpaused = Core::PauseAndLock(true);
+
+	{
+		std::unique_lock<std::mutex> lk(g_rewind_mutex);
+		g_rewind_cond.wait(lk, [] { return !g_rewind_pending; });
+
+		// If the game ran on since the newest snapshot, go back to that one first. The one that
+		// was rewound to last doesn't count, or rewinding again would only reload it.
+		if ((g_rewind_frame == 0 || g_rewind_just_rewound) && !g_rewind_entries.empty())
+		{
+			if (!StepBackRewindSnapshot())
+			{
+				PanicAlertT("Internal LZO Error - decompression failed");
+				g_rewind_entries.clear();
+				g_rewind_memory = 0;
+				g_rewind_generation = 0;
+				std::vector<u8>().swap(g_rewind_state);
+				std::vector<u8>().swap(g_rewind_image);
+			}
+
+			if (!g_rewind_entries.empty())
+			{
+				const RewindEntry& newest = g_rewind_entries.back();
+				g_rewind_memory -= newest.state.size() + newest.pages.size() * sizeof(u32) + newest.memory.size();
+				g_rewind_entries.pop_back();
+			}
+		}
+
+		if (!g_rewind_state.empty())
+		{
+			Memory::BeginDeltaState(Memory::DELTA_WITHOUT_PAGES);
+			LoadFromBuffer(g_rewind_state);
+			Memory::EndDeltaState();
+			Memory::CopyPagesToEmu(0, g_rewind_image.data(), (u32)(g_rewind_image.size() / Memory::WATCH_PAGE_SIZE));
+
+			// Memory matches the image again, so only what's written from here on is new.
+			g_rewind_generation = Memory::WatchAllPages();
+			g_rewind_frame = 0;
+			g_rewind_just_rewound = true;
+			Core::DisplayMessage(StringFromFormat("Rewound (%u steps left)", (u32)g_rewind_entries.size()), 1000);
+		}
+		else
+		{
+			Core::DisplayMessage("Nothing to rewind", 2000);
+		}
+	}
+
+	Core::PauseAndLock(false, wasUnpaused);
+}
+
 // Load the last state before loading the state
 void UndoLoadState()
 {
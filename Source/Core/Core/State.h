@@ -50,6 +50,21 @@ void SaveToBuffer(std::vector<u8>& buffer);
 void LoadFromBuffer(std::vector<u8>& buffer);
 void VerifyBuffer(std::vector<u8>& buffer);
 
+// Incremental states only store the memory pages written since a delta base was taken,
+// found through Memory's write watch, which keeps frequent rolling snapshots small. Loading
+// a delta needs the base it was taken against; the same base keeps working for any number
+// of deltas, but after a load every page counts as written until a new base is taken.
+void SaveToDeltaBase(std::vector<u8>& base);
+bool SaveToDeltaBuffer(const std::vector<u8>& base, std::vector<u8>& delta);
+bool LoadFromDeltaBuffer(const std::vector<u8>& base, const std::vector<u8>& delta);
+
+// Rewind takes a snapshot every few frames while bRewind is set, keeping as many as
+// fit in the configured amount of memory. Rewind() steps back one snapshot at a time.
+// RewindFrameUpdate is called by the CPU thread once per field; snapshots that would take
+// it longer than iRewindBudget are put off.
+void RewindFrameUpdate();
+void Rewind();
+
 void LoadLastSaved(int i = 1);
 void SaveFirstSaved();
 void UndoSaveState();
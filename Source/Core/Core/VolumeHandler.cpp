@@ -2,8 +2,11 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <vector>
+
 #include "Common/CommonFuncs.h"
 #include "Core/VolumeHandler.h"
+#include "Core/HW/Memmap.h"
 #include "DiscIO/VolumeCreator.h"
 
 namespace VolumeHandler
@@ -84,6 +87,30 @@ bool RAWReadToPtr( u8* ptr, u64 _dwOffset, u64 _dwLength )
 	return false;
 }
 
+bool ReadToEmu(u32 _iRamAddress, u64 _dwOffset, u64 _dwLength)
+{
+	if (g_pVolume != nullptr && Memory::GetPointer(_iRamAddress))
+	{
+		std::vector<u8> buffer(_dwLength);
+		g_pVolume->Read(_dwOffset, _dwLength, buffer.data());
+		Memory::CopyToEmu(_iRamAddress, buffer.data(), buffer.size());
+		return true;
+	}
+	return false;
+}
+
+bool RAWReadToEmu(u32 _iRamAddress, u64 _dwOffset, u64 _dwLength)
+{
+	if (g_pVolume != nullptr && Memory::GetPointer(_iRamAddress))
+	{
+		std::vector<u8> buffer(_dwLength);
+		g_pVolume->RAWRead(_dwOffset, _dwLength, buffer.data());
+		Memory::CopyToEmu(_iRamAddress, buffer.data(), buffer.size());
+		return true;
+	}
+	return false;
+}
+
 bool IsValid()
 {
 	return (g_pVolume != nullptr);
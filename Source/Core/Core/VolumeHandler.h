@@ -22,6 +22,10 @@ void SetVolumeDirectory(const std::string& _rFullPath, bool _bIsWii, const std::
 u32 Read32(u64 _Offset);
 bool ReadToPtr(u8* ptr, u64 _dwOffset, u64 _dwLength);
 bool RAWReadToPtr(u8* ptr, u64 _dwOffset, u64 _dwLength);
+// Reads into emulated memory. Use these rather than ReadToPtr(Memory::GetPointer(...)), see
+// Memory::CopyToEmu.
+bool ReadToEmu(u32 _iRamAddress, u64 _dwOffset, u64 _dwLength);
+bool RAWReadToEmu(u32 _iRamAddress, u64 _dwOffset, u64 _dwLength);
 
 bool IsValid();
 bool IsWii();
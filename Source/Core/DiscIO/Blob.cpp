@@ -2,6 +2,7 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <cstddef>
 #include <cstring>
 #include <string>
@@ -9,6 +10,7 @@
 #include "Common/CDUtils.h"
 #include "Common/CommonTypes.h"
 #include "Common/FileUtil.h"
+#include "Common/Thread.h"
 
 #include "DiscIO/Blob.h"
 #include "DiscIO/CISOBlob.h"
@@ -25,34 +27,144 @@ namespace DiscIO
 
 void SectorReader::SetSectorSize(int blocksize)
 {
-	for (int i = 0; i < CACHE_SIZE; i++)
-	{
-		m_cache[i] = new u8[blocksize];
-		m_cache_tags[i] = (u64)(s64) - 1;
-	}
 	m_blocksize = blocksize;
+	m_cache_capacity = std::max<size_t>(CACHE_SIZE / blocksize, 2);
+	m_read_ahead_blocks = std::max<u64>(READ_AHEAD_SIZE / blocksize, 1);
 }
 
 SectorReader::~SectorReader()
 {
-	for (u8*& block : m_cache)
+	StopReadAhead();
+}
+
+void SectorReader::EnableReadAhead()
+{
+	// Leave one core for the emulator; with a single core, read-ahead would only compete with it
+	const unsigned int cores = std::thread::hardware_concurrency();
+	const unsigned int num_threads = std::min<unsigned int>(cores > 1 ? cores - 1 : 0, MAX_READ_AHEAD_THREADS);
+
+	m_quit = false;
+	for (unsigned int i = 0; i < num_threads; ++i)
+		m_read_ahead_threads.emplace_back(&SectorReader::ReadAheadThread, this);
+}
+
+void SectorReader::StopReadAhead()
+{
 	{
-		delete [] block;
+		std::lock_guard<std::mutex> lk(m_cache_mutex);
+		m_quit = true;
+		m_queue.clear();
+		m_queued.clear();
 	}
+	m_queue_cond.notify_all();
+
+	for (std::thread& thread : m_read_ahead_threads)
+		thread.join();
+	m_read_ahead_threads.clear();
+}
+
+// m_cache_mutex must be held.
+u8* SectorReader::FindCachedBlock(u64 block_num)
+{
+	auto it = m_cache_index.find(block_num);
+	if (it == m_cache_index.end())
+		return nullptr;
+
+	m_cache.splice(m_cache.begin(), m_cache, it->second);
+	return it->second->second.data();
+}
+
+// m_cache_mutex must be held.
+u8* SectorReader::InsertCachedBlock(u64 block_num, std::vector<u8>&& data)
+{
+	// The block handed out by the last GetBlockData call stays put until the next call
+	auto victim = m_cache.end();
+	while (m_cache.size() >= m_cache_capacity && victim != m_cache.begin())
+	{
+		--victim;
+		if (victim->first == m_pinned_block)
+			continue;
+
+		m_cache_index.erase(victim->first);
+		victim = m_cache.erase(victim);
+	}
+
+	m_cache.emplace_front(block_num, std::move(data));
+	m_cache_index[block_num] = m_cache.begin();
+	return m_cache.front().second.data();
 }
 
 const u8 *SectorReader::GetBlockData(u64 block_num)
 {
-	// TODO : Expand usage of the cache to more than one block :P
-	if (m_cache_tags[0] == block_num)
+	std::unique_lock<std::mutex> lk(m_cache_mutex);
+	m_pinned_block = block_num;
+
+	// A read-ahead worker may already be decoding this block
+	m_cache_cond.wait(lk, [&] { return !m_in_flight.count(block_num); });
+
+	if (u8* data = FindCachedBlock(block_num))
+		return data;
+
+	m_in_flight.insert(block_num);
+	lk.unlock();
+
+	std::vector<u8> data(m_blocksize);
+	GetBlock(block_num, data.data());
+
+	lk.lock();
+	m_in_flight.erase(block_num);
+	return InsertCachedBlock(block_num, std::move(data));
+}
+
+void SectorReader::QueueReadAhead(u64 block_num, u64 num_blocks)
+{
+	// Never queue more than the cache can hold, or the blocks would evict each other
+	const u64 total_blocks = (GetDataSize() + m_blocksize - 1) / m_blocksize;
+	if (block_num >= total_blocks)
+		return;
+	num_blocks = std::min<u64>(std::min<u64>(num_blocks, m_cache_capacity / 2), total_blocks - block_num);
+
 	{
-		return m_cache[0];
+		std::lock_guard<std::mutex> lk(m_cache_mutex);
+		for (u64 block = block_num; block < block_num + num_blocks; ++block)
+		{
+			if (m_cache_index.count(block) || m_in_flight.count(block) || m_queued.count(block))
+				continue;
+
+			m_queue.push_back(block);
+			m_queued.insert(block);
+		}
 	}
-	else
+	m_queue_cond.notify_all();
+}
+
+void SectorReader::ReadAheadThread()
+{
+	Common::SetCurrentThreadName("Blob read-ahead");
+
+	std::unique_lock<std::mutex> lk(m_cache_mutex);
+	while (true)
 	{
-		GetBlock(block_num, m_cache[0]);
-		m_cache_tags[0] = block_num;
-		return m_cache[0];
+		m_queue_cond.wait(lk, [&] { return m_quit || !m_queue.empty(); });
+		if (m_quit)
+			return;
+
+		const u64 block_num = m_queue.front();
+		m_queue.pop_front();
+		m_queued.erase(block_num);
+		if (m_cache_index.count(block_num) || m_in_flight.count(block_num))
+			continue;
+
+		m_in_flight.insert(block_num);
+		lk.unlock();
+
+		std::vector<u8> data(m_blocksize);
+		GetBlock(block_num, data.data());
+
+		lk.lock();
+		m_in_flight.erase(block_num);
+		InsertCachedBlock(block_num, std::move(data));
+		m_cache_cond.notify_all();
 	}
 }
 
@@ -61,6 +173,30 @@ bool SectorReader::Read(u64 offset, u64 size, u8* out_ptr)
 	u64 startingBlock = offset / m_blocksize;
 	u64 remain = size;
 
+	if (!m_read_ahead_threads.empty() && size > 0)
+	{
+		// Reads that start where the previous one ended (DVD streaming, mostly) get the
+		// blocks after them decoded in the background. The blocks of this read after the
+		// first one are decoded in parallel while this thread works on the first.
+		const u64 last_block = (offset + size - 1) / m_blocksize;
+		if (startingBlock == m_next_sequential_block || startingBlock + 1 == m_next_sequential_block)
+		{
+			m_sequential_reads++;
+		}
+		else
+		{
+			m_sequential_reads = 0;
+			std::lock_guard<std::mutex> lk(m_cache_mutex);
+			m_queue.clear();
+			m_queued.clear();
+		}
+		m_next_sequential_block = last_block + 1;
+
+		const u64 num_blocks = last_block - startingBlock + (m_sequential_reads >= 2 ? m_read_ahead_blocks : 0);
+		if (num_blocks)
+			QueueReadAhead(startingBlock + 1, num_blocks);
+	}
+
 	int positionInBlock = (int)(offset % m_blocksize);
 	u64 block = startingBlock;
 
@@ -14,7 +14,16 @@
 // detect whether the file is a compressed blob, or just a big hunk of data, or a drive, and
 // automatically do the right thing.
 
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
 #include "Common/CommonTypes.h"
 
 namespace DiscIO
@@ -37,8 +46,9 @@ protected:
 
 // Provides caching and split-operation-to-block-operations facilities.
 // Used for compressed blob reading and direct drive reading.
-// Currently only uses a single entry cache.
-// Multi-block reads are not cached.
+// Blocks are kept in an LRU cache of CACHE_SIZE bytes. Readers whose GetBlock can run on
+// several threads at once can enable read-ahead, which decodes the blocks of large reads
+// and the blocks following sequential reads on a pool of worker threads.
 class SectorReader : public IBlobReader
 {
 public:
@@ -51,16 +61,47 @@ public:
 
 protected:
 	void SetSectorSize(int blocksize);
+	// Only for readers whose GetBlock is thread-safe.
+	void EnableReadAhead();
+	// Readers that enabled read-ahead must call this first thing in their destructor,
+	// so that no worker is left calling GetBlock on a half-destroyed object.
+	void StopReadAhead();
 	virtual void GetBlock(u64 block_num, u8 *out) = 0;
-	// This one is uncached. The default implementation is to simply call GetBlockData multiple times and memcpy.
+	// The default implementation is to simply call GetBlockData multiple times and memcpy.
 	virtual bool ReadMultipleAlignedBlocks(u64 block_num, u64 num_blocks, u8 *out_ptr);
 
 private:
-	enum { CACHE_SIZE = 32 };
-	int m_blocksize;
-	u8* m_cache[CACHE_SIZE];
-	u64 m_cache_tags[CACHE_SIZE];
-	int m_cache_age[CACHE_SIZE];
+	enum
+	{
+		CACHE_SIZE = 32 * 1024 * 1024,
+		READ_AHEAD_SIZE = 1024 * 1024,
+		MAX_READ_AHEAD_THREADS = 4,
+	};
+
+	typedef std::list<std::pair<u64, std::vector<u8>>> CacheList;
+
+	u8* FindCachedBlock(u64 block_num);
+	u8* InsertCachedBlock(u64 block_num, std::vector<u8>&& data);
+	void QueueReadAhead(u64 block_num, u64 num_blocks);
+	void ReadAheadThread();
+
+	int m_blocksize = 0;
+	size_t m_cache_capacity = 0;
+	CacheList m_cache;
+	std::unordered_map<u64, CacheList::iterator> m_cache_index;
+	std::unordered_set<u64> m_in_flight;
+	u64 m_pinned_block = (u64)-1;
+	std::mutex m_cache_mutex;
+	std::condition_variable m_cache_cond;
+
+	u64 m_next_sequential_block = (u64)-1;
+	int m_sequential_reads = 0;
+	u64 m_read_ahead_blocks = 0;
+	std::deque<u64> m_queue;
+	std::unordered_set<u64> m_queued;
+	std::condition_variable m_queue_cond;
+	std::vector<std::thread> m_read_ahead_threads;
+	bool m_quit = false;
 };
 
 // Factory function - examines the path to choose the right type of IBlobReader, and returns one.
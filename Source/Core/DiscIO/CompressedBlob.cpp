@@ -49,8 +49,9 @@ CompressedBlobReader::CompressedBlobReader(const std::string& filename) : m_file
 	// A compressed block is never ever longer than a decompressed block, so just header.block_size should be fine.
 	// I still add some safety margin.
 	m_zlib_buffer_size = m_header.block_size + 64;
-	m_zlib_buffer = new u8[m_zlib_buffer_size];
-	memset(m_zlib_buffer, 0, m_zlib_buffer_size);
+
+	// GetBlock only holds m_file_lock while reading, so blocks can be inflated in parallel
+	EnableReadAhead();
 }
 
 CompressedBlobReader* CompressedBlobReader::Create(const std::string& filename)
@@ -63,7 +64,7 @@ CompressedBlobReader* CompressedBlobReader::Create(const std::string& filename)
 
 CompressedBlobReader::~CompressedBlobReader()
 {
-	delete [] m_zlib_buffer;
+	StopReadAhead();
 	delete [] m_block_pointers;
 	delete [] m_hashes;
 }
@@ -95,13 +96,16 @@ void CompressedBlobReader::GetBlock(u64 block_num, u8 *out_ptr)
 		offset &= ~(1ULL << 63);
 	}
 
-	// clear unused part of zlib buffer. maybe this can be deleted when it works fully.
-	memset(m_zlib_buffer + comp_block_size, 0, m_zlib_buffer_size - comp_block_size);
+	// This may run on several read-ahead threads at once, so every call gets its own buffer
+	std::vector<u8> zlib_buffer(m_zlib_buffer_size);
 
-	m_file.Seek(offset, SEEK_SET);
-	m_file.ReadBytes(m_zlib_buffer, comp_block_size);
+	{
+		std::lock_guard<std::mutex> lk(m_file_lock);
+		m_file.Seek(offset, SEEK_SET);
+		m_file.ReadBytes(zlib_buffer.data(), comp_block_size);
+	}
 
-	u8* source = m_zlib_buffer;
+	u8* source = zlib_buffer.data();
 	u8* dest = out_ptr;
 
 	// First, check hash.
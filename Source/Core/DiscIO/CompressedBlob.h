@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include <mutex>
 #include <string>
 
 #include "Common/CommonTypes.h"
@@ -61,8 +62,8 @@ private:
 	u32* m_hashes;
 	int m_data_offset;
 	File::IOFile m_file;
+	std::mutex m_file_lock;
 	u64 m_file_size;
-	u8* m_zlib_buffer;
 	int m_zlib_buffer_size;
 	std::string m_file_name;
 };
@@ -11,6 +11,7 @@
 
 #include "Common/CommonFuncs.h"
 #include "Common/CommonTypes.h"
+#include "Common/CPUDetect.h"
 #include "Common/MsgHandler.h"
 #include "Common/Logging/Log.h"
 #include "DiscIO/Blob.h"
@@ -19,26 +20,88 @@
 #include "DiscIO/VolumeGC.h"
 #include "DiscIO/VolumeWiiCrypted.h"
 
+#if _M_X86_64
+#include <wmmintrin.h>
+#endif
+
 namespace DiscIO
 {
 
+#if _M_X86_64
+// CBC decryption doesn't chain like encryption does, so AES-NI can keep four blocks in
+// flight at once. The round keys are the ones PolarSSL expands with aes_setkey_dec,
+// which are laid out for AESDEC whether or not PolarSSL uses AES-NI itself.
+#ifdef __GNUC__
+__attribute__((__target__("aes")))
+#endif
+static void DecryptCBC_AESNI(const aes_context* ctx, const u8* iv, const u8* in, u8* out, size_t size)
+{
+	const int rounds = ctx->nr;
+	__m128i keys[15];
+	for (int i = 0; i <= rounds; ++i)
+		keys[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctx->rk) + i);
+
+	__m128i prev = _mm_loadu_si128(reinterpret_cast<const __m128i*>(iv));
+	const __m128i* src = reinterpret_cast<const __m128i*>(in);
+	__m128i* dst = reinterpret_cast<__m128i*>(out);
+	size_t blocks = size / 16;
+
+	for (; blocks >= 4; blocks -= 4, src += 4, dst += 4)
+	{
+		const __m128i c0 = _mm_loadu_si128(src + 0);
+		const __m128i c1 = _mm_loadu_si128(src + 1);
+		const __m128i c2 = _mm_loadu_si128(src + 2);
+		const __m128i c3 = _mm_loadu_si128(src + 3);
+		__m128i b0 = _mm_xor_si128(c0, keys[0]);
+		__m128i b1 = _mm_xor_si128(c1, keys[0]);
+		__m128i b2 = _mm_xor_si128(c2, keys[0]);
+		__m128i b3 = _mm_xor_si128(c3, keys[0]);
+		for (int i = 1; i < rounds; ++i)
+		{
+			b0 = _mm_aesdec_si128(b0, keys[i]);
+			b1 = _mm_aesdec_si128(b1, keys[i]);
+			b2 = _mm_aesdec_si128(b2, keys[i]);
+			b3 = _mm_aesdec_si128(b3, keys[i]);
+		}
+		b0 = _mm_aesdeclast_si128(b0, keys[rounds]);
+		b1 = _mm_aesdeclast_si128(b1, keys[rounds]);
+		b2 = _mm_aesdeclast_si128(b2, keys[rounds]);
+		b3 = _mm_aesdeclast_si128(b3, keys[rounds]);
+		_mm_storeu_si128(dst + 0, _mm_xor_si128(b0, prev));
+		_mm_storeu_si128(dst + 1, _mm_xor_si128(b1, c0));
+		_mm_storeu_si128(dst + 2, _mm_xor_si128(b2, c1));
+		_mm_storeu_si128(dst + 3, _mm_xor_si128(b3, c2));
+		prev = c3;
+	}
+
+	for (; blocks > 0; --blocks, ++src, ++dst)
+	{
+		const __m128i c = _mm_loadu_si128(src);
+		__m128i b = _mm_xor_si128(c, keys[0]);
+		for (int i = 1; i < rounds; ++i)
+			b = _mm_aesdec_si128(b, keys[i]);
+		b = _mm_aesdeclast_si128(b, keys[rounds]);
+		_mm_storeu_si128(dst, _mm_xor_si128(b, prev));
+		prev = c;
+	}
+}
+#endif
+
 CVolumeWiiCrypted::CVolumeWiiCrypted(IBlobReader* _pReader, u64 _VolumeOffset,
 									 const unsigned char* _pVolumeKey)
 	: m_pReader(_pReader),
 	m_AES_ctx(new aes_context),
-	m_pBuffer(nullptr),
 	m_VolumeOffset(_VolumeOffset),
-	m_dataOffset(0x20000),
-	m_LastDecryptedBlockOffset(-1)
+	m_dataOffset(0x20000)
 {
 	aes_setkey_dec(m_AES_ctx.get(), _pVolumeKey, 128);
-	m_pBuffer = new u8[0x8000];
 }
 
 bool CVolumeWiiCrypted::ChangePartition(u64 offset)
 {
 	m_VolumeOffset = offset;
-	m_LastDecryptedBlockOffset = -1;
+	m_cluster_cache.clear();
+	m_cluster_cache_index.clear();
 
 	u8 volume_key[16];
 	DiscIO::VolumeKeyForParition(*m_pReader, offset, volume_key);
@@ -49,8 +112,6 @@ bool CVolumeWiiCrypted::ChangePartition(u64 offset)
 
 CVolumeWiiCrypted::~CVolumeWiiCrypted()
 {
-	delete[] m_pBuffer;
-	m_pBuffer = nullptr;
 }
 
 bool CVolumeWiiCrypted::RAWRead( u64 _Offset, u64 _Length, u8* _pBuffer ) const
@@ -64,6 +125,64 @@ bool CVolumeWiiCrypted::RAWRead( u64 _Offset, u64 _Length, u8* _pBuffer ) const
 		return true;
 }
 
+void CVolumeWiiCrypted::DecryptCBC(const u8* iv, const u8* in, u8* out, size_t size) const
+{
+#if _M_X86_64
+	if (cpu_info.bAES)
+	{
+		DecryptCBC_AESNI(m_AES_ctx.get(), iv, in, out, size);
+		return;
+	}
+#endif
+
+	unsigned char IV[16];
+	memcpy(IV, iv, 16);
+	aes_crypt_cbc(m_AES_ctx.get(), AES_DECRYPT, size, IV, in, out);
+}
+
+u8* CVolumeWiiCrypted::FindCachedCluster(u64 cluster) const
+{
+	auto it = m_cluster_cache_index.find(cluster);
+	if (it == m_cluster_cache_index.end())
+		return nullptr;
+
+	m_cluster_cache.splice(m_cluster_cache.begin(), m_cluster_cache, it->second);
+	return it->second->second.get();
+}
+
+// Reads a run of clusters with a single blob read and decrypts them into the cache.
+bool CVolumeWiiCrypted::DecryptClusters(u64 first_cluster, u64 num_clusters) const
+{
+	m_pBuffer.resize((size_t)num_clusters * CLUSTER_SIZE);
+	if (!m_pReader->Read(m_VolumeOffset + m_dataOffset + first_cluster * CLUSTER_SIZE,
+	                     num_clusters * CLUSTER_SIZE, m_pBuffer.data()))
+		return false;
+
+	for (u64 i = 0; i < num_clusters; ++i)
+	{
+		std::unique_ptr<u8[]> decrypted;
+		if (m_cluster_cache.size() >= CLUSTER_CACHE_SIZE)
+		{
+			// Recycle the least recently used cluster's buffer
+			decrypted = std::move(m_cluster_cache.back().second);
+			m_cluster_cache_index.erase(m_cluster_cache.back().first);
+			m_cluster_cache.pop_back();
+		}
+		else
+		{
+			decrypted.reset(new u8[CLUSTER_DATA_SIZE]);
+		}
+
+		const u8* encrypted = &m_pBuffer[(size_t)i * CLUSTER_SIZE];
+		DecryptCBC(encrypted + 0x3d0, encrypted + CLUSTER_DATA_OFFSET, decrypted.get(), CLUSTER_DATA_SIZE);
+
+		m_cluster_cache.emplace_front(first_cluster + i, std::move(decrypted));
+		m_cluster_cache_index[first_cluster + i] = m_cluster_cache.begin();
+	}
+
+	return true;
+}
+
 bool CVolumeWiiCrypted::Read(u64 _ReadOffset, u64 _Length, u8* _pBuffer) const
 {
 	if (m_pReader == nullptr)
@@ -71,28 +190,29 @@ bool CVolumeWiiCrypted::Read(u64 _ReadOffset, u64 _Length, u8* _pBuffer) const
 
 	while (_Length > 0)
 	{
-		static unsigned char IV[16];
-
 		// math block offset
-		u64 Block  = _ReadOffset / 0x7C00;
-		u64 Offset = _ReadOffset % 0x7C00;
+		u64 Block  = _ReadOffset / CLUSTER_DATA_SIZE;
+		u64 Offset = _ReadOffset % CLUSTER_DATA_SIZE;
 
-		// read current block
-		if (!m_pReader->Read(m_VolumeOffset + m_dataOffset + Block * 0x8000, 0x8000, m_pBuffer))
-			return(false);
-
-		if (m_LastDecryptedBlockOffset != Block)
+		const u8* decrypted = FindCachedCluster(Block);
+		if (!decrypted)
 		{
-			memcpy(IV, m_pBuffer + 0x3d0, 16);
-			aes_crypt_cbc(m_AES_ctx.get(), AES_DECRYPT, 0x7C00, IV, m_pBuffer + 0x400, m_LastDecryptedBlock);
-
-			m_LastDecryptedBlockOffset = Block;
+			// Batch up every cluster of this read that isn't cached yet and follows this one
+			const u64 LastBlock = (_ReadOffset + _Length - 1) / CLUSTER_DATA_SIZE;
+			u64 NumBlocks = 1;
+			while (Block + NumBlocks <= LastBlock && NumBlocks < MAX_CLUSTER_BATCH &&
+			       !m_cluster_cache_index.count(Block + NumBlocks))
+				NumBlocks++;
+
+			if (!DecryptClusters(Block, NumBlocks))
+				return(false);
+			decrypted = FindCachedCluster(Block);
 		}
 
-		// copy the encrypted data
-		u64 MaxSizeToCopy = 0x7C00 - Offset;
+		// copy the decrypted data
+		u64 MaxSizeToCopy = CLUSTER_DATA_SIZE - Offset;
 		u64 CopySize = (_Length > MaxSizeToCopy) ? MaxSizeToCopy : _Length;
-		memcpy(_pBuffer, &m_LastDecryptedBlock[Offset], (size_t)CopySize);
+		memcpy(_pBuffer, decrypted + Offset, (size_t)CopySize);
 
 		// increase buffers
 		_Length -= CopySize;
@@ -4,8 +4,10 @@
 
 #pragma once
 
+#include <list>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <polarssl/aes.h>
 
@@ -44,16 +46,33 @@ public:
 	bool ChangePartition(u64 offset) override;
 
 private:
+	enum
+	{
+		CLUSTER_SIZE = 0x8000,
+		CLUSTER_DATA_OFFSET = 0x400,
+		CLUSTER_DATA_SIZE = CLUSTER_SIZE - CLUSTER_DATA_OFFSET,
+		// Decrypted clusters kept around, 2 MiB worth
+		CLUSTER_CACHE_SIZE = 64,
+		// Most clusters read and decrypted in one go by a single Read call
+		MAX_CLUSTER_BATCH = 32,
+	};
+
+	typedef std::list<std::pair<u64, std::unique_ptr<u8[]>>> ClusterList;
+
+	u8* FindCachedCluster(u64 cluster) const;
+	bool DecryptClusters(u64 first_cluster, u64 num_clusters) const;
+	void DecryptCBC(const u8* iv, const u8* in, u8* out, size_t size) const;
+
 	std::unique_ptr<IBlobReader> m_pReader;
 	std::unique_ptr<aes_context> m_AES_ctx;
 
-	u8* m_pBuffer;
+	mutable std::vector<u8> m_pBuffer;
 
 	u64 m_VolumeOffset;
 	u64 m_dataOffset;
 
-	mutable u64 m_LastDecryptedBlockOffset;
-	mutable unsigned char m_LastDecryptedBlock[0x8000];
+	mutable ClusterList m_cluster_cache;
+	mutable std::unordered_map<u64, ClusterList::iterator> m_cluster_cache_index;
 };
 
 } // namespace
@@ -170,8 +170,10 @@ void CCodeWindow::CreateMenuSymbols(wxMenuBar *pMenuBar)
 
 	wxMenu *pProfilerMenu = new wxMenu;
 	pProfilerMenu->Append(IDM_PROFILEBLOCKS, _("&Profile blocks"), wxEmptyString, wxITEM_CHECK);
+	pProfilerMenu->Append(IDM_SAMPLEFUNCTIONS, _("&Sample guest functions"), wxEmptyString, wxITEM_CHECK);
 	pProfilerMenu->AppendSeparator();
 	pProfilerMenu->Append(IDM_WRITEPROFILE, _("&Write to profile.txt, show"));
+	pProfilerMenu->Append(IDM_WRITEFLAMEGRAPH, _("Write samples as &flame graph stacks"));
 	pMenuBar->Append(pProfilerMenu, _("&Profiler"));
 }
 
@@ -186,6 +188,25 @@ void CCodeWindow::OnProfilerMenu(wxCommandEvent& event)
 		Profiler::g_ProfileBlocks = GetMenuBar()->IsChecked(IDM_PROFILEBLOCKS);
 		Core::SetState(Core::CORE_RUN);
 		break;
+	case IDM_SAMPLEFUNCTIONS:
+		Core::SetState(Core::CORE_PAUSE);
+		if (GetMenuBar()->IsChecked(IDM_SAMPLEFUNCTIONS))
+			Profiler::StartSampling();
+		else
+			Profiler::StopSampling();
+		// Recompile so that the blocks count their entries, or stop doing so.
+		if (jit != nullptr)
+			jit->ClearCache();
+		Core::SetState(Core::CORE_RUN);
+		break;
+	case IDM_WRITEFLAMEGRAPH:
+		{
+			std::string filename = File::GetUserPath(D_DUMP_IDX) + "Debug/guest_profile.folded";
+			File::CreateFullPath(filename);
+			Profiler::WriteFlameGraph(filename);
+			Core::DisplayMessage("Wrote " + filename, 3000);
+		}
+		break;
 	case IDM_WRITEPROFILE:
 		if (Core::GetState() == Core::CORE_RUN)
 			Core::SetState(Core::CORE_PAUSE);
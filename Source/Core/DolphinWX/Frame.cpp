@@ -299,6 +299,7 @@ EVT_MENU(IDM_PURGECACHE, CFrame::GameListChanged)
 EVT_MENU(IDM_SAVEFIRSTSTATE, CFrame::OnSaveFirstState)
 EVT_MENU(IDM_UNDOLOADSTATE,     CFrame::OnUndoLoadState)
 EVT_MENU(IDM_UNDOSAVESTATE,     CFrame::OnUndoSaveState)
+EVT_MENU(IDM_REWIND,            CFrame::OnRewind)
 EVT_MENU(IDM_LOADSTATEFILE, CFrame::OnLoadStateFromFile)
 EVT_MENU(IDM_SAVESTATEFILE, CFrame::OnSaveStateToFile)
 EVT_MENU(IDM_SAVESELECTEDSLOT, CFrame::OnSaveCurrentSlot)
@@ -970,6 +971,7 @@ int GetCmdForHotkey(unsigned int key)
 	case HK_UNDO_SAVE_STATE: return IDM_UNDOSAVESTATE;
 	case HK_LOAD_STATE_FILE: return IDM_LOADSTATEFILE;
 	case HK_SAVE_STATE_FILE: return IDM_SAVESTATEFILE;
+	case HK_REWIND: return IDM_REWIND;
 
 	case HK_SELECT_STATE_SLOT_1: return IDM_SELECTSLOT1;
 	case HK_SELECT_STATE_SLOT_2: return IDM_SELECTSLOT2;
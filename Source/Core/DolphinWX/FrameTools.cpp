@@ -193,6 +193,7 @@ wxMenuBar* CFrame::CreateMenu()
 	loadMenu->Append(IDM_LOADSTATEFILE,  GetMenuLabel(HK_LOAD_STATE_FILE));
 	loadMenu->Append(IDM_LOADSELECTEDSLOT, GetMenuLabel(HK_LOAD_STATE_SLOT_SELECTED));
 	loadMenu->Append(IDM_UNDOLOADSTATE, GetMenuLabel(HK_UNDO_LOAD_STATE));
+	loadMenu->Append(IDM_REWIND, GetMenuLabel(HK_REWIND));
 	loadMenu->AppendSeparator();
 
 	for (unsigned int i = 1; i <= State::NUM_STATES; i++)
@@ -515,6 +516,7 @@ wxString CFrame::GetMenuLabel(int Id)
 		case HK_SAVE_FIRST_STATE: Label = _("Save Oldest State"); break;
 		case HK_UNDO_LOAD_STATE:  Label = _("Undo Load State");   break;
 		case HK_UNDO_SAVE_STATE:  Label = _("Undo Save State");   break;
+		case HK_REWIND:           Label = _("Rewind");            break;
 
 		case HK_SAVE_STATE_SLOT_SELECTED:
 			Label = _("Save state to selected slot");
@@ -1750,6 +1752,12 @@ void CFrame::OnUndoSaveState(wxCommandEvent& WXUNUSED (event))
 		State::UndoSaveState();
 }
 
+void CFrame::OnRewind(wxCommandEvent& WXUNUSED (event))
+{
+	if (Core::IsRunningAndStarted())
+		State::Rewind();
+}
+
 
 void CFrame::OnLoadState(wxCommandEvent& event)
 {
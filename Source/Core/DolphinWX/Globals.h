@@ -29,6 +29,7 @@ enum
 	IDM_SAVEFIRSTSTATE,
 	IDM_UNDOLOADSTATE,
 	IDM_UNDOSAVESTATE,
+	IDM_REWIND,
 	IDM_LOADSTATEFILE,
 	IDM_SAVESTATEFILE,
 	IDM_SAVESLOT1,
@@ -229,6 +230,8 @@ enum
 
 	// Profiler
 	IDM_PROFILEBLOCKS,
+	IDM_SAMPLEFUNCTIONS,
+	IDM_WRITEFLAMEGRAPH,
 	IDM_WRITEPROFILE,
 	// --------------------------------------------------------------
 
@@ -35,6 +35,24 @@ void ReplaceRGBATexture2D(ID3D11Texture2D* pTexture, const u8* buffer, unsigned
 	}
 }
 
+void ReplaceDXT1Texture2D(ID3D11Texture2D* pTexture, const u8* buffer, unsigned int width, unsigned int height, unsigned int level, D3D11_USAGE usage)
+{
+	const unsigned int row_pitch = ((width + 3) / 4) * 8;
+	const unsigned int rows = (height + 3) / 4;
+	if (usage == D3D11_USAGE_DYNAMIC || usage == D3D11_USAGE_STAGING)
+	{
+		D3D11_MAPPED_SUBRESOURCE map;
+		D3D::context->Map(pTexture, level, D3D11_MAP_WRITE_DISCARD, 0, &map);
+		for (unsigned int y = 0; y < rows; ++y)
+			memcpy((u8*)map.pData + y * map.RowPitch, buffer + y * row_pitch, row_pitch);
+		D3D::context->Unmap(pTexture, level);
+	}
+	else
+	{
+		D3D::context->UpdateSubresource(pTexture, level, nullptr, buffer, row_pitch, row_pitch * rows);
+	}
+}
+
 }  // namespace
 
 D3DTexture2D* D3DTexture2D::Create(unsigned int width, unsigned int height, D3D11_BIND_FLAG bind, D3D11_USAGE usage, DXGI_FORMAT fmt, unsigned int levels)
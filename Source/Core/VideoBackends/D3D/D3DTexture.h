@@ -12,6 +12,8 @@ namespace DX11
 namespace D3D
 {
 	void ReplaceRGBATexture2D(ID3D11Texture2D* pTexture, const u8* buffer, unsigned int width, unsigned int height, unsigned int pitch, unsigned int level, D3D11_USAGE usage);
+	// buffer holds tightly packed rows of 4x4 blocks
+	void ReplaceDXT1Texture2D(ID3D11Texture2D* pTexture, const u8* buffer, unsigned int width, unsigned int height, unsigned int level, D3D11_USAGE usage);
 }
 
 class D3DTexture2D
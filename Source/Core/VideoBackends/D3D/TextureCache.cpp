@@ -76,7 +76,10 @@ bool TextureCache::TCacheEntry::Save(const std::string& filename, unsigned int l
 void TextureCache::TCacheEntry::Load(unsigned int width, unsigned int height,
 	unsigned int expanded_width, unsigned int level)
 {
-	D3D::ReplaceRGBATexture2D(texture->GetTex(), TextureCache::temp, width, height, expanded_width, level, usage);
+	if (pcfmt == PC_TEX_FMT_DXT1)
+		D3D::ReplaceDXT1Texture2D(texture->GetTex(), TextureCache::temp, width, height, level, usage);
+	else
+		D3D::ReplaceRGBATexture2D(texture->GetTex(), TextureCache::temp, width, height, expanded_width, level, usage);
 }
 
 TextureCache::TCacheEntryBase* TextureCache::CreateTexture(unsigned int width,
@@ -93,12 +96,14 @@ TextureCache::TCacheEntryBase* TextureCache::CreateTexture(unsigned int width,
 		cpu_access = D3D11_CPU_ACCESS_WRITE;
 
 		srdata.pSysMem = TextureCache::temp;
-		srdata.SysMemPitch = 4 * expanded_width;
+		// DXT1 rows are rows of 4x4 blocks, packed for width.
+		srdata.SysMemPitch = (pcfmt == PC_TEX_FMT_DXT1) ? ((width + 3) / 4) * 8 : 4 * expanded_width;
 
 		data = &srdata;
 	}
 
-	const D3D11_TEXTURE2D_DESC texdesc = CD3D11_TEXTURE2D_DESC(DXGI_FORMAT_R8G8B8A8_UNORM,
+	const DXGI_FORMAT format = (pcfmt == PC_TEX_FMT_DXT1) ? DXGI_FORMAT_BC1_UNORM : DXGI_FORMAT_R8G8B8A8_UNORM;
+	const D3D11_TEXTURE2D_DESC texdesc = CD3D11_TEXTURE2D_DESC(format,
 		width, height, 1, tex_levels, D3D11_BIND_SHADER_RESOURCE, usage, cpu_access);
 
 	ID3D11Texture2D *pTexture;
@@ -107,6 +112,7 @@ TextureCache::TCacheEntryBase* TextureCache::CreateTexture(unsigned int width,
 
 	TCacheEntry* const entry = new TCacheEntry(new D3DTexture2D(pTexture, D3D11_BIND_SHADER_RESOURCE));
 	entry->usage = usage;
+	entry->pcfmt = pcfmt;
 
 	// TODO: better debug names
 	D3D::SetDebugObjectName((ID3D11DeviceChild*)entry->texture->GetTex(), "a texture of the TextureCache");
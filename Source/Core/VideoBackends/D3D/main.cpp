@@ -80,6 +80,7 @@ void InitBackendInfo()
 	g_Config.backend_info.bSupportsOversizedViewports = false;
 	g_Config.backend_info.bSupportsBBox = false; // TODO: not implemented
 	g_Config.backend_info.bSupportsStereoscopy = false; // TODO: not implemented
+	g_Config.backend_info.bSupportsDXT1Textures = true;
 
 	IDXGIFactory* factory;
 	IDXGIAdapter* ad;
@@ -186,11 +186,11 @@ TextureCache::TCacheEntryBase* TextureCache::CreateTexture(unsigned int width,
 void TextureCache::TCacheEntry::Load(unsigned int width, unsigned int height,
 	unsigned int expanded_width, unsigned int level)
 {
+	glActiveTexture(GL_TEXTURE0+9);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+
 	if (pcfmt != PC_TEX_FMT_DXT1)
 	{
-		glActiveTexture(GL_TEXTURE0+9);
-		glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
-
 		if (expanded_width != width)
 			glPixelStorei(GL_UNPACK_ROW_LENGTH, expanded_width);
 
@@ -201,9 +201,9 @@ void TextureCache::TCacheEntry::Load(unsigned int width, unsigned int height,
 	}
 	else
 	{
-		PanicAlert("PC_TEX_FMT_DXT1 support disabled");
-		//glCompressedTexImage2D(GL_TEXTURE_2D, 0, GL_COMPRESSED_RGBA_S3TC_DXT1_EXT,
-			//width, height, 0, expanded_width * expanded_height/2, temp);
+		// TexDecoder_DecodeCMPRAsDXT1 packs the blocks for width, not expanded_width.
+		GLsizei size = ((width + 3) / 4) * ((height + 3) / 4) * 8;
+		glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_COMPRESSED_RGBA_S3TC_DXT1_EXT, width, height, 1, 0, size, temp);
 	}
 	TextureCache::SetStage();
 }
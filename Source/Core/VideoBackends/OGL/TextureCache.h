@@ -27,8 +27,6 @@ private:
 		GLuint texture;
 		GLuint framebuffer;
 
-		PC_TexFormat pcfmt;
-
 		int gl_format;
 		int gl_iformat;
 		int gl_type;
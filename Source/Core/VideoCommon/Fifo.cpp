@@ -2,10 +2,12 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <algorithm>
+
 #include "Common/Atomic.h"
 #include "Common/ChunkFile.h"
 #include "Common/FPURoundMode.h"
-#include "Common/MemoryUtil.h"
+#include "Common/MemArena.h"
 #include "Common/Thread.h"
 
 #include "Core/ConfigManager.h"
@@ -25,6 +27,10 @@
 
 bool g_bSkipCurrentFrame = false;
 
+// Upper bound for how much RunGpuLoop reads from the FIFO at once in batched
+// mode, so async requests from the CPU thread don't wait too long.
+static const u32 FIFO_BATCH_SIZE = 64 * 1024;
+
 static volatile bool GpuRunningState = false;
 static volatile bool EmuRunningState = false;
 static std::mutex m_csHWVidOccupied;
@@ -39,11 +45,20 @@ bool g_use_deterministic_gpu_thread;
 // STATE_TO_SAVE
 static std::mutex s_video_buffer_lock;
 static std::condition_variable s_video_buffer_cond;
+static MemArena s_video_buffer_arena;
 static u8* s_video_buffer;
 u8* g_video_buffer_read_ptr;
 static std::atomic<u8*> s_video_buffer_write_ptr;
 static std::atomic<u8*> s_video_buffer_seen_ptr;
+static std::atomic<u8*> s_video_buffer_gpu_read_ptr;
 u8* g_video_buffer_pp_read_ptr;
+// s_video_buffer is a ring: the FIFO_SIZE bytes after it are a second mapping
+// of the same memory, so a command which straddles the end can still be
+// decoded in place.  All pointers are kept in [s_video_buffer, s_video_buffer
+// + FIFO_SIZE); readers decode up to VideoBufferLinearEnd() and wrap their
+// pointer afterwards.  The ring is empty when read and write pointers are
+// equal, so it never gets completely filled.
+//
 // The read_ptr is always owned by the GPU thread.  In normal mode, so is the
 // write_ptr, despite it being atomic.  In g_use_deterministic_gpu_thread mode,
 // things get a bit more complicated:
@@ -51,11 +66,39 @@ u8* g_video_buffer_pp_read_ptr;
 // processed as much of as possible - in the case of a partial command which
 // caused it to stop, not the same as the read ptr.  It's written by the GPU,
 // under the lock, and updating the cond.
+// - The gpu_read_ptr is the GPU's read_ptr as of the last time it stopped.
+// The CPU thread uses it to find out how much space is free, so it only has to
+// wait for the GPU when the ring is actually full.
 // - The write_ptr is written by the CPU thread after it copies data from the
 // FIFO.  Maybe someday it will be under the lock.  For now, because RunGpuLoop
 // polls, it's just atomic.
 // - The pp_read_ptr is the CPU preprocessing version of the read_ptr.
 
+static u8* WrapVideoBufferPtr(u8* ptr)
+{
+	return ptr >= s_video_buffer + FIFO_SIZE ? ptr - FIFO_SIZE : ptr;
+}
+
+// Returns the pointer up to which a reader at read_ptr can decode contiguously,
+// which is in the mirror if the writer has already wrapped around.
+static u8* VideoBufferLinearEnd(u8* read_ptr, u8* write_ptr)
+{
+	return write_ptr < read_ptr ? write_ptr + FIFO_SIZE : write_ptr;
+}
+
+static size_t VideoBufferUsed(u8* read_ptr, u8* write_ptr)
+{
+	return VideoBufferLinearEnd(read_ptr, write_ptr) - read_ptr;
+}
+
+// Runs the opcode decoder over everything the GPU hasn't read yet.
+static u32 RunVideoBuffer(u8* write_ptr)
+{
+	u32 cycles = OpcodeDecoder_Run(VideoBufferLinearEnd(g_video_buffer_read_ptr, write_ptr), false);
+	g_video_buffer_read_ptr = WrapVideoBufferPtr(g_video_buffer_read_ptr);
+	return cycles;
+}
+
 void Fifo_DoState(PointerWrap &p)
 {
 	p.DoArray(s_video_buffer, FIFO_SIZE);
@@ -67,6 +110,7 @@ void Fifo_DoState(PointerWrap &p)
 	{
 		// We're good and paused, right?
 		s_video_buffer_seen_ptr = g_video_buffer_pp_read_ptr = g_video_buffer_read_ptr;
+		s_video_buffer_gpu_read_ptr = g_video_buffer_read_ptr;
 	}
 	p.Do(g_bSkipCurrentFrame);
 }
@@ -93,7 +137,10 @@ void Fifo_PauseAndLock(bool doLock, bool unpauseOnUnlock)
 
 void Fifo_Init()
 {
-	s_video_buffer = (u8*)AllocateMemoryPages(FIFO_SIZE);
+	s_video_buffer_arena.GrabSHMSegment(FIFO_SIZE);
+	s_video_buffer = s_video_buffer_arena.CreateMirroredView(0, FIFO_SIZE);
+	if (!s_video_buffer)
+		PanicAlert("Failed to map the video buffer");
 	ResetVideoBuffer();
 	GpuRunningState = false;
 	Common::AtomicStore(CommandProcessor::VITicks, CommandProcessor::m_cpClockOrigin);
@@ -102,12 +149,15 @@ void Fifo_Init()
 void Fifo_Shutdown()
 {
 	if (GpuRunningState) PanicAlert("Fifo shutting down while active");
-	FreeMemoryPages(s_video_buffer, FIFO_SIZE);
+	if (s_video_buffer)
+		s_video_buffer_arena.ReleaseMirroredView(s_video_buffer, FIFO_SIZE);
+	s_video_buffer_arena.ReleaseSHMSegment();
 	s_video_buffer = nullptr;
 	s_video_buffer_write_ptr = nullptr;
 	g_video_buffer_pp_read_ptr = nullptr;
 	g_video_buffer_read_ptr = nullptr;
 	s_video_buffer_seen_ptr = nullptr;
+	s_video_buffer_gpu_read_ptr = nullptr;
 	s_fifo_aux_write_ptr = nullptr;
 	s_fifo_aux_read_ptr = nullptr;
 }
@@ -157,28 +207,14 @@ void SyncGPU(SyncGPUReason reason, bool may_move_read_ptr)
 		if (!GpuRunningState)
 			return;
 
-		// Opportunistically reset FIFOs so we don't wrap around.
+		// Opportunistically reset the aux FIFO so we don't run out of space.
+		// The video buffer is a ring and never needs this.
 		if (may_move_read_ptr && s_fifo_aux_write_ptr != s_fifo_aux_read_ptr)
 			PanicAlert("aux fifo not synced (%p, %p)", s_fifo_aux_write_ptr, s_fifo_aux_read_ptr);
 
 		memmove(s_fifo_aux_data, s_fifo_aux_read_ptr, s_fifo_aux_write_ptr - s_fifo_aux_read_ptr);
 		s_fifo_aux_write_ptr -= (s_fifo_aux_read_ptr - s_fifo_aux_data);
 		s_fifo_aux_read_ptr = s_fifo_aux_data;
-
-		if (may_move_read_ptr)
-		{
-			// what's left over in the buffer
-			size_t size = write_ptr - g_video_buffer_pp_read_ptr;
-
-			memmove(s_video_buffer, g_video_buffer_pp_read_ptr, size);
-			// This change always decreases the pointers.  We write seen_ptr
-			// after write_ptr here, and read it before in RunGpuLoop, so
-			// 'write_ptr > seen_ptr' there cannot become spuriously true.
-			s_video_buffer_write_ptr = write_ptr = s_video_buffer + size;
-			g_video_buffer_pp_read_ptr = s_video_buffer;
-			g_video_buffer_read_ptr = s_video_buffer;
-			s_video_buffer_seen_ptr = write_ptr;
-		}
 	}
 }
 
@@ -207,24 +243,19 @@ void* PopFifoAuxBuffer(size_t size)
 }
 
 // Description: RunGpuLoop() sends data through this function.
-static void ReadDataFromFifo(u32 readPtr)
+static void ReadDataFromFifo(u32 readPtr, size_t len = 32)
 {
-	size_t len = 32;
-	if (len > (size_t)(s_video_buffer + FIFO_SIZE - s_video_buffer_write_ptr))
+	u8* write_ptr = s_video_buffer_write_ptr;
+	size_t existing_len = VideoBufferUsed(g_video_buffer_read_ptr, write_ptr);
+	if (len >= (size_t)(FIFO_SIZE - existing_len))
 	{
-		size_t existing_len = s_video_buffer_write_ptr - g_video_buffer_read_ptr;
-		if (len > (size_t)(FIFO_SIZE - existing_len))
-		{
-			PanicAlert("FIFO out of bounds (existing %lu + new %lu > %lu)", (unsigned long) existing_len, (unsigned long) len, (unsigned long) FIFO_SIZE);
-			return;
-		}
-		memmove(s_video_buffer, g_video_buffer_read_ptr, existing_len);
-		s_video_buffer_write_ptr = s_video_buffer + existing_len;
-		g_video_buffer_read_ptr = s_video_buffer;
+		PanicAlert("FIFO out of bounds (existing %lu + new %lu > %lu)", (unsigned long) existing_len, (unsigned long) len, (unsigned long) FIFO_SIZE);
+		return;
 	}
-	// Copy new video instructions to s_video_buffer for future use in rendering the new picture
-	Memory::CopyFromEmu(s_video_buffer_write_ptr, readPtr, len);
-	s_video_buffer_write_ptr += len;
+	// Copy new video instructions to s_video_buffer for future use in rendering the new picture.
+	// Anything past the end lands in the mirror, i.e. at the start of the buffer.
+	Memory::CopyFromEmu(write_ptr, readPtr, len);
+	s_video_buffer_write_ptr = WrapVideoBufferPtr(write_ptr + len);
 }
 
 // The deterministic_gpu_thread version.
@@ -232,28 +263,29 @@ static void ReadDataFromFifoOnCPU(u32 readPtr)
 {
 	size_t len = 32;
 	u8 *write_ptr = s_video_buffer_write_ptr;
-	if (len > (size_t)(s_video_buffer + FIFO_SIZE - write_ptr))
+	if (len >= (size_t)(FIFO_SIZE - VideoBufferUsed(s_video_buffer_gpu_read_ptr, write_ptr)))
 	{
-		// We can't wrap around while the GPU is working on the data.
-		// This should be very rare due to the reset in SyncGPU.
-		SyncGPU(SYNC_GPU_WRAPAROUND);
+		// We can't overwrite data the GPU hasn't read yet.  This should be
+		// very rare, as the ring only fills up if the GPU falls far behind.
+		SyncGPU(SYNC_GPU_FULL);
 		if (g_video_buffer_pp_read_ptr != g_video_buffer_read_ptr)
 		{
 			PanicAlert("desynced read pointers");
 			return;
 		}
 		write_ptr = s_video_buffer_write_ptr;
-		size_t existing_len = write_ptr - g_video_buffer_pp_read_ptr;
-		if (len > (size_t)(FIFO_SIZE - existing_len))
+		size_t existing_len = VideoBufferUsed(g_video_buffer_pp_read_ptr, write_ptr);
+		if (len >= (size_t)(FIFO_SIZE - existing_len))
 		{
 			PanicAlert("FIFO out of bounds (existing %lu + new %lu > %lu)", (unsigned long) existing_len, (unsigned long) len, (unsigned long) FIFO_SIZE);
 			return;
 		}
 	}
-	Memory::CopyFromEmu(s_video_buffer_write_ptr, readPtr, len);
-	OpcodeDecoder_Preprocess(write_ptr + len, false);
+	Memory::CopyFromEmu(write_ptr, readPtr, len);
+	OpcodeDecoder_Preprocess(VideoBufferLinearEnd(g_video_buffer_pp_read_ptr, write_ptr + len), false);
+	g_video_buffer_pp_read_ptr = WrapVideoBufferPtr(g_video_buffer_pp_read_ptr);
 	// This would have to be locked if the GPU thread didn't spin.
-	s_video_buffer_write_ptr = write_ptr + len;
+	s_video_buffer_write_ptr = WrapVideoBufferPtr(write_ptr + len);
 }
 
 void ResetVideoBuffer()
@@ -261,11 +293,35 @@ void ResetVideoBuffer()
 	g_video_buffer_read_ptr = s_video_buffer;
 	s_video_buffer_write_ptr = s_video_buffer;
 	s_video_buffer_seen_ptr = s_video_buffer;
+	s_video_buffer_gpu_read_ptr = s_video_buffer;
 	g_video_buffer_pp_read_ptr = s_video_buffer;
 	s_fifo_aux_write_ptr = s_fifo_aux_data;
 	s_fifo_aux_read_ptr = s_fifo_aux_data;
 }
 
+// Returns how much RunGpuLoop should read from the FIFO in one go.  In batched
+// mode, that is everything the CPU has written so far, up to the end of the
+// FIFO, the breakpoint, or what fits into the video buffer.
+static u32 GetFifoReadSize(const SCPFifoStruct &fifo, u32 readPtr)
+{
+	const SCoreStartupParameter& param = SConfig::GetInstance().m_LocalCoreStartupParameter;
+	// SyncGPU accounts for GPU cycles after every 32 bytes.
+	if (!param.bBatchFifo || param.bSyncGPU)
+		return 32;
+
+	u32 len = std::min<u32>(Common::AtomicLoad(fifo.CPReadWriteDistance), FIFO_BATCH_SIZE);
+	if (readPtr <= fifo.CPEnd)
+		len = std::min<u32>(len, fifo.CPEnd + 32 - readPtr);
+	if (fifo.bFF_BPEnable && fifo.CPBreakpoint > readPtr)
+		len = std::min<u32>(len, fifo.CPBreakpoint - readPtr);
+
+	size_t free_len = FIFO_SIZE - VideoBufferUsed(g_video_buffer_read_ptr, s_video_buffer_write_ptr);
+	if (len >= free_len)
+		len = (u32)free_len - 1;
+
+	// ReadDataFromFifo complains if not even 32 bytes fit.
+	return std::max<u32>(len & ~31, 32);
+}
 
 // Description: Main FIFO update loop
 // Purpose: Keep the Core HW updated about the CPU-GPU distance
@@ -286,10 +342,10 @@ void RunGpuLoop()
 			// All the fifo/CP stuff is on the CPU.  We just need to run the opcode decoder.
 			u8* seen_ptr = s_video_buffer_seen_ptr;
 			u8* write_ptr = s_video_buffer_write_ptr;
-			// See comment in SyncGPU
-			if (write_ptr > seen_ptr)
+			if (write_ptr != seen_ptr)
 			{
-				OpcodeDecoder_Run(write_ptr, false);
+				RunVideoBuffer(write_ptr);
+				s_video_buffer_gpu_read_ptr = g_video_buffer_read_ptr;
 
 				{
 					std::lock_guard<std::mutex> vblk(s_video_buffer_lock);
@@ -313,27 +369,28 @@ void RunGpuLoop()
 				if (!SConfig::GetInstance().m_LocalCoreStartupParameter.bSyncGPU || Common::AtomicLoad(CommandProcessor::VITicks) > CommandProcessor::m_cpClockOrigin)
 				{
 					u32 readPtr = fifo.CPReadPointer;
-					ReadDataFromFifo(readPtr);
+					u32 len = GetFifoReadSize(fifo, readPtr);
+					ReadDataFromFifo(readPtr, len);
 
-					if (readPtr == fifo.CPEnd)
+					if (readPtr <= fifo.CPEnd && readPtr + len > fifo.CPEnd)
 						readPtr = fifo.CPBase;
 					else
-						readPtr += 32;
+						readPtr += len;
 
-					_assert_msg_(COMMANDPROCESSOR, (s32)fifo.CPReadWriteDistance - 32 >= 0 ,
-						"Negative fifo.CPReadWriteDistance = %i in FIFO Loop !\nThat can produce instability in the game. Please report it.", fifo.CPReadWriteDistance - 32);
+					_assert_msg_(COMMANDPROCESSOR, (s32)fifo.CPReadWriteDistance - (s32)len >= 0 ,
+						"Negative fifo.CPReadWriteDistance = %i in FIFO Loop !\nThat can produce instability in the game. Please report it.", fifo.CPReadWriteDistance - len);
 
 
 					u8* write_ptr = s_video_buffer_write_ptr;
-					cyclesExecuted = OpcodeDecoder_Run(write_ptr, false);
+					cyclesExecuted = RunVideoBuffer(write_ptr);
 
 
 					if (SConfig::GetInstance().m_LocalCoreStartupParameter.bSyncGPU && Common::AtomicLoad(CommandProcessor::VITicks) >= cyclesExecuted)
 						Common::AtomicAdd(CommandProcessor::VITicks, -(s32)cyclesExecuted);
 
 					Common::AtomicStore(fifo.CPReadPointer, readPtr);
-					Common::AtomicAdd(fifo.CPReadWriteDistance, -32);
-					if ((write_ptr - g_video_buffer_read_ptr) == 0)
+					Common::AtomicAdd(fifo.CPReadWriteDistance, -(s32)len);
+					if (write_ptr == g_video_buffer_read_ptr)
 						Common::AtomicStore(fifo.SafeCPReadPointer, fifo.CPReadPointer);
 				}
 
@@ -399,7 +456,7 @@ void RunGpu()
 			FPURoundMode::SaveSIMDState();
 			FPURoundMode::LoadDefaultSIMDState();
 			ReadDataFromFifo(fifo.CPReadPointer);
-			OpcodeDecoder_Run(s_video_buffer_write_ptr, false);
+			RunVideoBuffer(s_video_buffer_write_ptr);
 			FPURoundMode::LoadSIMDState();
 		}
 
@@ -451,6 +508,7 @@ void Fifo_UpdateWantDeterminism(bool want)
 		{
 			// These haven't been updated in non-deterministic mode.
 			s_video_buffer_seen_ptr = g_video_buffer_pp_read_ptr = g_video_buffer_read_ptr;
+			s_video_buffer_gpu_read_ptr = g_video_buffer_read_ptr;
 			CopyPreprocessCPStateFromMain();
 			VertexLoaderManager::MarkAllDirty();
 		}
@@ -34,7 +34,7 @@ enum SyncGPUReason
 {
 	SYNC_GPU_NONE,
 	SYNC_GPU_OTHER,
-	SYNC_GPU_WRAPAROUND,
+	SYNC_GPU_FULL,
 	SYNC_GPU_EFB_POKE,
 	SYNC_GPU_PERFQUERY,
 	SYNC_GPU_BBOX,
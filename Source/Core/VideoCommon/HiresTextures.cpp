@@ -3,26 +3,209 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <condition_variable>
 #include <cstring>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <set>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 #include <SOIL/SOIL.h>
 
 #include "Common/CommonPaths.h"
 #include "Common/FileSearch.h"
 #include "Common/FileUtil.h"
 #include "Common/StringUtil.h"
+#include "Common/Thread.h"
 
 #include "VideoCommon/HiresTextures.h"
+#include "VideoCommon/VideoConfig.h"
 
 namespace HiresTextures
 {
 
 static std::map<std::string, std::string> textureMap;
 
-void Init(const std::string& gameCode)
+// Decoded RGBA8 images, shared between the loader threads and the GPU thread.
+struct DecodedTexture
+{
+	std::vector<u8> data;
+	unsigned int width;
+	unsigned int height;
+};
+
+typedef std::list<std::string> LRUList;
+
+struct CacheEntry
+{
+	std::shared_ptr<DecodedTexture> texture;
+	LRUList::iterator lru_position;
+};
+
+// Only used by the video thread.
+static std::vector<std::thread> s_loaders;
+static bool s_async;
+
+// Everything below is protected by s_lock.
+static std::mutex s_lock;
+static std::unordered_map<std::string, CacheEntry> s_cache;
+static LRUList s_lru; // most recently used first
+static size_t s_cache_size;
+static size_t s_cache_budget;
+static std::set<std::string> s_failed;
+
+static std::deque<std::string> s_queue;
+static std::set<std::string> s_queued;
+static std::condition_variable s_queue_event;
+static bool s_loaders_running;
+static bool s_preloading;
+
+static std::shared_ptr<DecodedTexture> DecodeTexture(const std::string& path)
+{
+	File::IOFile file(path, "rb");
+	std::vector<u8> buffer(file.GetSize());
+	if (!file.ReadBytes(buffer.data(), buffer.size()))
+	{
+		ERROR_LOG(VIDEO, "Custom texture %s failed to load", path.c_str());
+		return nullptr;
+	}
+
+	int width;
+	int height;
+	int channels;
+	u8* image = SOIL_load_image_from_memory(buffer.data(), (int)buffer.size(), &width, &height, &channels, SOIL_LOAD_RGBA);
+	if (image == nullptr)
+	{
+		ERROR_LOG(VIDEO, "Custom texture %s failed to load", path.c_str());
+		return nullptr;
+	}
+
+	std::shared_ptr<DecodedTexture> texture = std::make_shared<DecodedTexture>();
+	texture->data.assign(image, image + width * height * 4);
+	texture->width = width;
+	texture->height = height;
+	SOIL_free_image_data(image);
+	return texture;
+}
+
+// Must be called with s_lock held.
+static std::shared_ptr<DecodedTexture> FindCachedTexture(const std::string& filename)
+{
+	auto iter = s_cache.find(filename);
+	if (iter == s_cache.end())
+		return nullptr;
+
+	s_lru.splice(s_lru.begin(), s_lru, iter->second.lru_position);
+	return iter->second.texture;
+}
+
+// Must be called with s_lock held. A budget of 0 means no limit. A single texture
+// larger than the budget still gets cached, at the expense of everything else.
+static void InsertCachedTexture(const std::string& filename, std::shared_ptr<DecodedTexture> texture)
+{
+	if (s_cache.count(filename))
+		return;
+
+	while (s_cache_budget && !s_lru.empty() && s_cache_size + texture->data.size() > s_cache_budget)
+	{
+		auto iter = s_cache.find(s_lru.back());
+		s_cache_size -= iter->second.texture->data.size();
+		s_cache.erase(iter);
+		s_lru.pop_back();
+	}
+
+	s_lru.push_front(filename);
+	CacheEntry& entry = s_cache[filename];
+	entry.texture = texture;
+	entry.lru_position = s_lru.begin();
+	s_cache_size += texture->data.size();
+}
+
+static void LoaderThread()
+{
+	Common::SetCurrentThreadName("Custom texture loader");
+
+	std::unique_lock<std::mutex> lk(s_lock);
+	while (true)
+	{
+		s_queue_event.wait(lk, [] { return !s_queue.empty() || !s_loaders_running; });
+		if (!s_loaders_running)
+			return;
+
+		// Stop preloading once the whole budget is in use, rather than
+		// evicting textures we just loaded.
+		if (s_preloading && s_cache_budget && s_cache_size >= s_cache_budget)
+		{
+			WARN_LOG(VIDEO, "Custom texture cache is full, stopping preload with %u textures left", (u32)s_queue.size());
+			s_preloading = false;
+			for (const std::string& filename : s_queue)
+				s_queued.erase(filename);
+			s_queue.clear();
+			continue;
+		}
+
+		std::string filename = s_queue.front();
+		s_queue.pop_front();
+		std::string path = textureMap.find(filename)->second;
+
+		lk.unlock();
+		std::shared_ptr<DecodedTexture> texture = DecodeTexture(path);
+		lk.lock();
+
+		s_queued.erase(filename);
+		if (texture)
+			InsertCachedTexture(filename, texture);
+		else
+			s_failed.insert(filename);
+
+		if (s_preloading && s_queue.empty())
+		{
+			NOTICE_LOG(VIDEO, "Preloaded custom textures, %u MB in use", (u32)(s_cache_size >> 20));
+			s_preloading = false;
+		}
+	}
+}
+
+// Must be called with s_lock held.
+static void QueueTexture(const std::string& filename)
+{
+	if (s_queued.insert(filename).second)
+	{
+		s_queue.push_back(filename);
+		s_queue_event.notify_one();
+	}
+}
+
+void Shutdown()
 {
+	{
+		std::lock_guard<std::mutex> lk(s_lock);
+		s_loaders_running = false;
+		s_queue_event.notify_all();
+	}
+	for (std::thread& loader : s_loaders)
+		loader.join();
+	s_loaders.clear();
+
+	s_cache.clear();
+	s_lru.clear();
+	s_cache_size = 0;
+	s_failed.clear();
+	s_queue.clear();
+	s_queued.clear();
+	s_preloading = false;
+	s_async = false;
 	textureMap.clear();
+}
+
+void Init(const std::string& gameCode)
+{
+	Shutdown();
 
 	CFileSearch::XStringVector Directories;
 
@@ -78,6 +261,25 @@ void Init(const std::string& gameCode)
 				textureMap.insert(std::map<std::string, std::string>::value_type(FileName, rFilename));
 		}
 	}
+
+	s_cache_budget = (size_t)std::max(g_ActiveConfig.iHiresTexturesCacheSize, 0) << 20;
+
+	if ((g_ActiveConfig.bAsyncHiresTextures || g_ActiveConfig.bCacheHiresTextures) && !textureMap.empty())
+	{
+		std::lock_guard<std::mutex> lk(s_lock);
+		if (g_ActiveConfig.bCacheHiresTextures)
+		{
+			s_preloading = true;
+			for (const auto& entry : textureMap)
+				QueueTexture(entry.first);
+		}
+
+		s_async = g_ActiveConfig.bAsyncHiresTextures;
+		s_loaders_running = true;
+		unsigned int num_loaders = std::min(std::max(std::thread::hardware_concurrency() / 2, 1U), 4U);
+		for (unsigned int i = 0; i < num_loaders; ++i)
+			s_loaders.emplace_back(LoaderThread);
+	}
 }
 
 bool HiresTexExists(const std::string& filename)
@@ -85,80 +287,73 @@ bool HiresTexExists(const std::string& filename)
 	return textureMap.find(filename) != textureMap.end();
 }
 
-PC_TexFormat GetHiresTex(const std::string& filename, unsigned int* pWidth, unsigned int* pHeight, unsigned int* required_size, int texformat, unsigned int data_size, u8* data)
+bool HiresTexPending(const std::string& filename)
 {
-	if (textureMap.find(filename) == textureMap.end())
-		return PC_TEX_FMT_NONE;
+	if (!s_async || textureMap.find(filename) == textureMap.end())
+		return false;
 
-	int width;
-	int height;
-	int channels;
-
-	File::IOFile file;
-	file.Open(textureMap[filename], "rb");
-	std::vector<u8> buffer(file.GetSize());
-	file.ReadBytes(buffer.data(), file.GetSize());
+	std::lock_guard<std::mutex> lk(s_lock);
+	bool pending = false;
 
-	u8* temp = SOIL_load_image_from_memory(buffer.data(), (int)buffer.size(), &width, &height, &channels, SOIL_LOAD_RGBA);
-
-	if (temp == nullptr)
+	// The texture only counts as loaded once all of its mipmaps are, too.
+	for (unsigned int level = 0; ; ++level)
 	{
-		ERROR_LOG(VIDEO, "Custom texture %s failed to load", textureMap[filename].c_str());
-		return PC_TEX_FMT_NONE;
+		std::string name = level ? StringFromFormat("%s_mip%u", filename.c_str(), level) : filename;
+		if (level && textureMap.find(name) == textureMap.end())
+			break;
+
+		if (!s_cache.count(name) && !s_failed.count(name))
+		{
+			QueueTexture(name);
+			pending = true;
+		}
 	}
 
-	*pWidth = width;
-	*pHeight = height;
+	return pending;
+}
 
-	//int offset = 0;
-	PC_TexFormat returnTex = PC_TEX_FMT_NONE;
+PC_TexFormat GetHiresTex(const std::string& filename, unsigned int* pWidth, unsigned int* pHeight, unsigned int* required_size, int texformat, unsigned int data_size, u8* data)
+{
+	auto map_iter = textureMap.find(filename);
+	if (map_iter == textureMap.end())
+		return PC_TEX_FMT_NONE;
 
-	// TODO(neobrain): This function currently has no way to enforce RGBA32
-	// output, which however is required on some configurations to function
-	// properly. As a lazy workaround, we hence disable the optimized code
-	// path for now.
-#if 0
-	switch (texformat)
+	std::shared_ptr<DecodedTexture> texture;
+	{
+		std::lock_guard<std::mutex> lk(s_lock);
+		if (s_failed.count(filename))
+			return PC_TEX_FMT_NONE;
+		texture = FindCachedTexture(filename);
+	}
+
+	if (!texture)
 	{
-	case GX_TF_I4:
-	case GX_TF_I8:
-	case GX_TF_IA4:
-	case GX_TF_IA8:
-		*required_size = width * height * 8;
-		if (data_size < *required_size)
-			goto cleanup;
-
-		for (int i = 0; i < width * height * 4; i += 4)
+		texture = DecodeTexture(map_iter->second);
+
+		std::lock_guard<std::mutex> lk(s_lock);
+		if (!texture)
 		{
-			// Rather than use a luminosity function, just use the most intense color for luminance
-			// TODO(neobrain): Isn't this kind of.. stupid?
-			data[offset++] = *std::max_element(temp+i, temp+i+3);
-			data[offset++] = temp[i+3];
+			s_failed.insert(filename);
+			return PC_TEX_FMT_NONE;
 		}
-		returnTex = PC_TEX_FMT_IA8;
-		break;
-	default:
-		*required_size = width * height * 4;
-		if (data_size < *required_size)
-			goto cleanup;
-
-		memcpy(data, temp, width * height * 4);
-		returnTex = PC_TEX_FMT_RGBA32;
-		break;
+		InsertCachedTexture(filename, texture);
 	}
-#else
-	*required_size = width * height * 4;
+
+	*pWidth = texture->width;
+	*pHeight = texture->height;
+
+	// TODO(neobrain): This function currently has no way to enforce RGBA32
+	// output, which however is required on some configurations to function
+	// properly. The IA8 conversion that used to be here has been dropped
+	// for that reason.
+	*required_size = texture->width * texture->height * 4;
 	if (data_size < *required_size)
-		goto cleanup;
+		return PC_TEX_FMT_NONE;
 
-	memcpy(data, temp, width * height * 4);
-	returnTex = PC_TEX_FMT_RGBA32;
-#endif
+	memcpy(data, texture->data.data(), *required_size);
 
-	INFO_LOG(VIDEO, "Loading custom texture from %s", textureMap[filename].c_str());
-cleanup:
-	SOIL_free_image_data(temp);
-	return returnTex;
+	INFO_LOG(VIDEO, "Loading custom texture from %s", map_iter->second.c_str());
+	return PC_TEX_FMT_RGBA32;
 }
 
 }
@@ -11,8 +11,14 @@
 
 namespace HiresTextures
 {
+// Scans the texture pack of a game. Depending on the config, this also starts
+// the background loaders and queues the whole pack for preloading.
 void Init(const std::string& gameCode);
+void Shutdown();
 bool HiresTexExists(const std::string& filename);
+// Returns true while the background loaders are still decoding the texture or
+// one of its mipmaps. Queues whatever isn't loaded yet.
+bool HiresTexPending(const std::string& filename);
 PC_TexFormat GetHiresTex(const std::string& fileName, unsigned int* pWidth, unsigned int* pHeight, unsigned int* required_size, int texformat, unsigned int data_size, u8* data);
 
 }
@@ -49,6 +49,7 @@ TextureCache::TextureCache()
 		temp = (u8*)AllocateAlignedMemory(temp_size, 16);
 
 	TexDecoder_SetTexFmtOverlayOptions(g_ActiveConfig.bTexFmtOverlayEnable, g_ActiveConfig.bTexFmtOverlayCenter);
+	TexDecoder_Init();
 
 	if (g_ActiveConfig.bHiresTextures && !g_ActiveConfig.bDumpTextures)
 		HiresTextures::Init(SConfig::GetInstance().m_LocalCoreStartupParameter.m_strUniqueID);
@@ -80,6 +81,8 @@ void TextureCache::Invalidate()
 
 TextureCache::~TextureCache()
 {
+	HiresTextures::Shutdown();
+	TexDecoder_Shutdown();
 	Invalidate();
 	FreeAlignedMemory(temp);
 	temp = nullptr;
@@ -93,13 +96,20 @@ void TextureCache::OnConfigChanged(VideoConfig& config)
 		if (config.iSafeTextureCache_ColorSamples != backup_config.s_colorsamples ||
 			config.bTexFmtOverlayEnable != backup_config.s_texfmt_overlay ||
 			config.bTexFmtOverlayCenter != backup_config.s_texfmt_overlay_center ||
+			config.bCMPRPassthrough != backup_config.s_cmpr_passthrough ||
+			config.bDumpTextures != backup_config.s_dump_textures ||
 			config.bHiresTextures != backup_config.s_hires_textures ||
+			config.bAsyncHiresTextures != backup_config.s_async_hires_textures ||
+			config.bCacheHiresTextures != backup_config.s_cache_hires_textures ||
+			config.iHiresTexturesCacheSize != backup_config.s_hires_textures_cache_size ||
 			invalidate_texture_cache_requested)
 		{
 			g_texture_cache->Invalidate();
 
 			if (g_ActiveConfig.bHiresTextures)
 				HiresTextures::Init(SConfig::GetInstance().m_LocalCoreStartupParameter.m_strUniqueID);
+			else
+				HiresTextures::Shutdown();
 
 			SetHash64Function(g_ActiveConfig.bHiresTextures || g_ActiveConfig.bDumpTextures);
 			TexDecoder_SetTexFmtOverlayOptions(g_ActiveConfig.bTexFmtOverlayEnable, g_ActiveConfig.bTexFmtOverlayCenter);
@@ -134,7 +144,12 @@ void TextureCache::OnConfigChanged(VideoConfig& config)
 	backup_config.s_efb_scale = config.iEFBScale;
 	backup_config.s_texfmt_overlay = config.bTexFmtOverlayEnable;
 	backup_config.s_texfmt_overlay_center = config.bTexFmtOverlayCenter;
+	backup_config.s_cmpr_passthrough = config.bCMPRPassthrough;
+	backup_config.s_dump_textures = config.bDumpTextures;
 	backup_config.s_hires_textures = config.bHiresTextures;
+	backup_config.s_async_hires_textures = config.bAsyncHiresTextures;
+	backup_config.s_cache_hires_textures = config.bCacheHiresTextures;
+	backup_config.s_hires_textures_cache_size = config.iHiresTexturesCacheSize;
 	backup_config.s_copy_cache_enable = config.bEFBCopyCacheEnable;
 	backup_config.s_stereo_3d = config.iStereoMode > 0;
 	backup_config.s_mono_efb_depth = config.bStereoMonoEFBDepth;
@@ -279,17 +294,21 @@ bool TextureCache::CheckForCustomTextureLODs(u64 tex_hash, int texformat, unsign
 	return true;
 }
 
-PC_TexFormat TextureCache::LoadCustomTexture(u64 tex_hash, int texformat, unsigned int level, unsigned int* widthp, unsigned int* heightp)
+static std::string GetCustomTextureName(u64 tex_hash, int texformat, unsigned int level)
 {
-	std::string texPathTemp;
-	unsigned int newWidth = 0;
-	unsigned int newHeight = 0;
 	u32 tex_hash_u32 = tex_hash & 0x00000000FFFFFFFFLL;
 
 	if (level == 0)
-		texPathTemp = StringFromFormat("%s_%08x_%i", SConfig::GetInstance().m_LocalCoreStartupParameter.m_strUniqueID.c_str(), tex_hash_u32, texformat);
+		return StringFromFormat("%s_%08x_%i", SConfig::GetInstance().m_LocalCoreStartupParameter.m_strUniqueID.c_str(), tex_hash_u32, texformat);
 	else
-		texPathTemp = StringFromFormat("%s_%08x_%i_mip%u", SConfig::GetInstance().m_LocalCoreStartupParameter.m_strUniqueID.c_str(), tex_hash_u32, texformat, level);
+		return StringFromFormat("%s_%08x_%i_mip%u", SConfig::GetInstance().m_LocalCoreStartupParameter.m_strUniqueID.c_str(), tex_hash_u32, texformat, level);
+}
+
+PC_TexFormat TextureCache::LoadCustomTexture(u64 tex_hash, int texformat, unsigned int level, unsigned int* widthp, unsigned int* heightp)
+{
+	std::string texPathTemp = GetCustomTextureName(tex_hash, texformat, level);
+	unsigned int newWidth = 0;
+	unsigned int newHeight = 0;
 
 	unsigned int required_size = 0;
 	PC_TexFormat ret = HiresTextures::GetHiresTex(texPathTemp, &newWidth, &newHeight, &required_size, texformat, temp_size, temp);
@@ -406,8 +425,6 @@ TextureCache::TCacheEntryBase* TextureCache::Load(unsigned int const stage,
 		ERROR_LOG(VIDEO, "TextureCache::Load has an address in Wii memory (%8x) but not in real memory (NULL)!", address);
 		return nullptr;
 	}
-	else
-		tex_hash = GetHash64(src_data, texture_size, g_ActiveConfig.iSafeTextureCache_ColorSamples);
 
 	if (isPaletteTexture)
 	{
@@ -424,14 +441,46 @@ TextureCache::TCacheEntryBase* TextureCache::Load(unsigned int const stage,
 		//
 		// TODO: Because texID isn't always the same as the address now, CopyRenderTargetToTexture might be broken now
 		texID ^= ((u32)tlut_hash) ^(u32)(tlut_hash >> 32);
-		tex_hash ^= tlut_hash;
 	}
 
+	// If nothing wrote to the texture's pages since it was last hashed, the old hash is still good.
+	// Otherwise, the pages are watched again before hashing, so that a write racing the hash
+	// makes the next Load hash again.
+	const bool track_writes = g_ActiveConfig.bTrackTextureWrites && !from_tmem;
+	bool writes_tracked = false;
+	u64 write_generation = 0;
+	u64 data_hash = TEXHASH_INVALID;
+
+	TexCache::iterator iter = textures.find(texID);
+	TCacheEntryBase* tracked_entry = iter != textures.end() ? iter->second : nullptr;
+	if (track_writes && tracked_entry && tracked_entry->type == TCET_NORMAL && tracked_entry->writes_tracked &&
+		tracked_entry->addr == address && tracked_entry->size_in_bytes == texture_size &&
+		!Memory::WasWrittenSince(address, texture_size, tracked_entry->write_generation))
+	{
+		writes_tracked = true;
+		write_generation = tracked_entry->write_generation;
+		data_hash = tracked_entry->data_hash;
+	}
+	else
+	{
+		writes_tracked = track_writes && Memory::WatchRange(address, texture_size, &write_generation);
+		data_hash = GetHash64(src_data, texture_size, g_ActiveConfig.iSafeTextureCache_ColorSamples);
+	}
+	tex_hash = data_hash ^ tlut_hash;
+
 	// D3D doesn't like when the specified mipmap count would require more than one 1x1-sized LOD in the mipmap chain
 	// e.g. 64x64 with 7 LODs would have the mipmap chain 64x64,32x32,16x16,8x8,4x4,2x2,1x1,1x1, so we limit the mipmap count to 6 there
 	while (g_ActiveConfig.backend_info.bUseMinimalMipCount && std::max(width, height) >> maxlevel == 0)
 		--maxlevel;
 
+	// CMPR is DXT1 with the blocks in a different order, so backends that support DXT1 can
+	// upload it without decoding. Dumping, custom textures and the format overlay need RGBA,
+	// and D3D needs whole blocks.
+	const bool use_dxt1 = texformat == GX_TF_CMPR && g_ActiveConfig.bCMPRPassthrough &&
+		g_ActiveConfig.backend_info.bSupportsDXT1Textures && !g_ActiveConfig.bDumpTextures &&
+		!g_ActiveConfig.bHiresTextures && !g_ActiveConfig.bTexFmtOverlayEnable &&
+		(width & 3) == 0 && (height & 3) == 0;
+
 	TCacheEntryBase *entry = textures[texID];
 	if (entry)
 	{
@@ -452,9 +501,12 @@ TextureCache::TCacheEntryBase* TextureCache::Load(unsigned int const stage,
 		}
 
 		// 2. b) For normal textures, all texture parameters need to match
+		//       Entries standing in for a custom texture are reloaded once it is ready.
 		if (address == entry->addr && tex_hash == entry->hash && full_format == entry->format &&
-			entry->num_mipmaps > maxlevel && entry->native_width == nativeW && entry->native_height == nativeH)
+			entry->num_mipmaps > maxlevel && entry->native_width == nativeW && entry->native_height == nativeH &&
+			!(entry->custom_texture_pending && !HiresTextures::HiresTexPending(GetCustomTextureName(tex_hash, texformat, 0))))
 		{
+			entry->SetWriteTracking(writes_tracked && entry->type == TCET_NORMAL, write_generation, data_hash);
 			return ReturnEntry(stage, entry);
 		}
 
@@ -468,7 +520,7 @@ TextureCache::TCacheEntryBase* TextureCache::Load(unsigned int const stage,
 		     height == entry->virtual_height &&
 		     full_format == entry->format &&
 		     entry->num_mipmaps > maxlevel) ||
-		    (entry->type == TCET_EC_DYNAMIC &&
+		    (entry->type == TCET_EC_DYNAMIC && !use_dxt1 &&
 		     entry->native_width == width &&
 		     entry->native_height == height)) &&
 		     entry->num_layers == 1)
@@ -484,10 +536,14 @@ TextureCache::TCacheEntryBase* TextureCache::Load(unsigned int const stage,
 	}
 
 	bool using_custom_texture = false;
+	bool custom_texture_pending = false;
 
 	if (g_ActiveConfig.bHiresTextures)
 	{
-		pcfmt = LoadCustomTexture(tex_hash, texformat, 0, &width, &height);
+		// If the custom texture is still being loaded in the background, use the native one for now.
+		custom_texture_pending = HiresTextures::HiresTexPending(GetCustomTextureName(tex_hash, texformat, 0));
+		if (!custom_texture_pending)
+			pcfmt = LoadCustomTexture(tex_hash, texformat, 0, &width, &height);
 		if (pcfmt != PC_TEX_FMT_NONE)
 		{
 			if (expandedWidth != width || expandedHeight != height)
@@ -508,7 +564,11 @@ TextureCache::TCacheEntryBase* TextureCache::Load(unsigned int const stage,
 
 	if (!using_custom_texture)
 	{
-		if (!(texformat == GX_TF_RGBA8 && from_tmem))
+		if (use_dxt1)
+		{
+			pcfmt = TexDecoder_DecodeCMPRAsDXT1(temp, src_data, width, height, expandedWidth);
+		}
+		else if (!(texformat == GX_TF_RGBA8 && from_tmem))
 		{
 			const u8* tlut = &texMem[tlutaddr];
 			pcfmt = TexDecoder_Decode(temp, src_data, expandedWidth, expandedHeight, texformat, tlut, (TlutFormat) tlutfmt);
@@ -526,6 +586,13 @@ TextureCache::TCacheEntryBase* TextureCache::Load(unsigned int const stage,
 	const bool use_native_mips = use_mipmaps && !using_custom_lods && (width == nativeW && height == nativeH);
 	texLevels = (use_native_mips || using_custom_lods) ? texLevels : 1; // TODO: Should be forced to 1 for non-pow2 textures (e.g. efb copies with automatically adjusted IR)
 
+	// A reused texture keeps the format it was created with.
+	if (entry && entry->type == TCET_NORMAL && entry->pcfmt != pcfmt)
+	{
+		delete entry;
+		entry = nullptr;
+	}
+
 	// create the entry/texture
 	if (nullptr == entry)
 	{
@@ -553,11 +620,13 @@ TextureCache::TCacheEntryBase* TextureCache::Load(unsigned int const stage,
 	entry->SetGeneralParameters(address, texture_size, full_format, entry->num_mipmaps, entry->num_layers);
 	entry->SetDimensions(nativeW, nativeH, width, height);
 	entry->hash = tex_hash;
+	entry->custom_texture_pending = custom_texture_pending;
 
 	if (entry->IsEfbCopy() && !g_ActiveConfig.bCopyEFBToTexture)
 		entry->type = TCET_EC_DYNAMIC;
 	else
 		entry->type = TCET_NORMAL;
+	entry->SetWriteTracking(writes_tracked && entry->type == TCET_NORMAL, write_generation, data_hash);
 
 	if (g_ActiveConfig.bDumpTextures && !using_custom_texture)
 		DumpTexture(entry, 0);
@@ -589,7 +658,10 @@ TextureCache::TCacheEntryBase* TextureCache::Load(unsigned int const stage,
 					? ((level % 2) ? ptr_odd : ptr_even)
 					: src_data;
 				const u8* tlut = &texMem[tlutaddr];
-				TexDecoder_Decode(temp, mip_src_data, expanded_mip_width, expanded_mip_height, texformat, tlut, (TlutFormat) tlutfmt);
+				if (use_dxt1)
+					TexDecoder_DecodeCMPRAsDXT1(temp, mip_src_data, mip_width, mip_height, expanded_mip_width);
+				else
+					TexDecoder_Decode(temp, mip_src_data, expanded_mip_width, expanded_mip_height, texformat, tlut, (TlutFormat) tlutfmt);
 				mip_src_data += TexDecoder_GetTextureSizeInBytes(expanded_mip_width, expanded_mip_height, texformat);
 
 				entry->Load(mip_width, mip_height, expanded_mip_width, level);
@@ -46,6 +46,17 @@ public:
 		// used to delete textures which haven't been used for TEXTURE_KILL_THRESHOLD frames
 		int frameCount;
 
+		// the native texture is standing in for a custom texture that is still being loaded
+		bool custom_texture_pending = false;
+
+		// the hash of the texture data alone is known to be current until Memory::WasWrittenSince
+		// says otherwise, see bTrackTextureWrites
+		bool writes_tracked = false;
+		u64 write_generation = 0;
+		u64 data_hash = TEXHASH_INVALID;
+
+		// what the texture was uploaded as, set by CreateTexture; DXT1 and RGBA entries can't stand in for each other
+		PC_TexFormat pcfmt = PC_TEX_FMT_NONE;
 
 		void SetGeneralParameters(u32 _addr, u32 _size, u32 _format, unsigned int _num_mipmaps, unsigned int _num_layers)
 		{
@@ -70,6 +81,13 @@ public:
 			//pal_hash = _pal_hash;
 		}
 
+		void SetWriteTracking(bool _writes_tracked, u64 _write_generation, u64 _data_hash)
+		{
+			writes_tracked = _writes_tracked;
+			write_generation = _write_generation;
+			data_hash = _data_hash;
+		}
+
 
 		virtual ~TCacheEntryBase();
 
@@ -144,7 +162,12 @@ private:
 		int s_efb_scale;
 		bool s_texfmt_overlay;
 		bool s_texfmt_overlay_center;
+		bool s_cmpr_passthrough;
+		bool s_dump_textures;
 		bool s_hires_textures;
+		bool s_async_hires_textures;
+		bool s_cache_hires_textures;
+		int s_hires_textures_cache_size;
 		bool s_copy_cache_enable;
 		bool s_stereo_3d;
 		bool s_mono_efb_depth;
@@ -79,8 +79,16 @@ enum PC_TexFormat
 	PC_TEX_FMT_DXT1,
 };
 
+// Starts and stops the worker threads that TexDecoder_Decode splits large textures across.
+void TexDecoder_Init();
+void TexDecoder_Shutdown();
+
 PC_TexFormat TexDecoder_Decode(u8 *dst, const u8 *src, int width, int height, int texformat, const u8* tlut, TlutFormat tlutfmt);
 PC_TexFormat TexDecoder_DecodeRGBA8FromTmem(u8* dst, const u8 *src_ar, const u8 *src_gb, int width, int height);
+// Rearranges a CMPR texture of expanded_width texels per row into S3TC/DXT1 blocks, tightly
+// packed for a width x height texture. Colors are interpolated slightly differently than on
+// the GameCube.
+PC_TexFormat TexDecoder_DecodeCMPRAsDXT1(u8* dst, const u8* src, int width, int height, int expanded_width);
 void TexDecoder_DecodeTexel(u8 *dst, const u8 *src, int s, int t, int imageWidth, int texformat, const u8* tlut, TlutFormat tlutfmt);
 void TexDecoder_DecodeTexelRGBA8FromTmem(u8 *dst, const u8 *src_ar, const u8* src_gb, int s, int t, int imageWidth);
 
@@ -2,9 +2,17 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #include "Common/Common.h"
+#include "Common/Thread.h"
 
 #include "VideoCommon/LookUpTables.h"
 #include "VideoCommon/sfont.inc"
@@ -246,9 +254,147 @@ static void TexDecoder_DrawOverlay(u8 *dst, int width, int height, int texformat
 	}
 }
 
+// Textures with fewer texels than this are decoded on the calling thread; waking up the
+// workers costs more than it saves.
+static const int MIN_THREADED_DECODE_TEXELS = 256 * 256;
+
+namespace
+{
+// A texture split into bands of whole block rows, each of which can be decoded on its own.
+struct DecodeJob
+{
+	u8* dst;
+	const u8* src;
+	int width;
+	int height;
+	int texformat;
+	const u8* tlut;
+	TlutFormat tlutfmt;
+	int band_height;
+	int num_bands;
+	std::atomic<int> next_band;
+};
+}
+
+static std::vector<std::thread> s_decode_threads;
+static std::mutex s_decode_lock;
+static std::condition_variable s_decode_event;
+static std::condition_variable s_decode_done;
+static DecodeJob* s_decode_job = nullptr;
+static u32 s_decode_job_id = 0;
+static int s_decode_job_users = 0;
+static bool s_decode_threads_quit = false;
+
+static PC_TexFormat DecodeBand(DecodeJob* job, int band)
+{
+	const int y = band * job->band_height;
+	const int height = std::min(job->band_height, job->height - y);
+	return _TexDecoder_DecodeImpl((u32*)job->dst + y * job->width,
+		job->src + TexDecoder_GetTextureSizeInBytes(job->width, y, job->texformat),
+		job->width, height, job->texformat, job->tlut, job->tlutfmt);
+}
+
+static void DecodeRemainingBands(DecodeJob* job)
+{
+	int band;
+	while ((band = job->next_band++) < job->num_bands)
+		DecodeBand(job, band);
+}
+
+static void DecoderThread()
+{
+	Common::SetCurrentThreadName("Texture decoder");
+
+	u32 last_job_id = 0;
+	std::unique_lock<std::mutex> lk(s_decode_lock);
+	while (true)
+	{
+		s_decode_event.wait(lk, [&] { return s_decode_threads_quit || (s_decode_job && s_decode_job_id != last_job_id); });
+		if (s_decode_threads_quit)
+			return;
+
+		DecodeJob* job = s_decode_job;
+		last_job_id = s_decode_job_id;
+		s_decode_job_users++;
+		lk.unlock();
+
+		DecodeRemainingBands(job);
+
+		lk.lock();
+		if (--s_decode_job_users == 0)
+			s_decode_done.notify_one();
+	}
+}
+
+void TexDecoder_Init()
+{
+	if (!s_decode_threads.empty() || std::thread::hardware_concurrency() <= 1)
+		return;
+
+	// The calling thread decodes a band as well.
+	const unsigned int num_threads = std::min(std::max(std::thread::hardware_concurrency() / 2, 1U), 4U);
+	s_decode_threads_quit = false;
+	for (unsigned int i = 0; i < num_threads; i++)
+		s_decode_threads.emplace_back(DecoderThread);
+}
+
+void TexDecoder_Shutdown()
+{
+	{
+		std::lock_guard<std::mutex> lk(s_decode_lock);
+		s_decode_threads_quit = true;
+	}
+	s_decode_event.notify_all();
+	for (std::thread& thread : s_decode_threads)
+		thread.join();
+	s_decode_threads.clear();
+}
+
+static PC_TexFormat DecodeThreaded(u8 *dst, const u8 *src, int width, int height, int texformat, const u8* tlut, TlutFormat tlutfmt)
+{
+	const int block_height = TexDecoder_GetBlockHeightInTexels(texformat);
+	const int num_block_rows = height / block_height;
+	const int num_bands = std::min<int>(num_block_rows, (int)s_decode_threads.size() + 1);
+
+	DecodeJob job;
+	job.dst = dst;
+	job.src = src;
+	job.width = width;
+	job.height = height;
+	job.texformat = texformat;
+	job.tlut = tlut;
+	job.tlutfmt = tlutfmt;
+	job.band_height = (num_block_rows + num_bands - 1) / num_bands * block_height;
+	job.num_bands = (height + job.band_height - 1) / job.band_height;
+	job.next_band = 1;
+
+	{
+		std::lock_guard<std::mutex> lk(s_decode_lock);
+		s_decode_job = &job;
+		s_decode_job_id++;
+	}
+	s_decode_event.notify_all();
+
+	// All bands decode to the same format, so the first one tells us what it is.
+	PC_TexFormat pc_texformat = DecodeBand(&job, 0);
+	DecodeRemainingBands(&job);
+
+	// Workers that haven't picked up the job yet mustn't see it anymore once we return.
+	std::unique_lock<std::mutex> lk(s_decode_lock);
+	s_decode_job = nullptr;
+	s_decode_done.wait(lk, [] { return s_decode_job_users == 0; });
+
+	return pc_texformat;
+}
+
 PC_TexFormat TexDecoder_Decode(u8 *dst, const u8 *src, int width, int height, int texformat, const u8* tlut, TlutFormat tlutfmt)
 {
-	PC_TexFormat pc_texformat = _TexDecoder_DecodeImpl((u32*)dst, src, width, height, texformat, tlut, tlutfmt);
+	PC_TexFormat pc_texformat;
+	if (!s_decode_threads.empty() && width * height >= MIN_THREADED_DECODE_TEXELS &&
+	    height % TexDecoder_GetBlockHeightInTexels(texformat) == 0)
+		pc_texformat = DecodeThreaded(dst, src, width, height, texformat, tlut, tlutfmt);
+	else
+		pc_texformat = _TexDecoder_DecodeImpl((u32*)dst, src, width, height, texformat, tlut, tlutfmt);
 
 	if (TexFmt_Overlay_Enable && pc_texformat != PC_TEX_FMT_NONE)
 		TexDecoder_DrawOverlay(dst, width, height, texformat, pc_texformat);
@@ -613,3 +759,32 @@ PC_TexFormat TexDecoder_DecodeRGBA8FromTmem(u8* dst, const u8 *src_ar, const u8
 
 	return PC_TEX_FMT_RGBA32;
 }
+
+PC_TexFormat TexDecoder_DecodeCMPRAsDXT1(u8* dst, const u8* src, int width, int height, int expanded_width)
+{
+	// CMPR stores 2x2 DXT1 blocks per 8x8 tile, with big endian colors and the first texel of
+	// each row in the top bits instead of the bottom ones.
+	const int blocks_wide = (width + 3) / 4;
+	const int blocks_high = (height + 3) / 4;
+	const int tiles_wide = expanded_width / 8;
+
+	for (int by = 0; by < blocks_high; ++by)
+	{
+		for (int bx = 0; bx < blocks_wide; ++bx)
+		{
+			const u8* block = src + ((by / 2) * tiles_wide + bx / 2) * 32 + ((by & 1) * 2 + (bx & 1)) * 8;
+			u16 color1 = Common::swap16(block + 0);
+			u16 color2 = Common::swap16(block + 2);
+			std::memcpy(dst + 0, &color1, sizeof(u16));
+			std::memcpy(dst + 2, &color2, sizeof(u16));
+			for (int line = 0; line < 4; ++line)
+			{
+				u8 val = block[4 + line];
+				dst[4 + line] = ((val & 0x03) << 6) | ((val & 0x0C) << 2) | ((val & 0x30) >> 2) | ((val & 0xC0) >> 6);
+			}
+			dst += 8;
+		}
+	}
+
+	return PC_TEX_FMT_DXT1;
+}
@@ -20,6 +20,23 @@
 #include <tmmintrin.h>
 #endif
 
+// AVX2 kernels are compiled whatever the baseline target is and only picked when
+// cpu_info says the host supports them.
+#if defined(_MSC_VER)
+#define TEXDECODER_AVX2 1
+#define FUNCTION_TARGET_AVX2
+#elif defined(__clang__) && (__clang_major__ * 100 + __clang_minor__ >= 308)
+#define TEXDECODER_AVX2 1
+#define FUNCTION_TARGET_AVX2 __attribute__((target("avx2")))
+#elif !defined(__clang__) && defined(__GNUC__) && (__GNUC__ * 100 + __GNUC_MINOR__ >= 409)
+#define TEXDECODER_AVX2 1
+#define FUNCTION_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+#ifdef TEXDECODER_AVX2
+#include <immintrin.h>
+#endif
+
 // This avoids a harmless warning from a system header in Clang;
 // see http://llvm.org/bugs/show_bug.cgi?id=16093
 #if defined(__clang__) && (__clang_major__ * 100 + __clang_minor__ < 304)
@@ -236,8 +253,247 @@ static void DecodeDXTBlock(u32 *dst, const DXTBlock *src, int pitch)
 // TODO: complete SSE2 optimization of less often used texture formats.
 // TODO: refactor algorithms using _mm_loadl_epi64 unaligned loads to prefer 128-bit aligned loads.
 
+#ifdef TEXDECODER_AVX2
+static void DecodePalette(u32* palette, const u8* tlut_, int num_colors, TlutFormat tlutfmt)
+{
+	const u16* tlut = (u16*) tlut_;
+	for (int i = 0; i < num_colors; i++)
+	{
+		switch (tlutfmt)
+		{
+		case GX_TL_IA8:
+			palette[i] = DecodePixel_IA8(tlut[i]);
+			break;
+		case GX_TL_RGB565:
+			palette[i] = DecodePixel_RGB565(Common::swap16(tlut[i]));
+			break;
+		case GX_TL_RGB5A3:
+			palette[i] = DecodePixel_RGB5A3(Common::swap16(tlut[i]));
+			break;
+		}
+	}
+}
+
+// Writes the lower half of a register to one row and the upper half to the next.
+static inline FUNCTION_TARGET_AVX2 void Store2Rows(u32* dst, int width, __m256i rgba)
+{
+	_mm_storeu_si128((__m128i*)dst, _mm256_castsi256_si128(rgba));
+	_mm_storeu_si128((__m128i*)(dst + width), _mm256_extracti128_si256(rgba, 1));
+}
+
+// Loads two rows of four big-endian 16-bit texels and zero-extends each texel to 32 bits.
+static inline FUNCTION_TARGET_AVX2 __m256i Load2RowsBE16(const u8* src)
+{
+	const __m128i kSwap16 = _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+	return _mm256_cvtepu16_epi32(_mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)src), kSwap16));
+}
+
+// Decodes the formats that map well onto 8 texels per register. Returns PC_TEX_FMT_NONE for the
+// others, which then take the SSE paths below.
+static FUNCTION_TARGET_AVX2 PC_TexFormat DecodeImplAVX2(u32* dst, const u8* src, int width, int height, int texformat, const u8* tlut, TlutFormat tlutfmt)
+{
+	const int Wsteps4 = (width + 3) / 4;
+	const int Wsteps8 = (width + 7) / 8;
+
+	// Replicates byte n of the low 8 bytes of each lane into 32-bit word n.
+	const __m256i kExpand8 = _mm256_setr_epi8(0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3,
+	                                          4, 4, 4, 4, 5, 5, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7);
+	const __m256i kNibbleLo = _mm256_set1_epi8(0x0f);
+	const __m256i kNibbleHi = _mm256_set1_epi8((char)0xf0);
+	const __m256i kAlpha = _mm256_set1_epi32(0xFF000000);
+
+	switch (texformat)
+	{
+	case GX_TF_I4:
+		{
+			// Each byte holds two texels, the high nibble first.
+			const __m256i kExpand4 = _mm256_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1,
+			                                          2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3);
+			for (int y = 0; y < height; y += 8)
+				for (int x = 0, yStep = (y / 8) * Wsteps8; x < width; x += 8, yStep++)
+					for (int iy = 0, xStep = 8 * yStep; iy < 8; iy++, xStep++)
+					{
+						const __m256i r = _mm256_shuffle_epi8(_mm256_set1_epi32(*(const u32*)(src + 4 * xStep)), kExpand4);
+						const __m256i hi = _mm256_and_si256(r, kNibbleHi);
+						const __m256i lo = _mm256_and_si256(r, kNibbleLo);
+						const __m256i i0 = _mm256_or_si256(hi, _mm256_srli_epi16(hi, 4));
+						const __m256i i1 = _mm256_or_si256(lo, _mm256_slli_epi16(lo, 4));
+						_mm256_storeu_si256((__m256i*)(dst + (y + iy) * width + x), _mm256_blend_epi32(i0, i1, 0xAA));
+					}
+		}
+		break;
+	case GX_TF_I8:
+		{
+			for (int y = 0; y < height; y += 4)
+				for (int x = 0, yStep = (y / 4) * Wsteps8; x < width; x += 8, yStep++)
+					for (int iy = 0, xStep = 4 * yStep; iy < 4; iy++, xStep++)
+					{
+						const __m256i r = _mm256_broadcastq_epi64(_mm_loadl_epi64((const __m128i*)(src + 8 * xStep)));
+						_mm256_storeu_si256((__m256i*)(dst + (y + iy) * width + x), _mm256_shuffle_epi8(r, kExpand8));
+					}
+		}
+		break;
+	case GX_TF_IA4:
+		{
+			// Alpha is in the high nibble, intensity in the low one.
+			for (int y = 0; y < height; y += 4)
+				for (int x = 0, yStep = (y / 4) * Wsteps8; x < width; x += 8, yStep++)
+					for (int iy = 0, xStep = 4 * yStep; iy < 4; iy++, xStep++)
+					{
+						const __m256i r = _mm256_shuffle_epi8(_mm256_broadcastq_epi64(_mm_loadl_epi64((const __m128i*)(src + 8 * xStep))), kExpand8);
+						const __m256i a = _mm256_and_si256(r, kNibbleHi);
+						const __m256i l = _mm256_and_si256(r, kNibbleLo);
+						const __m256i a8 = _mm256_and_si256(_mm256_or_si256(a, _mm256_srli_epi32(a, 4)), kAlpha);
+						const __m256i l8 = _mm256_andnot_si256(kAlpha, _mm256_or_si256(l, _mm256_slli_epi32(l, 4)));
+						_mm256_storeu_si256((__m256i*)(dst + (y + iy) * width + x), _mm256_or_si256(a8, l8));
+					}
+		}
+		break;
+	case GX_TF_IA8:
+		{
+			// Each texel is alpha followed by intensity: (A I) -> (I I I A)
+			const __m256i mask = _mm256_setr_epi8(1, 1, 1, 0, 3, 3, 3, 2, 5, 5, 5, 4, 7, 7, 7, 6,
+			                                      1, 1, 1, 0, 3, 3, 3, 2, 5, 5, 5, 4, 7, 7, 7, 6);
+			for (int y = 0; y < height; y += 4)
+				for (int x = 0, yStep = (y / 4) * Wsteps4; x < width; x += 4, yStep++)
+					for (int iy = 0, xStep = 4 * yStep; iy < 4; iy += 2, xStep += 2)
+					{
+						// Put the first row in the low lane and the second in the high lane.
+						const __m256i r = _mm256_permute4x64_epi64(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)(src + 8 * xStep))), 0x50);
+						Store2Rows(dst + (y + iy) * width + x, width, _mm256_shuffle_epi8(r, mask));
+					}
+		}
+		break;
+	case GX_TF_RGB565:
+		{
+			const __m256i kMask_x1f = _mm256_set1_epi32(0x1f);
+			const __m256i kMask_x3f = _mm256_set1_epi32(0x3f);
+			for (int y = 0; y < height; y += 4)
+				for (int x = 0, yStep = (y / 4) * Wsteps4; x < width; x += 4, yStep++)
+					for (int iy = 0, xStep = 4 * yStep; iy < 4; iy += 2, xStep += 2)
+					{
+						const __m256i val = Load2RowsBE16(src + 8 * xStep);
+						const __m256i r = _mm256_srli_epi32(val, 11);
+						const __m256i g = _mm256_and_si256(_mm256_srli_epi32(val, 5), kMask_x3f);
+						const __m256i b = _mm256_and_si256(val, kMask_x1f);
+						const __m256i r8 = _mm256_or_si256(_mm256_slli_epi32(r, 3), _mm256_srli_epi32(r, 2));
+						const __m256i g8 = _mm256_or_si256(_mm256_slli_epi32(g, 2), _mm256_srli_epi32(g, 4));
+						const __m256i b8 = _mm256_or_si256(_mm256_slli_epi32(b, 3), _mm256_srli_epi32(b, 2));
+						const __m256i rgba = _mm256_or_si256(_mm256_or_si256(r8, _mm256_slli_epi32(g8, 8)),
+						                                     _mm256_or_si256(_mm256_slli_epi32(b8, 16), kAlpha));
+						Store2Rows(dst + (y + iy) * width + x, width, rgba);
+					}
+		}
+		break;
+	case GX_TF_RGB5A3:
+		{
+			const __m256i kMask_x1f = _mm256_set1_epi32(0x1f);
+			const __m256i kMask_x0f = _mm256_set1_epi32(0x0f);
+			const __m256i kMask_x07 = _mm256_set1_epi32(0x07);
+			for (int y = 0; y < height; y += 4)
+				for (int x = 0, yStep = (y / 4) * Wsteps4; x < width; x += 4, yStep++)
+					for (int iy = 0, xStep = 4 * yStep; iy < 4; iy += 2, xStep += 2)
+					{
+						const __m256i val = Load2RowsBE16(src + 8 * xStep);
+
+						// Top bit set: RGB555 with opaque alpha
+						const __m256i r5 = _mm256_and_si256(_mm256_srli_epi32(val, 10), kMask_x1f);
+						const __m256i g5 = _mm256_and_si256(_mm256_srli_epi32(val, 5), kMask_x1f);
+						const __m256i b5 = _mm256_and_si256(val, kMask_x1f);
+						const __m256i r58 = _mm256_or_si256(_mm256_slli_epi32(r5, 3), _mm256_srli_epi32(r5, 2));
+						const __m256i g58 = _mm256_or_si256(_mm256_slli_epi32(g5, 3), _mm256_srli_epi32(g5, 2));
+						const __m256i b58 = _mm256_or_si256(_mm256_slli_epi32(b5, 3), _mm256_srli_epi32(b5, 2));
+						const __m256i rgb555 = _mm256_or_si256(_mm256_or_si256(r58, _mm256_slli_epi32(g58, 8)),
+						                                       _mm256_or_si256(_mm256_slli_epi32(b58, 16), kAlpha));
+
+						// Top bit clear: RGB4A3
+						const __m256i a3 = _mm256_and_si256(_mm256_srli_epi32(val, 12), kMask_x07);
+						const __m256i r4 = _mm256_and_si256(_mm256_srli_epi32(val, 8), kMask_x0f);
+						const __m256i g4 = _mm256_and_si256(_mm256_srli_epi32(val, 4), kMask_x0f);
+						const __m256i b4 = _mm256_and_si256(val, kMask_x0f);
+						const __m256i a38 = _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi32(a3, 5), _mm256_slli_epi32(a3, 2)), _mm256_srli_epi32(a3, 1));
+						const __m256i rgb4 = _mm256_or_si256(_mm256_or_si256(r4, _mm256_slli_epi32(g4, 8)), _mm256_slli_epi32(b4, 16));
+						const __m256i rgb4a3 = _mm256_or_si256(_mm256_or_si256(rgb4, _mm256_slli_epi32(rgb4, 4)), _mm256_slli_epi32(a38, 24));
+
+						const __m256i opaque = _mm256_srai_epi32(_mm256_slli_epi32(val, 16), 31);
+						Store2Rows(dst + (y + iy) * width + x, width, _mm256_blendv_epi8(rgb4a3, rgb555, opaque));
+					}
+		}
+		break;
+	case GX_TF_RGBA8:
+		{
+			// The 32 bytes of AR pairs of a block are followed by its 32 bytes of GB pairs.
+			for (int y = 0; y < height; y += 4)
+				for (int x = 0, yStep = (y / 4) * Wsteps4; x < width; x += 4, yStep++)
+				{
+					const u8* src2 = src + 64 * yStep;
+					for (int iy = 0; iy < 4; iy += 2)
+					{
+						// (0 0 R A) and (0 0 B G) -> (A B G R)
+						const __m256i ar = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)(src2 + 8 * iy)));
+						const __m256i gb = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)(src2 + 32 + 8 * iy)));
+						const __m256i rgba = _mm256_or_si256(_mm256_or_si256(_mm256_srli_epi32(ar, 8), _mm256_slli_epi32(ar, 24)),
+						                                     _mm256_slli_epi32(gb, 8));
+						Store2Rows(dst + (y + iy) * width + x, width, rgba);
+					}
+				}
+		}
+		break;
+	case GX_TF_C4:
+		{
+			if (tlutfmt != GX_TL_IA8 && tlutfmt != GX_TL_RGB565 && tlutfmt != GX_TL_RGB5A3)
+				return PC_TEX_FMT_NONE;
+
+			GC_ALIGNED32(u32 palette[16]);
+			DecodePalette(palette, tlut, 16, tlutfmt);
+			// The high nibble of each byte is the first texel.
+			const __m256i kShift = _mm256_setr_epi32(4, 0, 4, 0, 4, 0, 4, 0);
+			const __m256i kMask_x0f32 = _mm256_set1_epi32(0x0f);
+			for (int y = 0; y < height; y += 8)
+				for (int x = 0, yStep = (y / 8) * Wsteps8; x < width; x += 8, yStep++)
+					for (int iy = 0, xStep = 8 * yStep; iy < 8; iy++, xStep++)
+					{
+						const __m128i r = _mm_cvtsi32_si128(*(const u32*)(src + 4 * xStep));
+						const __m256i idx = _mm256_and_si256(_mm256_srlv_epi32(_mm256_cvtepu8_epi32(_mm_unpacklo_epi8(r, r)), kShift), kMask_x0f32);
+						_mm256_storeu_si256((__m256i*)(dst + (y + iy) * width + x), _mm256_i32gather_epi32((const int*)palette, idx, 4));
+					}
+		}
+		break;
+	case GX_TF_C8:
+		{
+			if (tlutfmt != GX_TL_IA8 && tlutfmt != GX_TL_RGB565 && tlutfmt != GX_TL_RGB5A3)
+				return PC_TEX_FMT_NONE;
+
+			GC_ALIGNED32(u32 palette[256]);
+			DecodePalette(palette, tlut, 256, tlutfmt);
+			for (int y = 0; y < height; y += 4)
+				for (int x = 0, yStep = (y / 4) * Wsteps8; x < width; x += 8, yStep++)
+					for (int iy = 0, xStep = 4 * yStep; iy < 4; iy++, xStep++)
+					{
+						const __m256i idx = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(src + 8 * xStep)));
+						_mm256_storeu_si256((__m256i*)(dst + (y + iy) * width + x), _mm256_i32gather_epi32((const int*)palette, idx, 4));
+					}
+		}
+		break;
+	default:
+		return PC_TEX_FMT_NONE;
+	}
+
+	return PC_TEX_FMT_RGBA32;
+}
+#endif
+
 PC_TexFormat _TexDecoder_DecodeImpl(u32 * dst, const u8 * src, int width, int height, int texformat, const u8* tlut, TlutFormat tlutfmt)
 {
+#ifdef TEXDECODER_AVX2
+	if (cpu_info.bAVX2)
+	{
+		PC_TexFormat pc_texformat = DecodeImplAVX2(dst, src, width, height, texformat, tlut, tlutfmt);
+		if (pc_texformat != PC_TEX_FMT_NONE)
+			return pc_texformat;
+	}
+#endif
+
 	const int Wsteps4 = (width + 3) / 4;
 	const int Wsteps8 = (width + 7) / 8;
 
@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include "Common/CommonTypes.h"
+#include "Common/CPUDetect.h"
 #include "Common/MemoryUtil.h"
 #include "Common/StringUtil.h"
 #include "Common/x64ABI.h"
@@ -30,12 +31,14 @@
 	#define inline
 #endif
 
+#ifndef USE_VERTEX_LOADER_JIT
 // Matrix components are first in GC format but later in PC format - we need to store it temporarily
 // when decoding each vertex.
 static u8 s_curposmtx = g_main_cp_state.matrix_index_a.PosNormalMtxIdx;
 static u8 s_curtexmtx[8];
 static int s_texmtxwrite = 0;
 static int s_texmtxread = 0;
+#endif
 
 // Vertex loaders read these. Although the scale ones should be baked into the shader.
 int tcIndex;
@@ -58,6 +61,25 @@ static const float fractionTable[32] = {
 
 using namespace Gen;
 
+#ifdef USE_VERTEX_LOADER_JIT
+// Callee saved, so they survive the bounding box calls.
+static const X64Reg src_reg = R12;
+static const X64Reg dst_reg = R13;
+
+// Component size of each vertex format.
+static const int s_format_size[5] = {1, 1, 2, 2, 4};
+
+// Byte shuffles for PSHUFB: swap and widen each component into its own 32-bit
+// lane. The "hi" variants put the value in the top bits for an arithmetic
+// shift to sign extend.
+static const u8 GC_ALIGNED16(s_shuffle_swap32[16]) = { 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 0x80, 0x80, 0x80, 0x80 };
+static const u8 GC_ALIGNED16(s_shuffle_8to32lo[16]) = { 0, 0x80, 0x80, 0x80, 1, 0x80, 0x80, 0x80, 2, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 };
+static const u8 GC_ALIGNED16(s_shuffle_8to32hi[16]) = { 0x80, 0x80, 0x80, 0, 0x80, 0x80, 0x80, 1, 0x80, 0x80, 0x80, 2, 0x80, 0x80, 0x80, 0x80 };
+static const u8 GC_ALIGNED16(s_shuffle_swap16to32lo[16]) = { 1, 0, 0x80, 0x80, 3, 2, 0x80, 0x80, 5, 4, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 };
+static const u8 GC_ALIGNED16(s_shuffle_swap16to32hi[16]) = { 0x80, 0x80, 1, 0, 0x80, 0x80, 3, 2, 0x80, 0x80, 5, 4, 0x80, 0x80, 0x80, 0x80 };
+#endif
+
+#ifndef USE_VERTEX_LOADER_JIT
 static void LOADERDECL PosMtx_ReadDirect_UByte()
 {
 	BoundingBox::posMtxIdx = s_curposmtx = DataReadU8() & 0x3f;
@@ -104,6 +126,8 @@ static void LOADERDECL TexMtx_Write_Float4()
 #endif
 }
 
+#endif
+
 VertexLoader::VertexLoader(const TVtxDesc &vtx_desc, const VAT &vtx_attr)
 {
 	m_compiledCode = nullptr;
@@ -145,31 +169,17 @@ void VertexLoader::CompileVertexTranslator()
 		PanicAlert("Trying to recompile a vertex translator");
 
 	m_compiledCode = GetCodePtr();
-	// We only use RAX (caller saved) and RBX (callee saved).
-	ABI_PushRegistersAndAdjustStack({RBX}, 8);
+	// RBX holds the count, and the source and destination pointers live in
+	// R12 and R13 for the whole loop. Everything else is scratch.
+	ABI_PushRegistersAndAdjustStack({RBX, src_reg, dst_reg}, 8);
 
 	// save count
 	MOV(64, R(RBX), R(ABI_PARAM1));
+	WriteGetVariable(64, R(src_reg), &g_video_buffer_read_ptr);
+	WriteGetVariable(64, R(dst_reg), &VertexManager::s_pCurBufferPointer);
 
 	// Start loop here
 	const u8 *loop_start = GetCodePtr();
-
-	// Reset component counters if present in vertex format only.
-	if (m_VtxDesc.Tex0Coord || m_VtxDesc.Tex1Coord || m_VtxDesc.Tex2Coord || m_VtxDesc.Tex3Coord ||
-		m_VtxDesc.Tex4Coord || m_VtxDesc.Tex5Coord || m_VtxDesc.Tex6Coord || m_VtxDesc.Tex7Coord)
-	{
-		WriteSetVariable(32, &tcIndex, Imm32(0));
-	}
-	if (m_VtxDesc.Color0 || m_VtxDesc.Color1)
-	{
-		WriteSetVariable(32, &colIndex, Imm32(0));
-	}
-	if (m_VtxDesc.Tex0MatIdx || m_VtxDesc.Tex1MatIdx || m_VtxDesc.Tex2MatIdx || m_VtxDesc.Tex3MatIdx ||
-		m_VtxDesc.Tex4MatIdx || m_VtxDesc.Tex5MatIdx || m_VtxDesc.Tex6MatIdx || m_VtxDesc.Tex7MatIdx)
-	{
-		WriteSetVariable(32, &s_texmtxwrite, Imm32(0));
-		WriteSetVariable(32, &s_texmtxread, Imm32(0));
-	}
 #else
 	// Reset pipeline
 	m_numPipelineStages = 0;
@@ -177,7 +187,12 @@ void VertexLoader::CompileVertexTranslator()
 
 	// Get the pointer to this vertex's buffer data for the bounding box
 	if (!g_ActiveConfig.backend_info.bSupportsBBox)
+	{
+#ifdef USE_VERTEX_LOADER_JIT
+		WriteSetVariable(64, &VertexManager::s_pCurBufferPointer, R(dst_reg));
+#endif
 		WriteCall(BoundingBox::SetVertexBufferPosition);
+	}
 
 	// Colors
 	const u64 col[2] = {m_VtxDesc.Color0, m_VtxDesc.Color1};
@@ -186,6 +201,10 @@ void VertexLoader::CompileVertexTranslator()
 		m_VtxDesc.Tex0Coord, m_VtxDesc.Tex1Coord, m_VtxDesc.Tex2Coord, m_VtxDesc.Tex3Coord,
 		m_VtxDesc.Tex4Coord, m_VtxDesc.Tex5Coord, m_VtxDesc.Tex6Coord, m_VtxDesc.Tex7Coord
 	};
+	const u64 tm[8] = {
+		m_VtxDesc.Tex0MatIdx, m_VtxDesc.Tex1MatIdx, m_VtxDesc.Tex2MatIdx, m_VtxDesc.Tex3MatIdx,
+		m_VtxDesc.Tex4MatIdx, m_VtxDesc.Tex5MatIdx, m_VtxDesc.Tex6MatIdx, m_VtxDesc.Tex7MatIdx
+	};
 
 	u32 components = 0;
 
@@ -196,22 +215,45 @@ void VertexLoader::CompileVertexTranslator()
 	// Position Matrix Index
 	if (m_VtxDesc.PosMatIdx)
 	{
+#ifndef USE_VERTEX_LOADER_JIT
 		WriteCall(PosMtx_ReadDirect_UByte);
+#endif
 		components |= VB_HAS_POSMTXIDX;
 		m_VertexSize += 1;
 	}
 
-	if (m_VtxDesc.Tex0MatIdx) {m_VertexSize += 1; components |= VB_HAS_TEXMTXIDX0; WriteCall(TexMtx_ReadDirect_UByte); }
-	if (m_VtxDesc.Tex1MatIdx) {m_VertexSize += 1; components |= VB_HAS_TEXMTXIDX1; WriteCall(TexMtx_ReadDirect_UByte); }
-	if (m_VtxDesc.Tex2MatIdx) {m_VertexSize += 1; components |= VB_HAS_TEXMTXIDX2; WriteCall(TexMtx_ReadDirect_UByte); }
-	if (m_VtxDesc.Tex3MatIdx) {m_VertexSize += 1; components |= VB_HAS_TEXMTXIDX3; WriteCall(TexMtx_ReadDirect_UByte); }
-	if (m_VtxDesc.Tex4MatIdx) {m_VertexSize += 1; components |= VB_HAS_TEXMTXIDX4; WriteCall(TexMtx_ReadDirect_UByte); }
-	if (m_VtxDesc.Tex5MatIdx) {m_VertexSize += 1; components |= VB_HAS_TEXMTXIDX5; WriteCall(TexMtx_ReadDirect_UByte); }
-	if (m_VtxDesc.Tex6MatIdx) {m_VertexSize += 1; components |= VB_HAS_TEXMTXIDX6; WriteCall(TexMtx_ReadDirect_UByte); }
-	if (m_VtxDesc.Tex7MatIdx) {m_VertexSize += 1; components |= VB_HAS_TEXMTXIDX7; WriteCall(TexMtx_ReadDirect_UByte); }
+	// Texture matrix indices, in the order they appear in the GC vertex.
+	// The JIT reads them where they are used instead.
+	int texmtx_offset[8];
+	for (int i = 0; i < 8; i++)
+	{
+		if (tm[i])
+		{
+			texmtx_offset[i] = m_VertexSize;
+			m_VertexSize += 1;
+			components |= VB_HAS_TEXMTXIDX0 << i;
+#ifndef USE_VERTEX_LOADER_JIT
+			WriteCall(TexMtx_ReadDirect_UByte);
+#endif
+		}
+	}
+
+#ifdef USE_VERTEX_LOADER_JIT
+	m_src_offset = m_VertexSize;
+#endif
 
 	// Write vertex position loader
+#ifdef USE_VERTEX_LOADER_JIT
+	{
+		int elements = m_VtxAttr.PosElements ? 3 : 2;
+		int offset;
+		X64Reg base = WriteGetVertexAddr(ARRAY_POSITION, m_VtxDesc.Position,
+			VertexLoader_Position::GetSize(m_VtxDesc.Position, m_VtxAttr.PosFormat, m_VtxAttr.PosElements), &offset);
+		WriteReadVertex(base, offset, m_VtxAttr.PosFormat, elements, 3, posScale, 0);
+	}
+#else
 	WriteCall(VertexLoader_Position::GetFunction(m_VtxDesc.Position, m_VtxAttr.PosFormat, m_VtxAttr.PosElements));
+#endif
 
 	m_VertexSize += VertexLoader_Position::GetSize(m_VtxDesc.Position, m_VtxAttr.PosFormat, m_VtxAttr.PosElements);
 	nat_offset += 12;
@@ -224,9 +266,41 @@ void VertexLoader::CompileVertexTranslator()
 	// Normals
 	if (m_VtxDesc.Normal != NOT_PRESENT)
 	{
-		m_VertexSize += VertexLoader_Normal::GetSize(m_VtxDesc.Normal,
+		int normal_size = VertexLoader_Normal::GetSize(m_VtxDesc.Normal,
 			m_VtxAttr.NormalFormat, m_VtxAttr.NormalElements, m_VtxAttr.NormalIndex3);
+		m_VertexSize += normal_size;
 
+#ifdef USE_VERTEX_LOADER_JIT
+		// Normals have a fixed scale that depends on the format only.
+		static const float GC_ALIGNED16(s_normal_scale[5][4]) = {
+			{1.0f / (1 << 7), 1.0f / (1 << 7), 1.0f / (1 << 7), 1.0f / (1 << 7)},
+			{1.0f / (1 << 6), 1.0f / (1 << 6), 1.0f / (1 << 6), 1.0f / (1 << 6)},
+			{1.0f / (1 << 15), 1.0f / (1 << 15), 1.0f / (1 << 15), 1.0f / (1 << 15)},
+			{1.0f / (1 << 14), 1.0f / (1 << 14), 1.0f / (1 << 14), 1.0f / (1 << 14)},
+			{1.0f, 1.0f, 1.0f, 1.0f},
+		};
+		const int format = m_VtxAttr.NormalFormat;
+		const int elem_size = s_format_size[format];
+		const float* scale = format == FORMAT_FLOAT ? nullptr : s_normal_scale[format];
+
+		if (m_VtxAttr.NormalElements && m_VtxAttr.NormalIndex3 && m_VtxDesc.Normal != DIRECT)
+		{
+			// Normal, binormal and tangent each have their own index.
+			for (int i = 0; i < 3; i++)
+			{
+				int offset;
+				X64Reg base = WriteGetVertexAddr(ARRAY_NORMAL, m_VtxDesc.Normal, 0, &offset);
+				WriteReadVertex(base, offset + i * 3 * elem_size, format, 3, 3, scale, nat_offset + i * 12);
+			}
+		}
+		else
+		{
+			int offset;
+			X64Reg base = WriteGetVertexAddr(ARRAY_NORMAL, m_VtxDesc.Normal, normal_size, &offset);
+			for (int i = 0; i < (m_VtxAttr.NormalElements ? 3 : 1); i++)
+				WriteReadVertex(base, offset + i * 3 * elem_size, format, 3, 3, scale, nat_offset + i * 12);
+		}
+#else
 		TPipelineFunction pFunc = VertexLoader_Normal::GetFunction(m_VtxDesc.Normal,
 			m_VtxAttr.NormalFormat, m_VtxAttr.NormalElements, m_VtxAttr.NormalIndex3);
 
@@ -237,6 +311,7 @@ void VertexLoader::CompileVertexTranslator()
 				m_VtxAttr.NormalElements, m_VtxAttr.NormalIndex3);
 		}
 		WriteCall(pFunc);
+#endif
 
 		for (int i = 0; i < (vtx_attr.NormalElements ? 3 : 1); i++)
 		{
@@ -253,62 +328,52 @@ void VertexLoader::CompileVertexTranslator()
 			components |= VB_HAS_NRM1 | VB_HAS_NRM2;
 	}
 
+	// Like the colIndex counter of the C loaders, colors are looked up in
+	// array/elements slots by the number of colors read so far.
+	static const int s_color_size[6] = {2, 3, 4, 2, 3, 4};
+#ifndef USE_VERTEX_LOADER_JIT
+	static const TPipelineFunction s_color_read[3][6] = {
+		{Color_ReadDirect_16b_565, Color_ReadDirect_24b_888, Color_ReadDirect_32b_888x,
+		 Color_ReadDirect_16b_4444, Color_ReadDirect_24b_6666, Color_ReadDirect_32b_8888},
+		{Color_ReadIndex8_16b_565, Color_ReadIndex8_24b_888, Color_ReadIndex8_32b_888x,
+		 Color_ReadIndex8_16b_4444, Color_ReadIndex8_24b_6666, Color_ReadIndex8_32b_8888},
+		{Color_ReadIndex16_16b_565, Color_ReadIndex16_24b_888, Color_ReadIndex16_32b_888x,
+		 Color_ReadIndex16_16b_4444, Color_ReadIndex16_24b_6666, Color_ReadIndex16_32b_8888},
+	};
+#endif
+	int col_index = 0;
 	for (int i = 0; i < 2; i++)
 	{
 		m_native_vtx_decl.colors[i].components = 4;
 		m_native_vtx_decl.colors[i].type = VAR_UNSIGNED_BYTE;
 		m_native_vtx_decl.colors[i].integer = false;
-		switch (col[i])
-		{
-		case NOT_PRESENT:
-			break;
-		case DIRECT:
-			switch (m_VtxAttr.color[i].Comp)
-			{
-			case FORMAT_16B_565:  m_VertexSize += 2; WriteCall(Color_ReadDirect_16b_565); break;
-			case FORMAT_24B_888:  m_VertexSize += 3; WriteCall(Color_ReadDirect_24b_888); break;
-			case FORMAT_32B_888x: m_VertexSize += 4; WriteCall(Color_ReadDirect_32b_888x); break;
-			case FORMAT_16B_4444: m_VertexSize += 2; WriteCall(Color_ReadDirect_16b_4444); break;
-			case FORMAT_24B_6666: m_VertexSize += 3; WriteCall(Color_ReadDirect_24b_6666); break;
-			case FORMAT_32B_8888: m_VertexSize += 4; WriteCall(Color_ReadDirect_32b_8888); break;
-			default: _assert_(0); break;
-			}
-			break;
-		case INDEX8:
-			m_VertexSize += 1;
-			switch (m_VtxAttr.color[i].Comp)
-			{
-			case FORMAT_16B_565:  WriteCall(Color_ReadIndex8_16b_565); break;
-			case FORMAT_24B_888:  WriteCall(Color_ReadIndex8_24b_888); break;
-			case FORMAT_32B_888x: WriteCall(Color_ReadIndex8_32b_888x); break;
-			case FORMAT_16B_4444: WriteCall(Color_ReadIndex8_16b_4444); break;
-			case FORMAT_24B_6666: WriteCall(Color_ReadIndex8_24b_6666); break;
-			case FORMAT_32B_8888: WriteCall(Color_ReadIndex8_32b_8888); break;
-			default: _assert_(0); break;
-			}
-			break;
-		case INDEX16:
-			m_VertexSize += 2;
-			switch (m_VtxAttr.color[i].Comp)
-			{
-			case FORMAT_16B_565:  WriteCall(Color_ReadIndex16_16b_565); break;
-			case FORMAT_24B_888:  WriteCall(Color_ReadIndex16_24b_888); break;
-			case FORMAT_32B_888x: WriteCall(Color_ReadIndex16_32b_888x); break;
-			case FORMAT_16B_4444: WriteCall(Color_ReadIndex16_16b_4444); break;
-			case FORMAT_24B_6666: WriteCall(Color_ReadIndex16_24b_6666); break;
-			case FORMAT_32B_8888: WriteCall(Color_ReadIndex16_32b_8888); break;
-			default: _assert_(0); break;
-			}
-			break;
-		}
-		// Common for the three bottom cases
-		if (col[i] != NOT_PRESENT)
+
+		if (col[i] == NOT_PRESENT)
+			continue;
+
+		const int comp = m_VtxAttr.color[i].Comp;
+		if (comp > FORMAT_32B_8888)
 		{
-			components |= VB_HAS_COL0 << i;
-			m_native_vtx_decl.colors[i].offset = nat_offset;
-			m_native_vtx_decl.colors[i].enable = true;
-			nat_offset += 4;
+			_assert_(0);
+			continue;
 		}
+
+		const int size = col[i] == DIRECT ? s_color_size[comp] : col[i] == INDEX8 ? 1 : 2;
+#ifdef USE_VERTEX_LOADER_JIT
+		int offset;
+		X64Reg base = WriteGetVertexAddr(ARRAY_COLOR + col_index, col[i], size, &offset);
+		bool force_alpha = col[i] == DIRECT && !m_VtxAttr.color[col_index].Elements;
+		WriteReadColor(base, offset, comp, force_alpha, nat_offset);
+#else
+		WriteCall(s_color_read[col[i] - DIRECT][comp]);
+#endif
+		m_VertexSize += size;
+
+		components |= VB_HAS_COL0 << i;
+		m_native_vtx_decl.colors[i].offset = nat_offset;
+		m_native_vtx_decl.colors[i].enable = true;
+		nat_offset += 4;
+		col_index++;
 	}
 
 	// Texture matrix indices (remove if corresponding texture coordinate isn't enabled)
@@ -332,7 +397,14 @@ void VertexLoader::CompileVertexTranslator()
 			_assert_msg_(VIDEO, 0 <= elements && elements <= 1, "Invalid number of texture coordinates elements!\n(elements = %d)", elements);
 
 			components |= VB_HAS_UV0 << i;
+#ifdef USE_VERTEX_LOADER_JIT
+			int offset;
+			X64Reg base = WriteGetVertexAddr(ARRAY_TEXCOORD0 + i, tc[i],
+				VertexLoader_TextCoord::GetSize(tc[i], format, elements), &offset);
+			WriteReadVertex(base, offset, format, elements + 1, elements + 1, tcScale[i], nat_offset);
+#else
 			WriteCall(VertexLoader_TextCoord::GetFunction(tc[i], format, elements));
+#endif
 			m_VertexSize += VertexLoader_TextCoord::GetSize(tc[i], format, elements);
 		}
 
@@ -343,15 +415,32 @@ void VertexLoader::CompileVertexTranslator()
 			{
 				// if texmtx is included, texcoord will always be 3 floats, z will be the texmtx index
 				m_native_vtx_decl.texcoords[i].components = 3;
-				nat_offset += 12;
+#ifdef USE_VERTEX_LOADER_JIT
+				if (!m_VtxAttr.texCoord[i].Elements)
+					MOV(32, MDisp(dst_reg, nat_offset + 4), Imm32(0));
+				WriteReadMatrixIndex(RCX, texmtx_offset[i]);
+				CVTSI2SS(XMM0, R(RCX));
+				MOVSS(MDisp(dst_reg, nat_offset + 8), XMM0);
+#else
 				WriteCall(m_VtxAttr.texCoord[i].Elements ? TexMtx_Write_Float : TexMtx_Write_Float2);
+#endif
+				nat_offset += 12;
 			}
 			else
 			{
 				components |= VB_HAS_UV0 << i; // have to include since using now
 				m_native_vtx_decl.texcoords[i].components = 4;
-				nat_offset += 16; // still include the texture coordinate, but this time as 6 + 2 bytes
+#ifdef USE_VERTEX_LOADER_JIT
+				WriteReadMatrixIndex(RCX, texmtx_offset[i]);
+				CVTSI2SS(XMM0, R(RCX));
+				MOV(32, MDisp(dst_reg, nat_offset), Imm32(0));
+				MOV(32, MDisp(dst_reg, nat_offset + 4), Imm32(0));
+				MOVSS(MDisp(dst_reg, nat_offset + 8), XMM0);
+				MOV(32, MDisp(dst_reg, nat_offset + 12), Imm32(0));
+#else
 				WriteCall(TexMtx_Write_Float4);
+#endif
+				nat_offset += 16; // still include the texture coordinate, but this time as 6 + 2 bytes
 			}
 		}
 		else
@@ -372,7 +461,9 @@ void VertexLoader::CompileVertexTranslator()
 			{
 				if (tc[j] != NOT_PRESENT)
 				{
+#ifndef USE_VERTEX_LOADER_JIT
 					WriteCall(VertexLoader_TextCoord::GetDummyFunction()); // important to get indices right!
+#endif
 					break;
 				}
 			}
@@ -387,11 +478,34 @@ void VertexLoader::CompileVertexTranslator()
 
 	// Update the bounding box
 	if (!g_ActiveConfig.backend_info.bSupportsBBox)
+	{
+#ifdef USE_VERTEX_LOADER_JIT
+		// The bounding box expects the matrix indices the C loaders would have stored.
+		if (m_VtxDesc.PosMatIdx)
+		{
+			WriteReadMatrixIndex(RCX, 0);
+			WriteSetVariable(8, &BoundingBox::posMtxIdx, R(RCX));
+		}
+		for (int i = 0, slot = 0; i < 8; i++)
+		{
+			if (tm[i])
+			{
+				WriteReadMatrixIndex(RCX, texmtx_offset[i]);
+				WriteSetVariable(8, &BoundingBox::texMtxIdx[slot++], R(RCX));
+			}
+		}
+#endif
 		WriteCall(BoundingBox::Update);
+	}
 
 	if (m_VtxDesc.PosMatIdx)
 	{
+#ifdef USE_VERTEX_LOADER_JIT
+		WriteReadMatrixIndex(RCX, 0);
+		MOV(32, MDisp(dst_reg, nat_offset), R(RCX));
+#else
 		WriteCall(PosMtx_Write);
+#endif
 		m_native_vtx_decl.posmtx.components = 4;
 		m_native_vtx_decl.posmtx.enable = true;
 		m_native_vtx_decl.posmtx.offset = nat_offset;
@@ -404,11 +518,17 @@ void VertexLoader::CompileVertexTranslator()
 	m_native_vtx_decl.stride = nat_offset;
 
 #ifdef USE_VERTEX_LOADER_JIT
+	_assert_msg_(VIDEO, m_src_offset == m_VertexSize, "Vertex loader JIT read %i bytes, expected %i", m_src_offset, m_VertexSize);
+
 	// End loop here
+	ADD(64, R(src_reg), Imm32(m_VertexSize));
+	ADD(64, R(dst_reg), Imm32(nat_offset));
 	SUB(64, R(RBX), Imm8(1));
 
 	J_CC(CC_NZ, loop_start);
-	ABI_PopRegistersAndAdjustStack({RBX}, 8);
+	WriteSetVariable(64, &g_video_buffer_read_ptr, R(src_reg));
+	WriteSetVariable(64, &VertexManager::s_pCurBufferPointer, R(dst_reg));
+	ABI_PopRegistersAndAdjustStack({RBX, src_reg, dst_reg}, 8);
 	RET();
 #endif
 }
@@ -416,11 +536,13 @@ void VertexLoader::CompileVertexTranslator()
 void VertexLoader::WriteCall(TPipelineFunction func)
 {
 #ifdef USE_VERTEX_LOADER_JIT
+	// Only the bounding box helpers are still called from the JIT.
 	ABI_CallFunction((const void*)func);
 #else
 	m_PipelineStages[m_numPipelineStages++] = func;
 #endif
 }
+
 // ARMTODO: This should be done in a better way
 #ifndef _M_GENERIC
 void VertexLoader::WriteGetVariable(int bits, OpArg dest, void *address)
@@ -440,6 +562,250 @@ void VertexLoader::WriteSetVariable(int bits, void *address, OpArg value)
 }
 #endif
 
+#ifdef USE_VERTEX_LOADER_JIT
+X64Reg VertexLoader::WriteGetVertexAddr(int array, u64 attribute, int direct_size, int* offset)
+{
+	if (attribute == DIRECT)
+	{
+		*offset = m_src_offset;
+		m_src_offset += direct_size;
+		return src_reg;
+	}
+
+	if (attribute == INDEX8)
+	{
+		MOVZX(64, 8, RAX, MDisp(src_reg, m_src_offset));
+		m_src_offset += 1;
+	}
+	else
+	{
+		MOVZX(64, 16, RAX, MDisp(src_reg, m_src_offset));
+		ROL(16, R(RAX), Imm8(8));
+		m_src_offset += 2;
+	}
+	// Both only change when a new primitive is started, but reading them from
+	// memory is as cheap as keeping them in registers.
+	MOV(64, R(RCX), ImmPtr(&g_main_cp_state.array_strides[array]));
+	IMUL(32, RAX, MatR(RCX));
+	MOV(64, R(RCX), ImmPtr(&cached_arraybases[array]));
+	ADD(64, R(RAX), MatR(RCX));
+	*offset = 0;
+	return RAX;
+}
+
+void VertexLoader::WriteReadVertex(X64Reg base, int offset, int format, int count_in, int count_out, const float* scale, int dst_offset)
+{
+	const OpArg data = MDisp(base, offset);
+	const int load_bytes = s_format_size[format] * count_in;
+
+	// Only load the bytes we need, so missing components end up as zero.
+	switch (load_bytes)
+	{
+	case 1:
+	case 2:
+		MOVZX(32, load_bytes * 8, RCX, data);
+		MOVD_xmm(XMM0, R(RCX));
+		break;
+	case 3:
+	case 4:
+		MOVD_xmm(XMM0, data);
+		break;
+	case 6:
+	case 8:
+		MOVQ_xmm(XMM0, data);
+		break;
+	default:
+		MOVUPS(XMM0, data);
+		break;
+	}
+
+	if (cpu_info.bSSSE3)
+	{
+		const u8* shuffle;
+		switch (format)
+		{
+		case FORMAT_UBYTE:  shuffle = s_shuffle_8to32lo; break;
+		case FORMAT_BYTE:   shuffle = s_shuffle_8to32hi; break;
+		case FORMAT_USHORT: shuffle = s_shuffle_swap16to32lo; break;
+		case FORMAT_SHORT:  shuffle = s_shuffle_swap16to32hi; break;
+		default:            shuffle = s_shuffle_swap32; break;
+		}
+		MOV(64, R(RDX), ImmPtr(shuffle));
+		PSHUFB(XMM0, MatR(RDX));
+		if (format == FORMAT_BYTE)
+			PSRAD(XMM0, 24);
+		else if (format == FORMAT_SHORT)
+			PSRAD(XMM0, 16);
+	}
+	else
+	{
+		if (format == FORMAT_USHORT || format == FORMAT_SHORT || format == FORMAT_FLOAT)
+		{
+			// Swap the bytes of each 16-bit word.
+			MOVDQA(XMM1, R(XMM0));
+			PSRLW(XMM0, 8);
+			PSLLW(XMM1, 8);
+			POR(XMM0, R(XMM1));
+		}
+
+		switch (format)
+		{
+		case FORMAT_UBYTE:
+			PXOR(XMM1, R(XMM1));
+			PUNPCKLBW(XMM0, R(XMM1));
+			PUNPCKLWD(XMM0, R(XMM1));
+			break;
+		case FORMAT_BYTE:
+			PUNPCKLBW(XMM0, R(XMM0));
+			PUNPCKLWD(XMM0, R(XMM0));
+			PSRAD(XMM0, 24);
+			break;
+		case FORMAT_USHORT:
+			PXOR(XMM1, R(XMM1));
+			PUNPCKLWD(XMM0, R(XMM1));
+			break;
+		case FORMAT_SHORT:
+			PUNPCKLWD(XMM0, R(XMM0));
+			PSRAD(XMM0, 16);
+			break;
+		case FORMAT_FLOAT:
+			// Then swap the words of each dword.
+			PSHUFLW(XMM0, R(XMM0), 0xB1);
+			PSHUFHW(XMM0, R(XMM0), 0xB1);
+			break;
+		}
+	}
+
+	if (format != FORMAT_FLOAT)
+	{
+		CVTDQ2PS(XMM0, R(XMM0));
+		if (scale)
+		{
+			MOV(64, R(RDX), ImmPtr(scale));
+			if (count_in == 3)
+				MOVUPS(XMM1, MatR(RDX));
+			else
+				MOVQ_xmm(XMM1, MatR(RDX));
+			MULPS(XMM0, R(XMM1));
+		}
+	}
+
+	const OpArg dest = MDisp(dst_reg, dst_offset);
+	switch (count_out)
+	{
+	case 1:
+		MOVSS(dest, XMM0);
+		break;
+	case 2:
+		MOVQ_xmm(dest, XMM0);
+		break;
+	case 3:
+		MOVQ_xmm(dest, XMM0);
+		MOVHLPS(XMM0, XMM0);
+		MOVSS(MDisp(dst_reg, dst_offset + 8), XMM0);
+		break;
+	}
+}
+
+void VertexLoader::WriteReadColor(X64Reg base, int offset, int format, bool force_alpha, int dst_offset)
+{
+	// Same conversions as VertexLoader_Color.cpp, to AABBGGRR. The value is
+	// loaded into ECX first, so EAX is free even for indexed colors.
+	switch (format)
+	{
+	case FORMAT_24B_888:
+	case FORMAT_32B_888x:
+		MOV(32, R(EAX), MDisp(base, offset));
+		OR(32, R(EAX), Imm32(0xFF000000));
+		break;
+
+	case FORMAT_32B_8888:
+		MOV(32, R(EAX), MDisp(base, offset));
+		if (force_alpha)
+			OR(32, R(EAX), Imm32(0xFF000000));
+		break;
+
+	case FORMAT_16B_565:
+		// RRRRRGGG GGGBBBBB
+		MOVZX(32, 16, ECX, MDisp(base, offset));
+		ROL(16, R(ECX), Imm8(8));
+		MOV(32, R(EAX), R(ECX));
+		SHR(32, R(EAX), Imm8(8));
+		AND(32, R(EAX), Imm32(0xF8));
+		MOV(32, R(EDX), R(ECX));
+		SHL(32, R(EDX), Imm8(5));
+		AND(32, R(EDX), Imm32(0xFC00));
+		OR(32, R(EAX), R(EDX));
+		SHL(32, R(ECX), Imm8(19));
+		AND(32, R(ECX), Imm32(0xF80000));
+		OR(32, R(EAX), R(ECX));
+		// Replicate the top bits into the low ones.
+		MOV(32, R(ECX), R(EAX));
+		SHR(32, R(ECX), Imm8(5));
+		AND(32, R(ECX), Imm32(0x070007));
+		MOV(32, R(EDX), R(EAX));
+		SHR(32, R(EDX), Imm8(6));
+		AND(32, R(EDX), Imm32(0x000300));
+		OR(32, R(EAX), R(ECX));
+		OR(32, R(EAX), R(EDX));
+		OR(32, R(EAX), Imm32(0xFF000000));
+		break;
+
+	case FORMAT_16B_4444:
+		// BARG, read without swapping
+		MOVZX(32, 16, ECX, MDisp(base, offset));
+		MOV(32, R(EAX), R(ECX));
+		AND(32, R(EAX), Imm32(0xF0));
+		MOV(32, R(EDX), R(ECX));
+		AND(32, R(EDX), Imm32(0xF));
+		SHL(32, R(EDX), Imm8(12));
+		OR(32, R(EAX), R(EDX));
+		MOV(32, R(EDX), R(ECX));
+		AND(32, R(EDX), Imm32(0xF000));
+		SHL(32, R(EDX), Imm8(8));
+		OR(32, R(EAX), R(EDX));
+		AND(32, R(ECX), Imm32(0x0F00));
+		SHL(32, R(ECX), Imm8(20));
+		OR(32, R(EAX), R(ECX));
+		MOV(32, R(ECX), R(EAX));
+		SHR(32, R(ECX), Imm8(4));
+		OR(32, R(EAX), R(ECX));
+		break;
+
+	case FORMAT_24B_6666:
+		// RRRRRRGG GGGGBBBB BBAAAAAA, read as the low bytes of a big endian word
+		MOV(32, R(ECX), MDisp(base, offset - 1));
+		BSWAP(32, ECX);
+		MOV(32, R(EAX), R(ECX));
+		SHR(32, R(EAX), Imm8(16));
+		AND(32, R(EAX), Imm32(0xFC));
+		MOV(32, R(EDX), R(ECX));
+		SHR(32, R(EDX), Imm8(2));
+		AND(32, R(EDX), Imm32(0xFC00));
+		OR(32, R(EAX), R(EDX));
+		MOV(32, R(EDX), R(ECX));
+		SHL(32, R(EDX), Imm8(12));
+		AND(32, R(EDX), Imm32(0xFC0000));
+		OR(32, R(EAX), R(EDX));
+		SHL(32, R(ECX), Imm8(26));
+		OR(32, R(EAX), R(ECX));
+		MOV(32, R(ECX), R(EAX));
+		SHR(32, R(ECX), Imm8(6));
+		AND(32, R(ECX), Imm32(0x03030303));
+		OR(32, R(EAX), R(ECX));
+		break;
+	}
+
+	MOV(32, MDisp(dst_reg, dst_offset), R(EAX));
+}
+
+void VertexLoader::WriteReadMatrixIndex(X64Reg reg, int src_offset)
+{
+	MOVZX(32, 8, reg, MDisp(src_reg, src_offset));
+	AND(32, R(reg), Imm8(0x3F));
+}
+#endif
+
 void VertexLoader::SetupRunVertices(const VAT& vat, int primitive, int const count)
 {
 	m_numLoadedVertices += count;
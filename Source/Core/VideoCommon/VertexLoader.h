@@ -161,6 +161,16 @@ private:
 	void WriteGetVariable(int bits, Gen::OpArg dest, void *address);
 	void WriteSetVariable(int bits, void *address, Gen::OpArg dest);
 #endif
+
+#ifdef USE_VERTEX_LOADER_JIT
+	// Offset of the next attribute in the GC vertex, used while compiling.
+	int m_src_offset;
+
+	Gen::X64Reg WriteGetVertexAddr(int array, u64 attribute, int direct_size, int* offset);
+	void WriteReadVertex(Gen::X64Reg base, int offset, int format, int count_in, int count_out, const float* scale, int dst_offset);
+	void WriteReadColor(Gen::X64Reg base, int offset, int format, bool force_alpha, int dst_offset);
+	void WriteReadMatrixIndex(Gen::X64Reg reg, int src_offset);
+#endif
 };
 
 #if _M_SSE >= 0x301
@@ -108,6 +108,9 @@ void VideoConfig::Load(const std::string& ini_file)
 	settings->Get("ShowEFBCopyRegions", &bShowEFBCopyRegions, false);
 	settings->Get("DumpTextures", &bDumpTextures, 0);
 	settings->Get("HiresTextures", &bHiresTextures, 0);
+	settings->Get("AsyncHiresTextures", &bAsyncHiresTextures, 0);
+	settings->Get("CacheHiresTextures", &bCacheHiresTextures, 0);
+	settings->Get("HiresTexturesCacheSize", &iHiresTexturesCacheSize, 0);
 	settings->Get("DumpEFBTarget", &bDumpEFBTarget, 0);
 	settings->Get("FreeLook", &bFreeLook, 0);
 	settings->Get("UseFFV1", &bUseFFV1, 0);
@@ -140,6 +143,8 @@ void VideoConfig::Load(const std::string& ini_file)
 	hacks->Get("EFBScaledCopy", &bCopyEFBScaled, true);
 	hacks->Get("EFBCopyCacheEnable", &bEFBCopyCacheEnable, false);
 	hacks->Get("EFBEmulateFormatChanges", &bEFBEmulateFormatChanges, false);
+	hacks->Get("CMPRPassthrough", &bCMPRPassthrough, false);
+	hacks->Get("TrackTextureWrites", &bTrackTextureWrites, false);
 
 	LoadVR(File::GetUserPath(D_CONFIG_IDX) + "Dolphin.ini");
 
@@ -217,6 +222,8 @@ void VideoConfig::GameIniLoad()
 	CHECK_SETTING("Video_Settings", "UseRealXFB", bUseRealXFB);
 	CHECK_SETTING("Video_Settings", "SafeTextureCacheColorSamples", iSafeTextureCache_ColorSamples);
 	CHECK_SETTING("Video_Settings", "HiresTextures", bHiresTextures);
+	CHECK_SETTING("Video_Settings", "AsyncHiresTextures", bAsyncHiresTextures);
+	CHECK_SETTING("Video_Settings", "CacheHiresTextures", bCacheHiresTextures);
 	CHECK_SETTING("Video_Settings", "EnablePixelLighting", bEnablePixelLighting);
 	CHECK_SETTING("Video_Settings", "FastDepthCalc", bFastDepthCalc);
 	CHECK_SETTING("Video_Settings", "MSAA", iMultisampleMode);
@@ -269,6 +276,8 @@ void VideoConfig::GameIniLoad()
 	CHECK_SETTING("Video_Hacks", "EFBScaledCopy", bCopyEFBScaled);
 	CHECK_SETTING("Video_Hacks", "EFBCopyCacheEnable", bEFBCopyCacheEnable);
 	CHECK_SETTING("Video_Hacks", "EFBEmulateFormatChanges", bEFBEmulateFormatChanges);
+	CHECK_SETTING("Video_Hacks", "CMPRPassthrough", bCMPRPassthrough);
+	CHECK_SETTING("Video_Hacks", "TrackTextureWrites", bTrackTextureWrites);
 
 	CHECK_SETTING("Video", "ProjectionHack", iPhackvalue[0]);
 	CHECK_SETTING("Video", "PH_SZNear", iPhackvalue[1]);
@@ -407,6 +416,9 @@ void VideoConfig::Save(const std::string& ini_file)
 	settings->Set("OverlayProjStats", bOverlayProjStats);
 	settings->Set("DumpTextures", bDumpTextures);
 	settings->Set("HiresTextures", bHiresTextures);
+	settings->Set("AsyncHiresTextures", bAsyncHiresTextures);
+	settings->Set("CacheHiresTextures", bCacheHiresTextures);
+	settings->Set("HiresTexturesCacheSize", iHiresTexturesCacheSize);
 	settings->Set("DumpEFBTarget", bDumpEFBTarget);
 	settings->Set("FreeLook", bFreeLook);
 	settings->Set("UseFFV1", bUseFFV1);
@@ -440,6 +452,8 @@ void VideoConfig::Save(const std::string& ini_file)
 	hacks->Set("EFBScaledCopy", bCopyEFBScaled);
 	hacks->Set("EFBCopyCacheEnable", bEFBCopyCacheEnable);
 	hacks->Set("EFBEmulateFormatChanges", bEFBEmulateFormatChanges);
+	hacks->Set("CMPRPassthrough", bCMPRPassthrough);
+	hacks->Set("TrackTextureWrites", bTrackTextureWrites);
 
 	SaveVR(File::GetUserPath(D_CONFIG_IDX) + "Dolphin.ini");
 	iniFile.Save(ini_file);
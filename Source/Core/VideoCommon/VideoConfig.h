@@ -107,6 +107,9 @@ struct VideoConfig final
 	// Utility
 	bool bDumpTextures;
 	bool bHiresTextures;
+	bool bAsyncHiresTextures;
+	bool bCacheHiresTextures;
+	int iHiresTexturesCacheSize; // MB, 0 for no limit
 	bool bDumpEFBTarget;
 	bool bUseFFV1;
 	bool bFreeLook;
@@ -122,6 +125,8 @@ struct VideoConfig final
 	bool bEFBEmulateFormatChanges;
 	bool bCopyEFBToTexture;
 	bool bCopyEFBScaled;
+	bool bCMPRPassthrough;
+	bool bTrackTextureWrites;
 	int iSafeTextureCache_ColorSamples;
 	int iPhackvalue[3];
 	std::string sPhackvalue[2];
@@ -208,6 +213,7 @@ struct VideoConfig final
 		bool bSupportsBindingLayout; // Needed by ShaderGen, so must stay in VideoCommon
 		bool bSupportsBBox;
 		bool bSupportsGSInstancing; // Needed by GeometryShaderGen, so must stay in VideoCommon
+		bool bSupportsDXT1Textures;
 	} backend_info;
 
 	// Utility
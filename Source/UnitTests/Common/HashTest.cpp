@@ -0,0 +1,105 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/Common.h"
+#include "Common/CPUDetect.h"
+#include "Common/Hash.h"
+
+namespace
+{
+
+u64 XXHash64(const char* str)
+{
+	return GetXXHash64((const u8*)str, (int)strlen(str), 0);
+}
+
+}  // namespace
+
+TEST(Hash, XXHash64ReferenceValues)
+{
+	EXPECT_EQ(0xef46db3751d8e999ULL, XXHash64(""));
+	EXPECT_EQ(0xd24ec4f1a98c6e5bULL, XXHash64("a"));
+	EXPECT_EQ(0x44bc2cf5ad770999ULL, XXHash64("abc"));
+	EXPECT_EQ(0xfbcea83c8a378bf1ULL, XXHash64("Nobody inspects the spammish repetition"));
+
+	std::vector<u8> data(4099);
+	for (size_t i = 0; i < data.size(); i++)
+		data[i] = (u8)(i * 7 + 3);
+	EXPECT_EQ(0x6243e90ade852967ULL, GetXXHash64(data.data(), (int)data.size(), 0));
+}
+
+TEST(Hash, FullHashesSeeEveryByte)
+{
+	std::vector<u64 (*)(const u8* src, int len, u32 samples)> functions = { GetXXHash64 };
+#if _M_SSE >= 0x402
+	if (cpu_info.bSSE4_2)
+		functions.push_back(GetCRC32);
+#endif
+
+	// An odd length, so that there are bytes after the last whole word.
+	std::vector<u8> data(1003, 0x55);
+	for (auto function : functions)
+	{
+		const u64 hash = function(data.data(), (int)data.size(), 0);
+		for (size_t i = 0; i < data.size(); i++)
+		{
+			data[i] ^= 1;
+			EXPECT_NE(hash, function(data.data(), (int)data.size(), 0)) << "byte " << i;
+			data[i] ^= 1;
+		}
+	}
+}
+
+// Reports the throughput of each GetHash64 implementation when hashing all of the data,
+// as the texture cache does with the safe texture cache setting.
+TEST(Hash, Speed)
+{
+	struct HashFunction
+	{
+		const char* name;
+		u64 (*function)(const u8* src, int len, u32 samples);
+	};
+	std::vector<HashFunction> functions = {
+		{ "HiresTexture", GetHashHiresTexture },
+		{ "MurmurHash3", GetMurmurHash3 },
+		{ "XXHash64", GetXXHash64 },
+	};
+#if _M_SSE >= 0x402
+	if (cpu_info.bSSE4_2)
+		functions.push_back({ "CRC32", GetCRC32 });
+#endif
+
+	const int sizes[] = { 32, 512, 8 * 1024, 128 * 1024, 1024 * 1024 };
+	const u64 bytes_per_size = 256 * 1024 * 1024;
+	std::vector<u8> data(1024 * 1024);
+	for (size_t i = 0; i < data.size(); i++)
+		data[i] = (u8)(i * 7 + 3);
+
+	for (int size : sizes)
+	{
+		printf("%8d bytes:", size);
+		for (const HashFunction& func : functions)
+		{
+			const u64 iterations = bytes_per_size / size;
+			u64 sum = 0;
+			auto start = std::chrono::high_resolution_clock::now();
+			for (u64 i = 0; i < iterations; i++)
+				sum += func.function(data.data(), size, 0);
+			auto end = std::chrono::high_resolution_clock::now();
+			const double seconds = std::chrono::duration<double>(end - start).count();
+
+			// Keeps the loop from being optimized away.
+			EXPECT_NE(0u, sum);
+			printf("  %s %6.2f GB/s", func.name, bytes_per_size / seconds / 1e9);
+		}
+		printf("\n");
+	}
+}
@@ -0,0 +1,117 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Core/PowerPC/Jit64/Jit.h"
+#include "Core/PowerPC/JitCommon/JitCache.h"
+
+// Needs to be included later because it defines a TEST macro that conflicts
+// with a TEST method definition in x64Emitter.h.
+#include <gtest/gtest.h>  // NOLINT
+
+// Nothing is linked and no code is actually written, so there's nothing to patch.
+class EvictionTestBlockCache : public JitBaseBlockCache
+{
+	void WriteLinkBlock(u8* location, const u8* address) override {}
+	void WriteDestroyBlock(const u8* location, u32 address) override {}
+	void WriteUnlinkBlock(u8* location) override {}
+};
+
+class JitCacheTest : public testing::Test
+{
+protected:
+	enum
+	{
+		REGION_SIZE = 0x10000,
+		CHUNKS = 8,
+		CHUNK_SIZE = REGION_SIZE / CHUNKS,
+		BLOCK_SIZE = 0x100,
+	};
+
+	void SetUp() override
+	{
+		// The block cache keeps its icache lookups in the global JIT's cache.
+		m_jit.reset(new Jit64());
+		jit = m_jit.get();
+		m_blocks.reset(new EvictionTestBlockCache());
+		m_blocks->Init();
+
+		m_region.resize(REGION_SIZE);
+		m_code_ptr = m_region.data();
+		m_evicted_end = m_region.data() + REGION_SIZE;
+	}
+
+	void TearDown() override
+	{
+		m_blocks->Shutdown();
+		m_blocks.reset();
+		jit = nullptr;
+		m_jit.reset();
+	}
+
+	// Walks the region a chunk at a time like Jitx86Base::EvictNextChunk.
+	void EvictNextChunk()
+	{
+		u8* region_end = m_region.data() + REGION_SIZE;
+		if (m_evicted_end == region_end)
+		{
+			m_code_ptr = m_region.data();
+			m_evicted_end = m_region.data();
+		}
+
+		u8* chunk_end = std::min(m_evicted_end + CHUNK_SIZE, region_end);
+		m_blocks->EvictCodeRange(false, m_evicted_end, chunk_end);
+		m_evicted_end = chunk_end;
+	}
+
+	void WriteBlock(u32 address)
+	{
+		while (m_evicted_end - m_code_ptr < BLOCK_SIZE)
+			EvictNextChunk();
+
+		int block_num = m_blocks->AllocateBlock(address);
+		JitBlock* b = m_blocks->GetBlock(block_num);
+		b->checkedEntry = m_code_ptr;
+		b->normalEntry = m_code_ptr;
+		b->codeSize = BLOCK_SIZE;
+		b->originalSize = 1;
+		m_blocks->FinalizeBlock(block_num, false, m_code_ptr);
+		m_code_ptr += BLOCK_SIZE;
+	}
+
+	bool IsCompiled(u32 address)
+	{
+		return m_blocks->GetBlockNumberFromStartAddress(address) != -1;
+	}
+
+	std::unique_ptr<Jit64> m_jit;
+	std::unique_ptr<EvictionTestBlockCache> m_blocks;
+	std::vector<u8> m_region;
+	u8* m_code_ptr;
+	u8* m_evicted_end;
+};
+
+TEST_F(JitCacheTest, EvictionKeepsNewestCode)
+{
+	const u32 blocks_per_lap = REGION_SIZE / BLOCK_SIZE;
+	// Everything but the chunk that's being evicted right now has to survive.
+	const u32 survivors = (REGION_SIZE - CHUNK_SIZE) / BLOCK_SIZE;
+
+	// Three laps, so the ring wraps twice, and the last chunk of every lap gets evicted while
+	// the start of the next one is already written.
+	for (u32 i = 0; i < 3 * blocks_per_lap; i++)
+	{
+		WriteBlock(0x80000000 + 4 * i);
+		for (u32 j = i + 1 - std::min(i + 1, survivors); j <= i; j++)
+			ASSERT_TRUE(IsCompiled(0x80000000 + 4 * j)) << "block " << j << " after writing block " << i;
+	}
+
+	// And all of the second lap has gone to make room for the third.
+	EXPECT_FALSE(IsCompiled(0x80000000 + 4 * blocks_per_lap));
+	EXPECT_FALSE(IsCompiled(0x80000000 + 4 * (2 * blocks_per_lap - 1)));
+}
@@ -0,0 +1,218 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/ChunkFile.h"
+#include "Common/CommonPaths.h"
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Core/ConfigManager.h"
+#include "Core/MemTools.h"
+#include "Core/VolumeHandler.h"
+#include "Core/HW/DVDInterface.h"
+#include "Core/HW/Memmap.h"
+#include "VideoCommon/VideoBackendBase.h"
+
+#if _ARCH_64 && !defined(__APPLE__)
+
+// Memory::Init registers the command processor's MMIO through the video backend.
+class WriteWatchFakeVideoBackend : public VideoBackendHardware
+{
+	unsigned int PeekMessages() override { return 0; }
+	bool Initialize(void* window_handle) override { return true; }
+	bool InitializeOtherThread(void* window_handle, std::thread* video_thread) override { return true; }
+	void Shutdown() override {}
+	void ShutdownOtherThread() override {}
+	std::string GetName() const override { return "WriteWatchTest"; }
+	void ShowConfig(void*) override {}
+	void Video_Prepare() override {}
+	void Video_PrepareOtherThread() override {}
+	void Video_Cleanup() override {}
+	void Video_CleanupOtherThread() override {}
+};
+
+class WriteWatchTest : public testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		// Keeps the settings SConfig loads and saves out of the real user directory.
+		m_user_dir = File::GetCurrentDir() + DIR_SEP "WriteWatchTestUser" DIR_SEP;
+		File::CreateFullPath(m_user_dir);
+		File::GetUserPath(D_USER_IDX, m_user_dir);
+		SConfig::Init();
+
+		g_video_backend = &m_video_backend;
+		Memory::Init();
+		EMM::InstallExceptionHandler();
+		Memory::EnableWriteWatch();
+	}
+
+	void TearDown() override
+	{
+		Memory::DisableWriteWatch();
+		EMM::UninstallExceptionHandler();
+		Memory::Shutdown();
+		g_video_backend = nullptr;
+
+		VolumeHandler::EjectVolume();
+		SConfig::Shutdown();
+		File::DeleteDirRecursively(m_user_dir);
+	}
+
+	// Writes a GameCube disc image with a known pattern after the header and loads it.
+	void InsertDisc(u32 size)
+	{
+		std::vector<u8> image(size);
+		for (u32 i = 0; i < size; i++)
+			image[i] = (u8)(i * 7 + 3);
+		const u8 gc_magic[] = { 0xC2, 0x33, 0x9F, 0x3D };
+		std::copy(gc_magic, gc_magic + sizeof(gc_magic), image.begin() + 0x1C);
+
+		std::string filename = m_user_dir + "disc.gcm";
+		File::IOFile file(filename, "wb");
+		ASSERT_TRUE(file.WriteBytes(image.data(), image.size()));
+		file.Close();
+		ASSERT_TRUE(VolumeHandler::SetVolumeName(filename));
+	}
+
+	static std::vector<u8> SaveMemory()
+	{
+		u8* ptr = nullptr;
+		PointerWrap p(&ptr, PointerWrap::MODE_MEASURE);
+		Memory::DoState(p);
+		std::vector<u8> buffer(reinterpret_cast<size_t>(ptr));
+		ptr = buffer.data();
+		p.SetMode(PointerWrap::MODE_WRITE);
+		Memory::DoState(p);
+		return buffer;
+	}
+
+	static bool LoadMemory(std::vector<u8>& buffer)
+	{
+		u8* ptr = buffer.data();
+		PointerWrap p(&ptr, PointerWrap::MODE_READ);
+		Memory::DoState(p);
+		return p.GetMode() == PointerWrap::MODE_READ && ptr == buffer.data() + buffer.size();
+	}
+
+	std::string m_user_dir;
+	WriteWatchFakeVideoBackend m_video_backend;
+};
+
+TEST_F(WriteWatchTest, CPUWrite)
+{
+	u64 generation;
+	ASSERT_TRUE(Memory::WatchRange(0x80010000, 0x2000, &generation));
+	EXPECT_FALSE(Memory::WasWrittenSince(0x80010000, 0x2000, generation));
+
+	// Faults, is recorded, and goes through once the page is writable again.
+	*(volatile u32*)Memory::GetPointer(0x80011004) = 0x12345678;
+	EXPECT_EQ(0x78563412u, Memory::Read_U32(0x80011004));
+	EXPECT_TRUE(Memory::WasWrittenSince(0x80010000, 0x2000, generation));
+	EXPECT_FALSE(Memory::WasWrittenSince(0x80010000, 0x1000, generation));
+}
+
+TEST_F(WriteWatchTest, DVDRead)
+{
+	InsertDisc(0x10000);
+
+	u64 generation;
+	ASSERT_TRUE(Memory::WatchRange(0x80020000, 0x3000, &generation));
+
+	// A read straight into a watched page would fail with EFAULT instead of faulting.
+	ASSERT_TRUE(DVDInterface::DVDRead(0x8000, 0x80020800, 0x2000));
+	for (u32 i = 0; i < 0x2000; i++)
+		ASSERT_EQ((u8)((0x8000 + i) * 7 + 3), Memory::Read_U8(0x80020800 + i)) << "byte " << i;
+	EXPECT_TRUE(Memory::WasWrittenSince(0x80020000, 0x1000, generation));
+	EXPECT_TRUE(Memory::WasWrittenSince(0x80021000, 0x1000, generation));
+
+	// Watching the range again starts over from the latest write.
+	u64 after;
+	ASSERT_TRUE(Memory::WatchRange(0x80020000, 0x3000, &after));
+	EXPECT_FALSE(Memory::WasWrittenSince(0x80020000, 0x3000, after));
+}
+
+TEST_F(WriteWatchTest, DeltaState)
+{
+	for (u32 i = 0; i < 0x200000; i += 4)
+		Memory::Write_U32(i * 3, 0x80000000 + i);
+	Memory::Write_U32(0x11111111, 0x7E000010);
+
+	const u64 generation = Memory::WatchAllPages();
+	std::vector<u8> base = SaveMemory();
+
+	// A CPU write to MEM1, a host write over two pages and a CPU write to the fake VMEM.
+	Memory::Write_U32(0xDEADBEEF, 0x80001000);
+	const std::vector<u8> data(0x2000, 0x5A);
+	Memory::CopyToEmu(0x80100000, data.data(), data.size());
+	Memory::Write_U32(0x22222222, 0x7E000010);
+
+	std::vector<u32> pages;
+	Memory::GetWrittenPages(generation, &pages);
+	const u32 fake_vmem_page = Memory::RAM_SIZE / Memory::WATCH_PAGE_SIZE;
+	EXPECT_EQ((std::vector<u32>{ 0x1, 0x100, 0x101, fake_vmem_page }), pages);
+
+	Memory::BeginDeltaState(generation);
+	std::vector<u8> delta = SaveMemory();
+	Memory::EndDeltaState();
+	EXPECT_LT(delta.size(), 4u * (0x1000 + sizeof(u32)) + Memory::L1_CACHE_SIZE + 0x100);
+
+	const std::vector<u8> ram(Memory::m_pRAM, Memory::m_pRAM + Memory::RAM_SIZE);
+	const std::vector<u8> fake_vmem(Memory::m_pFakeVMEM, Memory::m_pFakeVMEM + Memory::FAKEVMEM_SIZE);
+
+	// Written both to pages the delta has and to one it doesn't.
+	Memory::Write_U32(0, 0x80001000);
+	Memory::Write_U32(0, 0x80100800);
+	Memory::Write_U32(0, 0x80300000);
+	Memory::Write_U32(0, 0x7E000010);
+
+	ASSERT_TRUE(LoadMemory(base));
+	Memory::BeginDeltaState(generation);
+	ASSERT_TRUE(LoadMemory(delta));
+	Memory::EndDeltaState();
+	EXPECT_TRUE(std::equal(ram.begin(), ram.end(), Memory::m_pRAM));
+	EXPECT_TRUE(std::equal(fake_vmem.begin(), fake_vmem.end(), Memory::m_pFakeVMEM));
+	EXPECT_EQ(0xDEADBEEFu, Memory::Read_U32(0x80001000));
+
+	// Loading counts as writing every page, so the next delta against the same base has them all.
+	Memory::GetWrittenPages(generation, &pages);
+	EXPECT_EQ(2 * fake_vmem_page, (u32)pages.size());
+}
+
+TEST_F(WriteWatchTest, Snapshot)
+{
+	for (u32 i = 0; i < 0x10000; i += 4)
+		Memory::Write_U32(i, 0x80000000 + i);
+
+	std::vector<u32> pages;
+	std::unique_ptr<u8[]> data;
+	const u64 first = Memory::SnapshotWrittenPages(0, &pages, &data);
+	ASSERT_EQ(2 * Memory::RAM_SIZE / Memory::WATCH_PAGE_SIZE, (u32)pages.size());
+
+	// Writes after the snapshot, by the CPU and the host, don't make it in.
+	Memory::Write_U32(0xDEADBEEF, 0x80002000);
+	const std::vector<u8> zeroes(0x1000);
+	Memory::CopyToEmu(0x80003000, zeroes.data(), zeroes.size());
+	Memory::FinishSnapshot();
+	for (u32 i = 0; i < 0x10000; i += 4)
+		ASSERT_EQ(i, Common::swap32(data.get() + i)) << "address " << i;
+
+	const u64 second = Memory::SnapshotWrittenPages(first, &pages, &data);
+	EXPECT_EQ((std::vector<u32>{ 2, 3 }), pages);
+	Memory::FinishSnapshot();
+	EXPECT_EQ(0xDEADBEEFu, Common::swap32(data.get()));
+	EXPECT_EQ(0u, Common::swap32(data.get() + 0x1000));
+
+	Memory::SnapshotWrittenPages(second, &pages, &data);
+	EXPECT_TRUE(pages.empty());
+}
+
+#endif
@@ -0,0 +1,260 @@
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Common/Common.h"
+#include "Common/CPUDetect.h"
+#include "Common/StringUtil.h"
+#include "VideoCommon/TextureDecoder.h"
+
+// VideoCommon only links one implementation of _TexDecoder_DecodeImpl, so build the portable
+// one under another name to have something to compare the SIMD decoders against.
+PC_TexFormat _TexDecoder_DecodeImpl_Generic(u32* dst, const u8* src, int width, int height, int texformat, const u8* tlut, TlutFormat tlutfmt);
+#define _TexDecoder_DecodeImpl _TexDecoder_DecodeImpl_Generic
+#include "VideoCommon/TextureDecoder_Generic.cpp"  // NOLINT
+#undef _TexDecoder_DecodeImpl
+
+#include <gtest/gtest.h>  // NOLINT
+
+namespace
+{
+
+struct TextureFormatInfo
+{
+	int format;
+	const char* name;
+	bool paletted;
+};
+
+// The copy and Z formats only exist as EFB copy targets and aren't handled by the decoders.
+const TextureFormatInfo texture_formats[] = {
+	{ GX_TF_I4, "I4", false },
+	{ GX_TF_I8, "I8", false },
+	{ GX_TF_IA4, "IA4", false },
+	{ GX_TF_IA8, "IA8", false },
+	{ GX_TF_RGB565, "RGB565", false },
+	{ GX_TF_RGB5A3, "RGB5A3", false },
+	{ GX_TF_RGBA8, "RGBA8", false },
+	{ GX_TF_C4, "C4", true },
+	{ GX_TF_C8, "C8", true },
+	{ GX_TF_C14X2, "C14X2", true },
+	{ GX_TF_CMPR, "CMPR", false },
+};
+
+const char* const tlut_format_names[] = { "IA8", "RGB565", "RGB5A3" };
+
+// Tiny, non-square, typical and large enough to be split across the decoder threads.
+const int texture_sizes[][2] = {
+	{ 8, 8 },
+	{ 32, 16 },
+	{ 64, 128 },
+	{ 256, 256 },
+	{ 1024, 1024 },
+};
+
+const int MAX_TEXELS = 1024 * 1024;
+
+}  // namespace
+
+class TextureDecoderTest : public testing::Test
+{
+protected:
+	TextureDecoderTest()
+		: m_src(MAX_TEXELS * 4), m_tlut(2 << 14), m_expected(MAX_TEXELS), m_actual(MAX_TEXELS)
+	{
+		std::mt19937 rng(0x5eed);
+		for (u8& b : m_src)
+			b = (u8)rng();
+		for (u8& b : m_tlut)
+			b = (u8)rng();
+	}
+
+	void SetUp() override
+	{
+		m_ssse3 = cpu_info.bSSSE3;
+		m_avx2 = cpu_info.bAVX2;
+	}
+
+	void TearDown() override
+	{
+		cpu_info.bSSSE3 = m_ssse3;
+		cpu_info.bAVX2 = m_avx2;
+		TexDecoder_Shutdown();
+	}
+
+	// Returns a description of the first texel that differs, or an empty string.
+	std::string Compare(int num_texels)
+	{
+		for (int i = 0; i < num_texels; i++)
+		{
+			if (m_expected[i] != m_actual[i])
+			{
+				return StringFromFormat("texel %d is %08x, expected %08x", i, m_actual[i], m_expected[i]);
+			}
+		}
+		return "";
+	}
+
+	std::vector<u8> m_src;
+	std::vector<u8> m_tlut;
+	std::vector<u32> m_expected;
+	std::vector<u32> m_actual;
+	bool m_ssse3;
+	bool m_avx2;
+};
+
+TEST_F(TextureDecoderTest, MatchesGenericDecoder)
+{
+	// Each of the instruction sets the x64 decoder picks at runtime, best last.
+	std::vector<std::pair<bool, bool>> cpu_levels = { { false, false } };
+	if (m_ssse3)
+		cpu_levels.push_back({ true, false });
+	if (m_ssse3 && m_avx2)
+		cpu_levels.push_back({ true, true });
+
+	for (const TextureFormatInfo& fmt : texture_formats)
+	{
+		for (int tlutfmt = GX_TL_IA8; tlutfmt <= (fmt.paletted ? GX_TL_RGB5A3 : GX_TL_IA8); tlutfmt++)
+		{
+			for (const auto& size : texture_sizes)
+			{
+				const int width = size[0];
+				const int height = size[1];
+				std::string name = StringFromFormat("%s %dx%d", fmt.name, width, height);
+				if (fmt.paletted)
+					name += StringFromFormat(" with %s palette", tlut_format_names[tlutfmt]);
+
+				std::fill(m_expected.begin(), m_expected.end(), 0);
+				ASSERT_EQ(PC_TEX_FMT_RGBA32, _TexDecoder_DecodeImpl_Generic(m_expected.data(), m_src.data(),
+					width, height, fmt.format, m_tlut.data(), (TlutFormat)tlutfmt)) << name;
+
+				for (const auto& level : cpu_levels)
+				{
+					cpu_info.bSSSE3 = level.first;
+					cpu_info.bAVX2 = level.second;
+					const char* level_name = level.second ? "AVX2" : level.first ? "SSSE3" : "SSE2";
+
+					std::fill(m_actual.begin(), m_actual.end(), 0);
+					EXPECT_EQ(PC_TEX_FMT_RGBA32, _TexDecoder_DecodeImpl(m_actual.data(), m_src.data(),
+						width, height, fmt.format, m_tlut.data(), (TlutFormat)tlutfmt)) << name;
+					EXPECT_EQ("", Compare(width * height)) << name << " (" << level_name << ")";
+				}
+
+				// The threaded decoder has to stitch the bands back together exactly.
+				TexDecoder_Init();
+				std::fill(m_actual.begin(), m_actual.end(), 0);
+				TexDecoder_Decode((u8*)m_actual.data(), m_src.data(), width, height, fmt.format, m_tlut.data(), (TlutFormat)tlutfmt);
+				EXPECT_EQ("", Compare(width * height)) << name << " (threaded)";
+				TexDecoder_Shutdown();
+			}
+		}
+	}
+}
+
+// Uploading CMPR as DXT1 only reorders the blocks, so decoding the DXT1 data the way the
+// GameCube interpolates its colors has to give exactly what the CMPR decoder does.
+TEST_F(TextureDecoderTest, DecodeCMPRAsDXT1)
+{
+	const int dxt1_sizes[][2] = { { 8, 8 }, { 12, 20 }, { 64, 128 }, { 1024, 1024 } };
+	std::vector<u8> dxt1(MAX_TEXELS / 2);
+	for (const auto& size : dxt1_sizes)
+	{
+		const int width = size[0];
+		const int height = size[1];
+		const int expanded_width = (width + 7) & ~7;
+		const int expanded_height = (height + 7) & ~7;
+		std::string name = StringFromFormat("%dx%d", width, height);
+
+		ASSERT_EQ(PC_TEX_FMT_RGBA32, _TexDecoder_DecodeImpl_Generic(m_expected.data(), m_src.data(),
+			expanded_width, expanded_height, GX_TF_CMPR, m_tlut.data(), GX_TL_IA8)) << name;
+		ASSERT_EQ(PC_TEX_FMT_DXT1, TexDecoder_DecodeCMPRAsDXT1(dxt1.data(), m_src.data(), width, height, expanded_width)) << name;
+
+		const int blocks_wide = width / 4;
+		for (int by = 0; by < height / 4; by++)
+		{
+			for (int bx = 0; bx < blocks_wide; bx++)
+			{
+				const u8* block = &dxt1[(by * blocks_wide + bx) * 8];
+				const u16 c1 = block[0] | (block[1] << 8);
+				const u16 c2 = block[2] | (block[3] << 8);
+				int r[4], g[4], b[4], a[4] = { 255, 255, 255, 255 };
+				r[0] = Convert5To8(c1 >> 11);
+				g[0] = Convert6To8((c1 >> 5) & 0x3F);
+				b[0] = Convert5To8(c1 & 0x1F);
+				r[1] = Convert5To8(c2 >> 11);
+				g[1] = Convert6To8((c2 >> 5) & 0x3F);
+				b[1] = Convert5To8(c2 & 0x1F);
+				for (int* c : { r, g, b })
+				{
+					if (c1 > c2)
+					{
+						const int third = ((c[1] - c[0]) >> 1) - ((c[1] - c[0]) >> 3);
+						c[2] = c[0] + third;
+						c[3] = c[1] - third;
+					}
+					else
+					{
+						c[2] = (c[0] + c[1] + 1) / 2;
+						c[3] = c[1];
+					}
+				}
+				if (c1 <= c2)
+					a[3] = 0;
+
+				// DXT1 keeps the first texel of each row in the low bits.
+				for (int y = 0; y < 4; y++)
+				{
+					for (int x = 0; x < 4; x++)
+					{
+						const int i = (block[4 + y] >> (x * 2)) & 3;
+						m_actual[(by * 4 + y) * expanded_width + bx * 4 + x] = (a[i] << 24) | (b[i] << 16) | (g[i] << 8) | r[i];
+					}
+				}
+			}
+		}
+
+		for (int y = 0; y < height; y++)
+		{
+			for (int x = 0; x < width; x++)
+			{
+				const int i = y * expanded_width + x;
+				ASSERT_EQ(m_expected[i], m_actual[i]) << name << " texel " << x << "," << y;
+			}
+		}
+	}
+}
+
+// Reports the throughput of each decoder on a large texture.
+TEST_F(TextureDecoderTest, Speed)
+{
+	const int width = 1024;
+	const int height = 1024;
+	const int iterations = 20;
+
+	TexDecoder_Init();
+	for (const TextureFormatInfo& fmt : texture_formats)
+	{
+		double seconds[3];
+		for (int impl = 0; impl < 3; impl++)
+		{
+			auto start = std::chrono::high_resolution_clock::now();
+			for (int i = 0; i < iterations; i++)
+			{
+				if (impl == 0)
+					_TexDecoder_DecodeImpl_Generic(m_actual.data(), m_src.data(), width, height, fmt.format, m_tlut.data(), GX_TL_RGB5A3);
+				else if (impl == 1)
+					_TexDecoder_DecodeImpl(m_actual.data(), m_src.data(), width, height, fmt.format, m_tlut.data(), GX_TL_RGB5A3);
+				else
+					TexDecoder_Decode((u8*)m_actual.data(), m_src.data(), width, height, fmt.format, m_tlut.data(), GX_TL_RGB5A3);
+			}
+			auto end = std::chrono::high_resolution_clock::now();
+			seconds[impl] = std::chrono::duration<double>(end - start).count();
+		}
+
+		const double mtexels = (double)width * height * iterations / 1000000;
+		printf("%-7s %8.1f Mtexels/s generic  %8.1f Mtexels/s native  %8.1f Mtexels/s threaded\n",
+			fmt.name, mtexels / seconds[0], mtexels / seconds[1], mtexels / seconds[2]);
+	}
+}
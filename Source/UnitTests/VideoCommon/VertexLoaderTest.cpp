@@ -1,6 +1,11 @@
+#include <chrono>
+#include <random>
 #include <set>
+#include <string>
+#include <vector>
 
 #include "Common/Common.h"
+#include "Common/CPUDetect.h"
 #include "VideoCommon/DataReader.h"
 #include "VideoCommon/VertexLoader.h"
 
@@ -247,3 +252,575 @@ TEST_F(VertexLoaderTest, LargeFloatVertexSpeed)
 		loader.RunVertices(m_vtx_attr, 7, 100000);
 	}
 }
+
+// Everything that makes up a vertex loader, in a form that is easier to
+// sweep and randomize than the raw registers.
+struct VertexConfig
+{
+	bool pos_mtx;
+	bool tex_mtx[8];
+	u64 position, normal, color[2], texcoord[8];
+	u32 pos_elements, pos_format, pos_frac;
+	u32 normal_elements, normal_format, normal_index3;
+	u32 color_elements[2], color_comp[2];
+	u32 tc_elements[8], tc_format[8], tc_frac[8];
+
+	VertexConfig()
+	{
+		memset(this, 0, sizeof (*this));
+		position = DIRECT;
+	}
+
+	void ToRegisters(TVtxDesc* desc, VAT* vat) const
+	{
+		memset(desc, 0, sizeof (*desc));
+		memset(vat, 0, sizeof (*vat));
+
+		desc->PosMatIdx = pos_mtx;
+		desc->Tex0MatIdx = tex_mtx[0];
+		desc->Tex1MatIdx = tex_mtx[1];
+		desc->Tex2MatIdx = tex_mtx[2];
+		desc->Tex3MatIdx = tex_mtx[3];
+		desc->Tex4MatIdx = tex_mtx[4];
+		desc->Tex5MatIdx = tex_mtx[5];
+		desc->Tex6MatIdx = tex_mtx[6];
+		desc->Tex7MatIdx = tex_mtx[7];
+		desc->Position = position;
+		desc->Normal = normal;
+		desc->Color0 = color[0];
+		desc->Color1 = color[1];
+		desc->Tex0Coord = texcoord[0];
+		desc->Tex1Coord = texcoord[1];
+		desc->Tex2Coord = texcoord[2];
+		desc->Tex3Coord = texcoord[3];
+		desc->Tex4Coord = texcoord[4];
+		desc->Tex5Coord = texcoord[5];
+		desc->Tex6Coord = texcoord[6];
+		desc->Tex7Coord = texcoord[7];
+
+		vat->g0.PosElements = pos_elements;
+		vat->g0.PosFormat = pos_format;
+		vat->g0.PosFrac = pos_frac;
+		vat->g0.NormalElements = normal_elements;
+		vat->g0.NormalFormat = normal_format;
+		vat->g0.NormalIndex3 = normal_index3;
+		vat->g0.Color0Elements = color_elements[0];
+		vat->g0.Color0Comp = color_comp[0];
+		vat->g0.Color1Elements = color_elements[1];
+		vat->g0.Color1Comp = color_comp[1];
+		vat->g0.Tex0CoordElements = tc_elements[0];
+		vat->g0.Tex0CoordFormat = tc_format[0];
+		vat->g0.Tex0Frac = tc_frac[0];
+		vat->g1.Tex1CoordElements = tc_elements[1];
+		vat->g1.Tex1CoordFormat = tc_format[1];
+		vat->g1.Tex1Frac = tc_frac[1];
+		vat->g1.Tex2CoordElements = tc_elements[2];
+		vat->g1.Tex2CoordFormat = tc_format[2];
+		vat->g1.Tex2Frac = tc_frac[2];
+		vat->g1.Tex3CoordElements = tc_elements[3];
+		vat->g1.Tex3CoordFormat = tc_format[3];
+		vat->g1.Tex3Frac = tc_frac[3];
+		vat->g1.Tex4CoordElements = tc_elements[4];
+		vat->g1.Tex4CoordFormat = tc_format[4];
+		vat->g2.Tex4Frac = tc_frac[4];
+		vat->g2.Tex5CoordElements = tc_elements[5];
+		vat->g2.Tex5CoordFormat = tc_format[5];
+		vat->g2.Tex5Frac = tc_frac[5];
+		vat->g2.Tex6CoordElements = tc_elements[6];
+		vat->g2.Tex6CoordFormat = tc_format[6];
+		vat->g2.Tex6Frac = tc_frac[6];
+		vat->g2.Tex7CoordElements = tc_elements[7];
+		vat->g2.Tex7CoordFormat = tc_format[7];
+		vat->g2.Tex7Frac = tc_frac[7];
+	}
+};
+
+// Straightforward vertex loader that the compiled loaders are checked
+// against. It follows the C loaders (VertexLoader_*.cpp), quirks included.
+class ReferenceVertexLoader
+{
+public:
+	ReferenceVertexLoader(const VertexConfig& config, const u8* src, u8* dst)
+		: m_config(config), m_src(src), m_dst(dst)
+	{
+	}
+
+	const u8* GetSource() const { return m_src; }
+	u8* GetDestination() const { return m_dst; }
+
+	void ConvertVertex()
+	{
+		const VertexConfig& c = m_config;
+
+		u32 pos_mtx = 0;
+		u32 tex_mtx[8] = {};
+		if (c.pos_mtx)
+			pos_mtx = *m_src++ & 0x3F;
+		for (int i = 0; i < 8; i++)
+		{
+			if (c.tex_mtx[i])
+				tex_mtx[i] = *m_src++ & 0x3F;
+		}
+
+		const int pos_count = c.pos_elements ? 3 : 2;
+		const u8* pos = GetAttribute(c.position, ARRAY_POSITION, FormatSize(c.pos_format) * pos_count);
+		for (int i = 0; i < 3; i++)
+		{
+			if (i < pos_count)
+				WriteComponent(pos + i * FormatSize(c.pos_format), c.pos_format, Frac(c.pos_frac));
+			else
+				WriteFloat(0.0f);
+		}
+
+		if (c.normal != NOT_PRESENT)
+		{
+			static const float normal_scale[4] = {1.0f / 128, 1.0f / 64, 1.0f / 32768, 1.0f / 16384};
+			const int size = FormatSize(c.normal_format) * 3;
+			const float scale = c.normal_format < 4 ? normal_scale[c.normal_format] : 1.0f;
+			const int count = c.normal_elements ? 3 : 1;
+			const u8* normal = nullptr;
+			for (int i = 0; i < count; i++)
+			{
+				if (i == 0 || (c.normal_index3 && c.normal != DIRECT))
+					normal = GetAttribute(c.normal, ARRAY_NORMAL, size * count) + i * size;
+				else
+					normal += size;
+				for (int j = 0; j < 3; j++)
+					WriteComponent(normal + j * FormatSize(c.normal_format), c.normal_format, scale);
+			}
+		}
+
+		// Colors use the array and element count of the n-th present color.
+		int col_index = 0;
+		for (int i = 0; i < 2; i++)
+		{
+			if (c.color[i] == NOT_PRESENT)
+				continue;
+			static const int color_size[6] = {2, 3, 4, 2, 3, 4};
+			const u8* color = GetAttribute(c.color[i], ARRAY_COLOR + col_index, color_size[c.color_comp[i]]);
+			WriteU32(ReadColor(color, c.color_comp[i], c.color[i] == DIRECT && !c.color_elements[col_index]));
+			col_index++;
+		}
+
+		for (int i = 0; i < 8; i++)
+		{
+			if (c.texcoord[i] != NOT_PRESENT)
+			{
+				const int count = c.tc_elements[i] + 1;
+				const int size = FormatSize(c.tc_format[i]);
+				const u8* tc = GetAttribute(c.texcoord[i], ARRAY_TEXCOORD0 + i, size * count);
+				for (int j = 0; j < count; j++)
+					WriteComponent(tc + j * size, c.tc_format[i], Frac(c.tc_frac[i]));
+				if (c.tex_mtx[i])
+				{
+					if (count == 1)
+						WriteFloat(0.0f);
+					WriteFloat((float)tex_mtx[i]);
+				}
+			}
+			else if (c.tex_mtx[i])
+			{
+				WriteFloat(0.0f);
+				WriteFloat(0.0f);
+				WriteFloat((float)tex_mtx[i]);
+				WriteFloat(0.0f);
+			}
+		}
+
+		if (c.pos_mtx)
+			WriteU32(pos_mtx);
+	}
+
+private:
+	static int FormatSize(u32 format)
+	{
+		static const int size[5] = {1, 1, 2, 2, 4};
+		return size[format];
+	}
+
+	static float Frac(u32 frac)
+	{
+		return 1.0f / (1u << frac);
+	}
+
+	static u32 Expand(u32 value, int bits)
+	{
+		return (value << (8 - bits)) | (value >> (2 * bits - 8));
+	}
+
+	static u32 ReadColor(const u8* p, u32 comp, bool force_alpha)
+	{
+		u32 r, g, b, a;
+		switch (comp)
+		{
+		case FORMAT_16B_565:
+		{
+			u32 v = p[0] << 8 | p[1];
+			r = Expand(v >> 11, 5);
+			g = Expand((v >> 5) & 0x3F, 6);
+			b = Expand(v & 0x1F, 5);
+			a = 0xFF;
+			break;
+		}
+		case FORMAT_16B_4444:
+			// Read as a host u16 by the C loaders, so the nibbles are RGBA.
+			r = Expand(p[0] >> 4, 4);
+			g = Expand(p[0] & 0xF, 4);
+			b = Expand(p[1] >> 4, 4);
+			a = Expand(p[1] & 0xF, 4);
+			break;
+		case FORMAT_24B_6666:
+		{
+			u32 v = p[0] << 16 | p[1] << 8 | p[2];
+			r = Expand(v >> 18, 6);
+			g = Expand((v >> 12) & 0x3F, 6);
+			b = Expand((v >> 6) & 0x3F, 6);
+			a = Expand(v & 0x3F, 6);
+			break;
+		}
+		case FORMAT_32B_8888:
+			r = p[0];
+			g = p[1];
+			b = p[2];
+			a = force_alpha ? 0xFF : p[3];
+			break;
+		default:
+			r = p[0];
+			g = p[1];
+			b = p[2];
+			a = 0xFF;
+			break;
+		}
+		return r | g << 8 | b << 16 | a << 24;
+	}
+
+	const u8* GetAttribute(u64 mode, int array, int direct_size)
+	{
+		if (mode == DIRECT)
+		{
+			const u8* data = m_src;
+			m_src += direct_size;
+			return data;
+		}
+
+		u32 index = *m_src++;
+		if (mode == INDEX16)
+			index = index << 8 | *m_src++;
+		return cached_arraybases[array] + index * g_main_cp_state.array_strides[array];
+	}
+
+	void WriteComponent(const u8* p, u32 format, float scale)
+	{
+		switch (format)
+		{
+		case FORMAT_UBYTE:
+			WriteFloat(p[0] * scale);
+			break;
+		case FORMAT_BYTE:
+			WriteFloat((s8)p[0] * scale);
+			break;
+		case FORMAT_USHORT:
+			WriteFloat((u16)(p[0] << 8 | p[1]) * scale);
+			break;
+		case FORMAT_SHORT:
+			WriteFloat((s16)(p[0] << 8 | p[1]) * scale);
+			break;
+		default:
+			// Copy the bits so NaNs survive.
+			WriteU32(p[0] << 24 | p[1] << 16 | p[2] << 8 | p[3]);
+			break;
+		}
+	}
+
+	void WriteFloat(float value)
+	{
+		memcpy(m_dst, &value, sizeof (value));
+		m_dst += sizeof (value);
+	}
+
+	void WriteU32(u32 value)
+	{
+		memcpy(m_dst, &value, sizeof (value));
+		m_dst += sizeof (value);
+	}
+
+	const VertexConfig& m_config;
+	const u8* m_src;
+	u8* m_dst;
+};
+
+static u8 array_memory[8 * 1024 * 1024];
+static u8 reference_memory[16 * 1024 * 1024];
+
+class VertexLoaderFuzzTest : public VertexLoaderTest
+{
+protected:
+	void SetUp() override
+	{
+		VertexLoaderTest::SetUp();
+
+		m_rng.seed(42);
+		for (u8& byte : array_memory)
+			byte = (u8)m_rng();
+	}
+
+	// Runs the compiled loader and the reference on random input and compares
+	// the results byte for byte.
+	void Check(const VertexConfig& config, int count)
+	{
+		TVtxDesc desc;
+		VAT vat;
+		config.ToRegisters(&desc, &vat);
+
+		// Index16 reads up to 64k * 64 bytes from each array.
+		for (int i = 0; i < 16; i++)
+		{
+			cached_arraybases[i] = &array_memory[m_rng() % (1024 * 1024)];
+			g_main_cp_state.array_strides[i] = 1 + m_rng() % 64;
+		}
+
+		VertexLoader loader(desc, vat);
+		const int vertex_size = loader.GetVertexSize();
+		const int stride = loader.GetNativeVertexDeclaration().stride;
+
+		ResetPointers();
+		for (int i = 0; i < vertex_size * count; i++)
+			input_memory[i] = (u8)m_rng();
+		memset(output_memory, 0, stride * count);
+		memset(reference_memory, 0, stride * count);
+
+		loader.RunVertices(vat, 7, count);
+
+		std::string name;
+		loader.AppendToString(&name);
+		SCOPED_TRACE(name);
+
+		ReferenceVertexLoader reference(config, input_memory, reference_memory);
+		for (int i = 0; i < count; i++)
+			reference.ConvertVertex();
+
+		ASSERT_EQ(reference.GetSource(), g_video_buffer_read_ptr);
+		ASSERT_EQ(reference.GetDestination() - reference_memory, VertexManager::s_pCurBufferPointer - output_memory);
+		for (int i = 0; i < stride * count; i++)
+		{
+			if (output_memory[i] != reference_memory[i])
+			{
+				ADD_FAILURE() << "Vertex " << i / stride << " differs at byte " << i % stride
+				              << ": got " << (u32)output_memory[i] << ", expected " << (u32)reference_memory[i];
+				return;
+			}
+		}
+	}
+
+	u64 RandomMode(bool allow_not_present)
+	{
+		return allow_not_present ? m_rng() % 4 : 1 + m_rng() % 3;
+	}
+
+	std::mt19937 m_rng;
+};
+
+TEST_F(VertexLoaderFuzzTest, Position)
+{
+	VertexConfig config;
+	for (u64 mode = DIRECT; mode <= INDEX16; mode++)
+	{
+		for (u32 format = FORMAT_UBYTE; format <= FORMAT_FLOAT; format++)
+		{
+			for (u32 elements = 0; elements < 2; elements++)
+			{
+				for (u32 frac = 0; frac < 32; frac++)
+				{
+					config.position = mode;
+					config.pos_format = format;
+					config.pos_elements = elements;
+					config.pos_frac = frac;
+					Check(config, 16);
+				}
+			}
+		}
+	}
+}
+
+TEST_F(VertexLoaderFuzzTest, Normal)
+{
+	VertexConfig config;
+	for (u64 mode = DIRECT; mode <= INDEX16; mode++)
+	{
+		for (u32 format = FORMAT_UBYTE; format <= FORMAT_FLOAT; format++)
+		{
+			for (u32 elements = 0; elements < 2; elements++)
+			{
+				for (u32 index3 = 0; index3 < 2; index3++)
+				{
+					config.normal = mode;
+					config.normal_format = format;
+					config.normal_elements = elements;
+					config.normal_index3 = index3;
+					Check(config, 16);
+				}
+			}
+		}
+	}
+}
+
+TEST_F(VertexLoaderFuzzTest, Color)
+{
+	VertexConfig config;
+	for (u64 mode0 = NOT_PRESENT; mode0 <= INDEX16; mode0++)
+	{
+		for (u64 mode1 = NOT_PRESENT; mode1 <= INDEX16; mode1++)
+		{
+			for (u32 comp = FORMAT_16B_565; comp <= FORMAT_32B_8888; comp++)
+			{
+				for (u32 elements = 0; elements < 4; elements++)
+				{
+					config.color[0] = mode0;
+					config.color[1] = mode1;
+					config.color_comp[0] = comp;
+					config.color_comp[1] = FORMAT_32B_8888 - comp;
+					config.color_elements[0] = elements & 1;
+					config.color_elements[1] = elements >> 1;
+					Check(config, 16);
+				}
+			}
+		}
+	}
+}
+
+TEST_F(VertexLoaderFuzzTest, TexCoord)
+{
+	for (int i = 0; i < 8; i++)
+	{
+		for (u64 mode = NOT_PRESENT; mode <= INDEX16; mode++)
+		{
+			for (u32 format = FORMAT_UBYTE; format <= FORMAT_FLOAT; format++)
+			{
+				for (u32 elements = 0; elements < 2; elements++)
+				{
+					for (u32 frac = 0; frac < 32; frac += 5)
+					{
+						VertexConfig config;
+						config.texcoord[i] = mode;
+						config.tc_format[i] = format;
+						config.tc_elements[i] = elements;
+						config.tc_frac[i] = frac;
+						Check(config, 16);
+						config.tex_mtx[i] = true;
+						Check(config, 16);
+					}
+				}
+			}
+		}
+	}
+}
+
+TEST_F(VertexLoaderFuzzTest, Random)
+{
+	const bool ssse3 = cpu_info.bSSSE3;
+	for (int n = 0; n < 2000; n++)
+	{
+		// Also cover the SSE2 fallback of the JIT.
+		cpu_info.bSSSE3 = ssse3 && n % 2;
+
+		VertexConfig config;
+		config.pos_mtx = m_rng() % 2;
+		config.position = RandomMode(false);
+		config.pos_elements = m_rng() % 2;
+		config.pos_format = m_rng() % 5;
+		config.pos_frac = m_rng() % 32;
+		config.normal = RandomMode(true);
+		config.normal_elements = m_rng() % 2;
+		config.normal_format = m_rng() % 5;
+		config.normal_index3 = m_rng() % 2;
+		for (int i = 0; i < 2; i++)
+		{
+			config.color[i] = RandomMode(true);
+			config.color_elements[i] = m_rng() % 2;
+			config.color_comp[i] = m_rng() % 6;
+		}
+		for (int i = 0; i < 8; i++)
+		{
+			config.tex_mtx[i] = m_rng() % 4 == 0;
+			config.texcoord[i] = RandomMode(true);
+			config.tc_elements[i] = m_rng() % 2;
+			config.tc_format[i] = m_rng() % 5;
+			config.tc_frac[i] = m_rng() % 32;
+		}
+		Check(config, 1 + m_rng() % 64);
+	}
+	cpu_info.bSSSE3 = ssse3;
+}
+
+// Reports the throughput of a range of loaders, including the ones listed at
+// the top of VertexLoader.h.
+TEST_F(VertexLoaderFuzzTest, SweepSpeed)
+{
+	std::vector<VertexConfig> configs;
+	for (u64 mode = DIRECT; mode <= INDEX16; mode++)
+	{
+		for (u32 format = FORMAT_UBYTE; format <= FORMAT_FLOAT; format++)
+		{
+			VertexConfig config;
+			config.position = mode;
+			config.pos_elements = 1;
+			config.pos_format = format;
+			configs.push_back(config);
+
+			config.normal = mode;
+			config.normal_format = format;
+			config.color[0] = mode;
+			config.color_comp[0] = FORMAT_32B_8888;
+			config.texcoord[0] = mode;
+			config.tc_elements[0] = 1;
+			config.tc_format[0] = format;
+			configs.push_back(config);
+		}
+	}
+
+	// Metroid Prime: P I16-flt N I16-s16 T0 I16-u16 T1 i16-flt
+	VertexConfig prime;
+	prime.position = INDEX16;
+	prime.pos_elements = 1;
+	prime.pos_format = FORMAT_FLOAT;
+	prime.normal = INDEX16;
+	prime.normal_format = FORMAT_SHORT;
+	prime.texcoord[0] = INDEX16;
+	prime.tc_elements[0] = 1;
+	prime.tc_format[0] = FORMAT_USHORT;
+	prime.texcoord[1] = INDEX16;
+	prime.tc_elements[1] = 1;
+	prime.tc_format[1] = FORMAT_FLOAT;
+	configs.push_back(prime);
+
+	const int count = 100000;
+	for (const VertexConfig& config : configs)
+	{
+		TVtxDesc desc;
+		VAT vat;
+		config.ToRegisters(&desc, &vat);
+		for (int i = 0; i < 16; i++)
+		{
+			cached_arraybases[i] = &array_memory[0];
+			g_main_cp_state.array_strides[i] = 36;
+		}
+
+		VertexLoader loader(desc, vat);
+		// Keep indices small so array reads stay in the cache.
+		memset(input_memory, 0, loader.GetVertexSize() * count);
+
+		auto start = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < 10; i++)
+		{
+			ResetPointers();
+			loader.RunVertices(vat, 7, count);
+		}
+		auto end = std::chrono::high_resolution_clock::now();
+
+		double seconds = std::chrono::duration<double>(end - start).count();
+		std::string name;
+		loader.AppendToString(&name);
+		name.erase(name.find_last_not_of('\n') + 1);
+		printf("%8.1f Mverts/s  %s\n", 10 * count / seconds / 1000000, name.c_str());
+	}
+}